@@ -0,0 +1,185 @@
+#include "batch_mode.h"
+#include "shader.h"
+#include "memory_tracker.h"
+#include "frame_arena.h"
+#include "gl_trace.h"
+#include "embedded_assets.h"
+#include "instance_picker.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+void BatchMode::addPhase(const char *name, double ms)
+{
+    phases.push_back({name, ms});
+}
+
+void BatchMode::begin(int frames)
+{
+    frameTimes.reserve(frames);
+    gpuTimes.reserve(frames);
+}
+
+void BatchMode::addFrame(double frameMs, double gpuMs, int drawCalls)
+{
+    frameTimes.push_back(frameMs);
+    gpuTimes.push_back(gpuMs);
+    totalDrawCalls += drawCalls;
+    maxDrawCalls = std::max(maxDrawCalls, drawCalls);
+}
+
+double BatchMode::percentileOf(const std::vector<double> &sorted, double percentile)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+bool BatchMode::writeSummary(const BatchOptions &options) const
+{
+    std::ofstream file(options.outputPath);
+    if (!file)
+    {
+        std::cerr << "Failed to open run summary output: " << options.outputPath << std::endl;
+        return false;
+    }
+
+    std::vector<double> sortedFrames = frameTimes;
+    std::sort(sortedFrames.begin(), sortedFrames.end());
+    double frameSum = 0.0;
+    for (double ms : frameTimes)
+    {
+        frameSum += ms;
+    }
+
+    // GPU查询结果滞后数帧，开头几帧为0，只统计取得结果之后的帧
+    double gpuSum = 0.0;
+    int gpuSamples = 0;
+    for (double ms : gpuTimes)
+    {
+        if (ms > 0.0)
+        {
+            gpuSum += ms;
+            ++gpuSamples;
+        }
+    }
+
+    double startupTotal = 0.0;
+    for (const Phase &phase : phases)
+    {
+        startupTotal += phase.ms;
+    }
+
+    const int frameCount = static_cast<int>(frameTimes.size());
+    const Shader &shader = Shader::getInstance();
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n";
+    file << "  \"options\": {\"vertex\": \"" << Shader::getVertexShaderName(options.vertexShader) << "\""
+         << ", \"fragment\": \"" << Shader::getFragmentShaderName(options.fragmentShader) << "\""
+         << ", \"rotation_x\": " << options.rotationX << ", \"rotation_y\": " << options.rotationY
+         << ", \"distance\": " << options.distance
+         << ", \"width\": " << options.width << ", \"height\": " << options.height
+         << ", \"frames\": " << options.frames << ", \"objects\": " << options.objects
+         << ", \"time_step\": " << options.timeStep << "},\n";
+
+    file << "  \"startup_ms\": {";
+    for (const Phase &phase : phases)
+    {
+        file << "\"" << phase.name << "\": " << phase.ms << ", ";
+    }
+    file << "\"total\": " << startupTotal << "},\n";
+
+    file << "  \"shaders\": {\"compile_ms\": " << shader.getCompileTimeMs()
+         << ", \"link_ms\": " << shader.getLinkTimeMs()
+         << ", \"programs_linked\": " << shader.getLinkCount()
+         << ", \"embedded_assets\": " << (EmbeddedAssets::isEnabled() ? "true" : "false")
+         << ", \"source_load_ms\": " << shader.getSourceLoadTimeMs()
+         << ", \"source_file_reads\": " << shader.getSourceFileReads()
+         << ", \"embedded_sources\": " << shader.getEmbeddedSourceCount() << "},\n";
+
+    file << "  \"frame_ms\": {\"count\": " << frameCount
+         << ", \"min\": " << (sortedFrames.empty() ? 0.0 : sortedFrames.front())
+         << ", \"mean\": " << (frameCount > 0 ? frameSum / frameCount : 0.0)
+         << ", \"p95\": " << percentileOf(sortedFrames, 95.0)
+         << ", \"p99\": " << percentileOf(sortedFrames, 99.0)
+         << ", \"max\": " << (sortedFrames.empty() ? 0.0 : sortedFrames.back()) << "},\n";
+
+    file << "  \"scene_gpu_ms\": {\"samples\": " << gpuSamples
+         << ", \"mean\": " << (gpuSamples > 0 ? gpuSum / gpuSamples : 0.0) << "},\n";
+
+    file << "  \"draw_calls\": {\"total\": " << totalDrawCalls
+         << ", \"per_frame_mean\": " << (frameCount > 0 ? static_cast<double>(totalDrawCalls) / frameCount : 0.0)
+         << ", \"per_frame_max\": " << maxDrawCalls << "},\n";
+
+    MemoryStats memory = MemoryTracker::getInstance().getStats();
+    file << "  \"memory\": {\"cpu_bytes\": " << memory.cpuBytes
+         << ", \"cpu_peak_bytes\": " << memory.cpuPeakBytes
+         << ", \"cpu_allocations\": " << memory.cpuAllocations
+         << ", \"cpu_live_allocations\": " << memory.cpuLiveAllocations
+         << ", \"allocations_last_frame\": " << memory.frameAllocations
+         << ", \"allocations_peak_frame\": " << memory.peakFrameAllocations
+         << ", \"steady_state_allocation_frames\": " << (memory.steadyStateCheck ? memory.steadyStateViolations : -1)
+         << ", \"frame_arena_bytes\": " << FrameArena::forThread().getLastFrameBytes()
+         << ", \"frame_arena_capacity\": " << FrameArena::forThread().getCapacityBytes()
+         << ", \"gpu_bytes\": " << memory.gpuBytes
+         << ", \"gpu_peak_bytes\": " << memory.gpuPeakBytes << ", \"gpu_owners\": {";
+    for (size_t i = 0; i < memory.gpuOwners.size(); ++i)
+    {
+        file << (i > 0 ? ", " : "") << "\"" << memory.gpuOwners[i].first << "\": " << memory.gpuOwners[i].second;
+    }
+    file << "}},\n";
+
+    // GL调用统计：按入口给出每帧平均调用次数和冗余次数，未以GL_TRACE构建时只写出enabled
+    const GlTrace &trace = GlTrace::getInstance();
+    const GlCallStats &glCalls = trace.getTotals();
+    const double glFrames = static_cast<double>(std::max<long long>(trace.getFrameCount() - 1, 1));
+    file << "  \"gl_calls\": {\"enabled\": " << (glCalls.enabled ? "true" : "false");
+    if (glCalls.enabled)
+    {
+        file << ", \"per_frame\": " << glCalls.totalCalls / glFrames
+             << ", \"redundant_per_frame\": " << glCalls.redundantCalls / glFrames
+             << ", \"identical_uniforms_per_frame\": " << glCalls.identicalUniforms / glFrames << ", \"entries\": {";
+        bool first = true;
+        for (int entry = 0; entry < static_cast<int>(GlEntry::Count); ++entry)
+        {
+            if (glCalls.calls[entry] == 0)
+            {
+                continue;
+            }
+            file << (first ? "" : ", ") << "\"" << GlTrace::getEntryName(static_cast<GlEntry>(entry))
+                 << "\": {\"per_frame\": " << glCalls.calls[entry] / glFrames
+                 << ", \"redundant_per_frame\": " << glCalls.redundant[entry] / glFrames << "}";
+            first = false;
+        }
+        file << "}";
+    }
+    file << "},\n";
+
+    // 拾取统计：批处理结束时按光标网格拾取得到的BVH规模和延迟
+    PickStats pick = InstancePicker::getInstance().getStats();
+    file << "  \"picking\": {\"instances\": " << pick.instances
+         << ", \"bvh_nodes\": " << pick.nodes
+         << ", \"bvh_depth\": " << pick.depth
+         << ", \"build_ms\": " << pick.buildMs
+         << ", \"picks\": " << pick.picks
+         << ", \"mean_ms\": " << pick.meanMs
+         << ", \"max_ms\": " << pick.maxMs << "},\n";
+
+    // 逐帧时间，便于对比两次回放的帧时间曲线
+    file << "  \"frame_times_ms\": [";
+    for (size_t i = 0; i < frameTimes.size(); ++i)
+    {
+        file << (i > 0 ? ", " : "") << frameTimes[i];
+    }
+    file << "]\n";
+    file << "}\n";
+
+    std::cout << "Run summary written to " << options.outputPath << std::endl;
+    return true;
+}
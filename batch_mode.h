@@ -0,0 +1,116 @@
+/**
+ * @file batch_mode.h
+ * @brief 批处理模式头文件
+ * @details 定义了非交互运行的参数，以及收集启动阶段耗时、帧时间和绘制调用数并写出JSON摘要的统计类
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * @struct BatchOptions
+ * @brief 批处理运行参数
+ * @details 由命令行解析得到，enabled为false时程序进入交互式主循环
+ */
+struct BatchOptions
+{
+    bool enabled = false;                     // 是否以批处理模式运行
+    int vertexShader = 0;                     // 顶点着色器索引
+    int fragmentShader = 0;                   // 片段着色器索引
+    float rotationX = 0.0f;                   // 绕X轴旋转角度（度）
+    float rotationY = 0.0f;                   // 绕Y轴旋转角度（度）
+    float distance = 5.0f;                    // 相机距离
+    int width = 1024;                         // 窗口宽度
+    int height = 768;                         // 窗口高度
+    int frames = 300;                         // 渲染帧数
+    int objects = 1;                          // 立方体数量
+    double timeStep = 1.0 / 60.0;             // 每帧推进的着色器time值
+    bool framesSet = false;                   // 是否在命令行指定了帧数
+    std::string outputPath = "run_stats.json"; // JSON摘要输出路径
+    std::string recordPath;                   // 交互运行时录制输入日志的路径
+    std::string replayPath;                   // 批处理回放的输入日志路径
+    std::string commandBenchmarkPath;         // 命令列表录制基准测试的输出路径，为空时不运行
+    bool renderThread = false;                // 交互运行时是否使用专用渲染线程
+    bool checkAllocations = false;            // 是否检查稳定状态下每帧零堆分配
+    std::string glTracePath;                  // GL调用序列输出路径（需要GL_TRACE构建）
+    std::string serverSocketPath;             // 渲染服务的Unix域套接字路径，为空时不进入服务模式
+};
+
+/**
+ * @class BatchMode
+ * @brief 运行统计收集器，使用单例模式实现
+ * @details 启动阶段耗时在任何模式下都会记录；批处理模式下逐帧记录帧时间、
+ * 场景GPU耗时和绘制调用数，结束时计算最小值/均值/p95/p99并写出JSON摘要（含逐帧时间）
+ */
+class BatchMode
+{
+public:
+    /**
+     * @brief 获取BatchMode单例实例
+     * @return BatchMode& 单例实例的引用
+     */
+    static BatchMode &getInstance()
+    {
+        static BatchMode instance;
+        return instance;
+    }
+
+    /**
+     * @brief 记录一个启动阶段的耗时
+     * @param name 阶段名称，需为静态字符串
+     * @param ms 耗时（毫秒）
+     */
+    void addPhase(const char *name, double ms);
+
+    /**
+     * @brief 开始逐帧统计
+     * @param frames 计划渲染的帧数
+     * @details 预先为逐帧样本分配空间，避免稳定状态分配检查期间数组扩容
+     */
+    void begin(int frames);
+
+    /**
+     * @brief 记录一帧的统计
+     * @param frameMs 帧的墙钟时间（毫秒），从开始声明渲染图到交换缓冲区返回
+     * @param gpuMs 场景通道的GPU耗时（毫秒），来自异步查询，可能滞后数帧
+     * @param drawCalls 本帧的绘制调用数
+     */
+    void addFrame(double frameMs, double gpuMs, int drawCalls);
+
+    /**
+     * @brief 写出JSON摘要
+     * @param options 本次运行的参数
+     * @return bool 是否成功写出
+     */
+    bool writeSummary(const BatchOptions &options) const;
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    BatchMode() = default;
+    ~BatchMode() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    BatchMode(const BatchMode &) = delete;
+    BatchMode &operator=(const BatchMode &) = delete;
+
+    /**
+     * @brief 计算已排序数组的百分位数
+     * @param sorted 升序排列的样本
+     * @param percentile 百分位（0~100）
+     * @return double 最近秩法得到的百分位数
+     */
+    static double percentileOf(const std::vector<double> &sorted, double percentile);
+
+    struct Phase
+    {
+        const char *name; // 阶段名称
+        double ms;        // 耗时（毫秒）
+    };
+
+    std::vector<Phase> phases;      // 启动阶段耗时
+    std::vector<double> frameTimes; // 逐帧墙钟时间
+    std::vector<double> gpuTimes;   // 逐帧场景GPU耗时
+    long long totalDrawCalls = 0;   // 累计绘制调用数
+    int maxDrawCalls = 0;           // 单帧最大绘制调用数
+};
@@ -0,0 +1,362 @@
+#include "benchmark.h"
+#include "command_list.h"
+#include "frame_arena.h"
+#include "gpu_timer.h"
+#include "render_graph.h"
+#include "scene.h"
+#include "shader.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+bool Benchmark::run(GLFWwindow *window, const std::string &outputPath)
+{
+    this->window = window;
+    results.clear();
+
+    Scene &scene = Scene::getInstance();
+    const int previousCount = scene.getInstanceCount();
+    const auto &programs = Shader::getInstance().getShaderPrograms();
+
+    // 按索引遍历，保证输出顺序固定；只测试实际创建成功的程序
+    for (int v = 0; v < Shader::vertexShaderCount; ++v)
+    {
+        for (int f = 0; f < Shader::fragmentShaderCount; ++f)
+        {
+            std::string name = std::string(Shader::getVertexShaderName(v)) + "_" + Shader::getFragmentShaderName(f);
+            auto it = programs.find(name);
+            if (it == programs.end() || it->second == 0)
+            {
+                continue;
+            }
+
+            for (size_t r = 0; r < widths.size() && r < heights.size(); ++r)
+            {
+                for (int objects : objectCounts)
+                {
+                    Result result;
+                    result.program = name;
+                    result.vertexShader = v;
+                    result.fragmentShader = f;
+                    result.width = widths[r];
+                    result.height = heights[r];
+                    result.objects = objects;
+                    runCell(result);
+                    results.push_back(result);
+
+                    std::cout << "[benchmark] " << name << " " << result.width << "x" << result.height
+                              << " objects=" << objects << " gpu=" << result.gpuMsMean << "ms"
+                              << " wall=" << result.wallMsMean << "ms" << std::endl;
+
+                    if (glfwWindowShouldClose(window))
+                    {
+                        scene.setInstanceCount(previousCount);
+                        std::cerr << "Benchmark interrupted" << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    scene.setInstanceCount(previousCount);
+
+    bool json = outputPath.size() >= 5 && outputPath.compare(outputPath.size() - 5, 5, ".json") == 0;
+    return json ? writeJson(outputPath) : writeCsv(outputPath);
+}
+
+void Benchmark::runCell(Result &result)
+{
+    Scene &scene = Scene::getInstance();
+    RenderGraph &graph = RenderGraph::getInstance();
+    scene.setInstanceCount(result.objects);
+
+    GpuTimer timer;
+    timer.init();
+
+    const int sampleCount = result.width * result.height;
+    const int totalFrames = warmupFrames + measureFrames;
+    std::chrono::steady_clock::time_point start;
+
+    for (int frame = 0; frame < totalFrames; ++frame)
+    {
+        if (frame == warmupFrames)
+        {
+            // 预热结束：等待GPU空闲后清零计数，开始计时
+            timer.flush();
+            glFinish();
+            timer.resetTotals();
+            start = std::chrono::steady_clock::now();
+        }
+
+        // 使用固定时间步长，使每次运行的动画状态一致
+        float time = static_cast<float>(frame) / 60.0f;
+
+        graph.beginFrame();
+        RGHandle color = graph.createResource("BenchmarkColor", {result.width, result.height, GL_RGBA8, 0});
+        RGHandle depth = graph.createResource("BenchmarkDepth", {result.width, result.height, GL_DEPTH24_STENCIL8, 0});
+        graph.addPass(
+            "BenchmarkScene",
+            [&](RenderGraph::Builder &builder)
+            {
+                builder.writeColor(color);
+                builder.writeDepth(depth);
+                builder.setSideEffect();
+            },
+            [&]()
+            {
+                glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                timer.begin();
+                scene.render(result.vertexShader, result.fragmentShader, time, sampleCount);
+                timer.end();
+            });
+        graph.compile();
+        graph.execute();
+
+        glfwPollEvents();
+        FrameArena::forThread().reset();
+    }
+
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    // 收集剩余的查询结果
+    timer.flush();
+
+    result.frames = measureFrames;
+    result.gpuSamples = timer.getResultCount();
+    result.gpuMsMean = result.gpuSamples > 0 ? timer.getTotalMs() / result.gpuSamples : 0.0;
+    result.gpuMsMin = timer.getMinMs();
+    result.gpuMsMax = timer.getMaxMs();
+    result.wallMsMean = measureFrames > 0 ? elapsed.count() / measureFrames : 0.0;
+
+    timer.cleanup();
+}
+
+bool Benchmark::runRecording(GLFWwindow *window, const std::string &outputPath)
+{
+    this->window = window;
+    recordResults.clear();
+
+    Scene &scene = Scene::getInstance();
+    const int previousCount = scene.getInstanceCount();
+    const bool previousMixed = scene.mixedPrograms;
+    const bool previousQueue = scene.useRenderQueue;
+    const int previousThreads = scene.commandThreads;
+    const Scene::OcclusionMode previousOcclusion = scene.occlusionMode;
+
+    // 混合程序使每段都包含程序切换，遮挡剔除不经过渲染队列
+    scene.mixedPrograms = true;
+    scene.useRenderQueue = true;
+    scene.occlusionMode = Scene::OcclusionMode::Off;
+
+    // 线程数按2的幂递增，最后一项为硬件线程数
+    std::vector<int> threadCounts;
+    const int hardwareThreads = CommandRecorder::getHardwareThreads();
+    for (int threads = 1; threads < hardwareThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+
+    bool interrupted = false;
+    for (int objects : recordObjectCounts)
+    {
+        double singleThreadMs = 0.0;
+        for (int threads : threadCounts)
+        {
+            RecordResult result;
+            result.objects = objects;
+            result.threads = threads;
+            runRecordCell(result);
+            if (threads == 1)
+            {
+                singleThreadMs = result.recordMsMean;
+            }
+            result.speedup = result.recordMsMean > 0.0 ? singleThreadMs / result.recordMsMean : 0.0;
+            recordResults.push_back(result);
+
+            std::cout << "[benchmark] objects=" << objects << " threads=" << threads
+                      << " record=" << result.recordMsMean << "ms replay=" << result.replayMsMean
+                      << "ms speedup=" << result.speedup << std::endl;
+
+            interrupted = glfwWindowShouldClose(window);
+            if (interrupted)
+            {
+                break;
+            }
+        }
+        if (interrupted)
+        {
+            break;
+        }
+    }
+
+    scene.setInstanceCount(previousCount);
+    scene.mixedPrograms = previousMixed;
+    scene.useRenderQueue = previousQueue;
+    scene.commandThreads = previousThreads;
+    scene.occlusionMode = previousOcclusion;
+    if (interrupted)
+    {
+        std::cerr << "Benchmark interrupted" << std::endl;
+        return false;
+    }
+
+    bool json = outputPath.size() >= 5 && outputPath.compare(outputPath.size() - 5, 5, ".json") == 0;
+    return json ? writeRecordJson(outputPath) : writeRecordCsv(outputPath);
+}
+
+void Benchmark::runRecordCell(RecordResult &result)
+{
+    Scene &scene = Scene::getInstance();
+    scene.setInstanceCount(result.objects);
+    scene.commandThreads = result.threads;
+
+    int width = 0;
+    int height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+
+    double recordMs = 0.0;
+    double replayMs = 0.0;
+    for (int frame = 0; frame < warmupFrames + measureFrames; ++frame)
+    {
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        scene.render(0, 0, static_cast<float>(frame) / 60.0f, width * height);
+
+        // 只比较CPU端的录制和回放，等待GPU完成避免驱动命令队列堆积影响回放耗时
+        glFinish();
+        if (frame >= warmupFrames)
+        {
+            const RenderQueueStats &stats = scene.getRenderQueueStats();
+            recordMs += stats.recordMs;
+            replayMs += stats.replayMs;
+            result.commands = stats.commands;
+        }
+
+        glfwPollEvents();
+        FrameArena::forThread().reset();
+    }
+
+    result.frames = measureFrames;
+    result.recordMsMean = measureFrames > 0 ? recordMs / measureFrames : 0.0;
+    result.replayMsMean = measureFrames > 0 ? replayMs / measureFrames : 0.0;
+}
+
+bool Benchmark::writeCsv(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Failed to open benchmark output: " << path << std::endl;
+        return false;
+    }
+
+    file << "program,vertex,fragment,width,height,objects,frames,gpu_samples,"
+            "gpu_ms_mean,gpu_ms_min,gpu_ms_max,wall_ms_mean,gpu_ns_per_pixel\n";
+    file << std::fixed << std::setprecision(4);
+    for (const auto &result : results)
+    {
+        double nsPerPixel = result.gpuMsMean * 1.0e6 / (static_cast<double>(result.width) * result.height);
+        file << result.program << ","
+             << Shader::getVertexShaderName(result.vertexShader) << ","
+             << Shader::getFragmentShaderName(result.fragmentShader) << ","
+             << result.width << "," << result.height << "," << result.objects << ","
+             << result.frames << "," << result.gpuSamples << ","
+             << result.gpuMsMean << "," << result.gpuMsMin << "," << result.gpuMsMax << ","
+             << result.wallMsMean << "," << nsPerPixel << "\n";
+    }
+
+    std::cout << "Benchmark results written to " << path << std::endl;
+    return true;
+}
+
+bool Benchmark::writeJson(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Failed to open benchmark output: " << path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n  \"warmup_frames\": " << warmupFrames << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result &result = results[i];
+        double nsPerPixel = result.gpuMsMean * 1.0e6 / (static_cast<double>(result.width) * result.height);
+        file << "    {\"program\": \"" << result.program << "\""
+             << ", \"vertex\": \"" << Shader::getVertexShaderName(result.vertexShader) << "\""
+             << ", \"fragment\": \"" << Shader::getFragmentShaderName(result.fragmentShader) << "\""
+             << ", \"width\": " << result.width << ", \"height\": " << result.height
+             << ", \"objects\": " << result.objects << ", \"frames\": " << result.frames
+             << ", \"gpu_samples\": " << result.gpuSamples
+             << ", \"gpu_ms_mean\": " << result.gpuMsMean
+             << ", \"gpu_ms_min\": " << result.gpuMsMin
+             << ", \"gpu_ms_max\": " << result.gpuMsMax
+             << ", \"wall_ms_mean\": " << result.wallMsMean
+             << ", \"gpu_ns_per_pixel\": " << nsPerPixel << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+
+    std::cout << "Benchmark results written to " << path << std::endl;
+    return true;
+}
+
+bool Benchmark::writeRecordCsv(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Failed to open benchmark output: " << path << std::endl;
+        return false;
+    }
+
+    file << "objects,threads,frames,record_ms_mean,replay_ms_mean,commands,speedup\n";
+    file << std::fixed << std::setprecision(4);
+    for (const auto &result : recordResults)
+    {
+        file << result.objects << "," << result.threads << "," << result.frames << ","
+             << result.recordMsMean << "," << result.replayMsMean << ","
+             << result.commands << "," << result.speedup << "\n";
+    }
+
+    std::cout << "Benchmark results written to " << path << std::endl;
+    return true;
+}
+
+bool Benchmark::writeRecordJson(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Failed to open benchmark output: " << path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n  \"warmup_frames\": " << warmupFrames
+         << ",\n  \"hardware_threads\": " << CommandRecorder::getHardwareThreads() << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < recordResults.size(); ++i)
+    {
+        const RecordResult &result = recordResults[i];
+        file << "    {\"objects\": " << result.objects << ", \"threads\": " << result.threads
+             << ", \"frames\": " << result.frames
+             << ", \"record_ms_mean\": " << result.recordMsMean
+             << ", \"replay_ms_mean\": " << result.replayMsMean
+             << ", \"commands\": " << result.commands
+             << ", \"speedup\": " << result.speedup << "}"
+             << (i + 1 < recordResults.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+
+    std::cout << "Benchmark results written to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file benchmark.h
+ * @brief 着色器基准测试头文件
+ * @details 定义了遍历所有着色器程序、分辨率和物体数量组合的GPU开销基准测试，
+ * 以及命令列表录制耗时随线程数变化的基准测试
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <string>
+#include <vector>
+
+/**
+ * @class Benchmark
+ * @brief 着色器基准测试，使用单例模式实现
+ * @details 对Shader::shaderPrograms中的每个程序，在每个分辨率和物体数量组合下
+ * 先预热若干帧，再用GPU计时查询和墙钟时间测量若干帧，结果写入CSV或JSON表格
+ */
+class Benchmark
+{
+public:
+    /**
+     * @struct Result
+     * @brief 单个测试单元的结果
+     */
+    struct Result
+    {
+        std::string program;     // 着色器程序名称
+        int vertexShader = 0;    // 顶点着色器索引
+        int fragmentShader = 0;  // 片段着色器索引
+        int width = 0;           // 渲染宽度
+        int height = 0;          // 渲染高度
+        int objects = 0;         // 立方体数量
+        int frames = 0;          // 测量帧数
+        int gpuSamples = 0;      // 取得结果的GPU查询数
+        double gpuMsMean = 0.0;  // GPU平均耗时（毫秒）
+        double gpuMsMin = 0.0;   // GPU最小耗时（毫秒）
+        double gpuMsMax = 0.0;   // GPU最大耗时（毫秒）
+        double wallMsMean = 0.0; // 墙钟平均帧时间（毫秒）
+    };
+
+    /**
+     * @struct RecordResult
+     * @brief 命令列表录制基准测试的单个单元
+     */
+    struct RecordResult
+    {
+        int objects = 0;           // 立方体数量
+        int threads = 0;           // 录制线程数
+        int frames = 0;            // 测量帧数
+        double recordMsMean = 0.0; // 每帧并行录制的平均墙钟耗时（毫秒）
+        double replayMsMean = 0.0; // 每帧回放的平均CPU耗时（毫秒）
+        long long commands = 0;    // 每帧命令数
+        double speedup = 0.0;      // 相对单线程录制的加速比
+    };
+
+    /**
+     * @brief 获取Benchmark单例实例
+     * @return Benchmark& 单例实例的引用
+     */
+    static Benchmark &getInstance()
+    {
+        static Benchmark instance;
+        return instance;
+    }
+
+    /**
+     * @brief 运行完整的基准测试
+     * @param window GLFW窗口指针，用于在测试期间处理窗口事件
+     * @param outputPath 输出文件路径，扩展名为.json时输出JSON，否则输出CSV
+     * @return bool 是否成功完成并写出结果
+     * @details 需要在所有模块初始化之后调用，测试结束后恢复场景的物体数量
+     */
+    bool run(GLFWwindow *window, const std::string &outputPath);
+
+    /**
+     * @brief 运行命令列表录制基准测试
+     * @param window GLFW窗口指针
+     * @param outputPath 输出文件路径，扩展名为.json时输出JSON，否则输出CSV
+     * @return bool 是否成功完成并写出结果
+     * @details 在混合程序和渲染队列下，对每个物体数量依次用1到硬件线程数个线程录制命令列表，
+     * 测量录制和回放耗时，测试结束后恢复场景设置
+     */
+    bool runRecording(GLFWwindow *window, const std::string &outputPath);
+
+    /**
+     * @brief 获取最近一次运行的结果
+     * @return const std::vector<Result>& 结果表格
+     */
+    const std::vector<Result> &getResults() const { return results; }
+
+    std::vector<int> widths = {640, 1280, 1920};        // 测试的渲染宽度
+    std::vector<int> heights = {360, 720, 1080};        // 测试的渲染高度，与widths一一对应
+    std::vector<int> objectCounts = {1, 64, 512, 4096}; // 测试的立方体数量
+    std::vector<int> recordObjectCounts = {4096, 32768, 131072}; // 录制基准测试的立方体数量
+    int warmupFrames = 10;                              // 每个单元的预热帧数
+    int measureFrames = 100;                            // 每个单元的测量帧数
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    Benchmark() = default;
+    ~Benchmark() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    Benchmark(const Benchmark &) = delete;
+    Benchmark &operator=(const Benchmark &) = delete;
+
+    /**
+     * @brief 测量单个单元
+     * @param result 已填写程序、分辨率和物体数量的结果，测量值写回其中
+     */
+    void runCell(Result &result);
+
+    /**
+     * @brief 测量单个录制单元
+     * @param result 已填写物体数量和线程数的结果，测量值写回其中
+     */
+    void runRecordCell(RecordResult &result);
+
+    /**
+     * @brief 以CSV格式写出结果
+     */
+    bool writeCsv(const std::string &path) const;
+
+    /**
+     * @brief 以JSON格式写出结果
+     */
+    bool writeJson(const std::string &path) const;
+
+    /**
+     * @brief 以CSV格式写出录制基准测试结果
+     */
+    bool writeRecordCsv(const std::string &path) const;
+
+    /**
+     * @brief 以JSON格式写出录制基准测试结果
+     */
+    bool writeRecordJson(const std::string &path) const;
+
+    std::vector<Result> results;  // 最近一次运行的结果
+    std::vector<RecordResult> recordResults; // 最近一次录制基准测试的结果
+    GLFWwindow *window = nullptr; // 测试期间使用的窗口
+};
@@ -0,0 +1,204 @@
+#include "bloom.h"
+#include "shader.h"
+#include <algorithm>
+
+namespace
+{
+    // 全屏三角形，uv覆盖视口
+    const char *fullscreenVertexSource = R"(
+#version 330 core
+out vec2 uv;
+void main()
+{
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    // 输入纹理可能大于有效区域，采样坐标按uvScale映射并夹在有效区域内，避免读到区域外的旧内容
+    const char *brightFragmentSource = R"(
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D source;
+uniform vec2 uvScale;
+uniform float threshold;
+void main()
+{
+    vec2 texel = 0.5 / vec2(textureSize(source, 0));
+    vec3 color = texture(source, min(uv * uvScale, uvScale - texel)).rgb;
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    FragColor = vec4(color * (max(luminance - threshold, 0.0) / max(luminance, 1e-4)), 1.0);
+}
+)";
+
+    // 9抽头高斯核，direction为(1,0)或(0,1)
+    const char *blurFragmentSource = R"(
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D source;
+uniform vec2 uvScale;
+uniform vec2 direction;
+void main()
+{
+    const float weights[5] = float[5](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+    vec2 texel = 1.0 / vec2(textureSize(source, 0));
+    vec2 lower = 0.5 * texel;
+    vec2 upper = uvScale - 0.5 * texel;
+    vec2 center = uv * uvScale;
+    vec3 sum = texture(source, clamp(center, lower, upper)).rgb * weights[0];
+    for (int i = 1; i < 5; ++i)
+    {
+        vec2 offset = direction * texel * float(i);
+        sum += texture(source, clamp(center + offset, lower, upper)).rgb * weights[i];
+        sum += texture(source, clamp(center - offset, lower, upper)).rgb * weights[i];
+    }
+    FragColor = vec4(sum, 1.0);
+}
+)";
+
+    const char *compositeFragmentSource = R"(
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D source;
+uniform vec2 uvScale;
+uniform float intensity;
+void main()
+{
+    vec2 texel = 0.5 / vec2(textureSize(source, 0));
+    FragColor = vec4(texture(source, min(uv * uvScale, uvScale - texel)).rgb * intensity, 1.0);
+}
+)";
+}
+
+void Bloom::init()
+{
+    Shader &shader = Shader::getInstance();
+    brightProgram = shader.createProgramFromSource(fullscreenVertexSource, brightFragmentSource, "Bloom");
+    blurProgram = shader.createProgramFromSource(fullscreenVertexSource, blurFragmentSource, "Bloom");
+    compositeProgram = shader.createProgramFromSource(fullscreenVertexSource, compositeFragmentSource, "Bloom");
+    glGenVertexArrays(1, &fullscreenVAO);
+}
+
+void Bloom::cleanup()
+{
+    Shader &shader = Shader::getInstance();
+    shader.deleteShaderProgram(brightProgram);
+    shader.deleteShaderProgram(blurProgram);
+    shader.deleteShaderProgram(compositeProgram);
+    brightProgram = 0;
+    blurProgram = 0;
+    compositeProgram = 0;
+    if (fullscreenVAO != 0)
+    {
+        glDeleteVertexArrays(1, &fullscreenVAO);
+        fullscreenVAO = 0;
+    }
+}
+
+void Bloom::addPasses(RenderGraph &graph, RGHandle source, int sourceWidth, int sourceHeight,
+                      RGHandle target, int targetWidth, int targetHeight)
+{
+    if (brightProgram == 0 || blurProgram == 0 || compositeProgram == 0)
+    {
+        return;
+    }
+
+    // 中间目标按场景目标分配尺寸的一半创建，有效区域为场景有效区域的一半
+    const RGResourceDesc &sourceDesc = graph.getDesc(source);
+    const int allocWidth = std::max(1, sourceDesc.width / 2);
+    const int allocHeight = std::max(1, sourceDesc.height / 2);
+    const int width = std::max(1, sourceWidth / 2);
+    const int height = std::max(1, sourceHeight / 2);
+    const glm::vec2 sourceScale(static_cast<float>(sourceWidth) / sourceDesc.width,
+                                static_cast<float>(sourceHeight) / sourceDesc.height);
+    const glm::vec2 bloomScale(static_cast<float>(width) / allocWidth, static_cast<float>(height) / allocHeight);
+
+    // 亮部与竖直模糊结果描述相同，亮部在水平模糊之后不再使用，两者共享物理纹理
+    RGHandle bright = graph.createResource("BloomBright", {allocWidth, allocHeight, GL_RGBA8, 0});
+    RGHandle blurX = graph.createResource("BloomBlurX", {allocWidth, allocHeight, GL_RGBA8, 0});
+    RGHandle blurY = graph.createResource("BloomBlurY", {allocWidth, allocHeight, GL_RGBA8, 0});
+
+    graph.addPass(
+        "BloomBright",
+        [&](RenderGraph::Builder &builder)
+        {
+            builder.read(source);
+            builder.writeColor(bright);
+            builder.setViewport(width, height);
+        },
+        [this, &graph, source, sourceScale]()
+        {
+            glUseProgram(brightProgram);
+            glUniform1f(glGetUniformLocation(brightProgram, "threshold"), threshold);
+            drawFullscreen(brightProgram, graph.getTexture(source), sourceScale);
+        });
+
+    graph.addPass(
+        "BloomBlurX",
+        [&](RenderGraph::Builder &builder)
+        {
+            builder.read(bright);
+            builder.writeColor(blurX);
+            builder.setViewport(width, height);
+        },
+        [this, &graph, bright, bloomScale]()
+        {
+            glUseProgram(blurProgram);
+            glUniform2f(glGetUniformLocation(blurProgram, "direction"), 1.0f, 0.0f);
+            drawFullscreen(blurProgram, graph.getTexture(bright), bloomScale);
+        });
+
+    graph.addPass(
+        "BloomBlurY",
+        [&](RenderGraph::Builder &builder)
+        {
+            builder.read(blurX);
+            builder.writeColor(blurY);
+            builder.setViewport(width, height);
+        },
+        [this, &graph, blurX, bloomScale]()
+        {
+            glUseProgram(blurProgram);
+            glUniform2f(glGetUniformLocation(blurProgram, "direction"), 0.0f, 1.0f);
+            drawFullscreen(blurProgram, graph.getTexture(blurX), bloomScale);
+        });
+
+    graph.addPass(
+        "BloomComposite",
+        [&](RenderGraph::Builder &builder)
+        {
+            builder.read(blurY);
+            builder.writeColor(target);
+            builder.setViewport(targetWidth, targetHeight);
+        },
+        [this, &graph, blurY, bloomScale]()
+        {
+            GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+            glDisable(GL_DEPTH_TEST);
+            glEnable(GL_BLEND);
+            glBlendEquation(GL_FUNC_ADD);
+            glBlendFunc(GL_ONE, GL_ONE);
+            glUseProgram(compositeProgram);
+            glUniform1f(glGetUniformLocation(compositeProgram, "intensity"), intensity);
+            drawFullscreen(compositeProgram, graph.getTexture(blurY), bloomScale);
+            glDisable(GL_BLEND);
+            if (depthTest)
+                glEnable(GL_DEPTH_TEST);
+        });
+}
+
+void Bloom::drawFullscreen(GLuint program, GLuint texture, const glm::vec2 &uvScale) const
+{
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glUniform1i(glGetUniformLocation(program, "source"), 0);
+    glUniform2f(glGetUniformLocation(program, "uvScale"), uvScale.x, uvScale.y);
+    glBindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
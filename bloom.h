@@ -0,0 +1,81 @@
+/**
+ * @file bloom.h
+ * @brief 泛光后处理头文件
+ * @details 定义了半分辨率的泛光：提取亮部、水平和竖直两次高斯模糊后叠加到窗口帧缓冲区。
+ * 三个中间目标按顺序依次使用，亮部目标与竖直模糊目标描述相同且生命周期不重叠，
+ * 渲染图会把它们别名到同一个物理纹理
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "render_graph.h"
+
+/**
+ * @class Bloom
+ * @brief 泛光后处理，使用单例模式实现
+ */
+class Bloom
+{
+public:
+    /**
+     * @brief 获取Bloom单例实例
+     * @return Bloom& 单例实例的引用
+     */
+    static Bloom &getInstance()
+    {
+        static Bloom instance;
+        return instance;
+    }
+
+    /**
+     * @brief 创建着色器程序和全屏三角形使用的空VAO
+     */
+    void init();
+
+    /**
+     * @brief 释放GL资源
+     */
+    void cleanup();
+
+    /**
+     * @brief 向渲染图声明泛光的各个通道
+     * @param graph 渲染图
+     * @param source 场景颜色纹理（单采样）
+     * @param sourceWidth 场景在source中的有效宽度
+     * @param sourceHeight 场景在source中的有效高度
+     * @param target 叠加泛光的帧缓冲区资源
+     * @param targetWidth target的宽度
+     * @param targetHeight target的高度
+     * @details 中间目标按source分配尺寸的一半创建，只使用有效区域对应的视口，
+     * 与场景目标一样不随渲染比例重新分配。需要在写入target的放大通道之后声明
+     */
+    void addPasses(RenderGraph &graph, RGHandle source, int sourceWidth, int sourceHeight,
+                   RGHandle target, int targetWidth, int targetHeight);
+
+    bool enabled = false;    // 是否启用泛光
+    float threshold = 0.8f;  // 亮部提取的亮度阈值
+    float intensity = 0.6f;  // 叠加强度
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    Bloom() = default;
+    ~Bloom() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    Bloom(const Bloom &) = delete;
+    Bloom &operator=(const Bloom &) = delete;
+
+    /**
+     * @brief 用全屏三角形执行一个程序
+     * @param program 着色器程序
+     * @param texture 输入纹理
+     * @param uvScale 有效区域占输入纹理的比例
+     */
+    void drawFullscreen(GLuint program, GLuint texture, const glm::vec2 &uvScale) const;
+
+    GLuint brightProgram = 0;    // 亮部提取程序
+    GLuint blurProgram = 0;      // 可分离高斯模糊程序
+    GLuint compositeProgram = 0; // 叠加程序
+    GLuint fullscreenVAO = 0;    // 全屏三角形使用的空VAO
+};
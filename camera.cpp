@@ -23,20 +23,39 @@ void Camera::handleInput(GLFWwindow *window)
         glfwSetWindowShouldClose(window, true);
     }
 
-    // Handle rotation with arrow keys
+    applyKeys(pollKeys(window));
+}
+
+uint8_t Camera::pollKeys(GLFWwindow *window)
+{
+    uint8_t keys = 0;
     if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+        keys |= KeyLeft;
+    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+        keys |= KeyRight;
+    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+        keys |= KeyUp;
+    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+        keys |= KeyDown;
+    return keys;
+}
+
+void Camera::applyKeys(uint8_t keys)
+{
+    // Handle rotation with arrow keys
+    if (keys & KeyLeft)
     {
         rotationY -= rotationSpeed;
     }
-    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+    if (keys & KeyRight)
     {
         rotationY += rotationSpeed;
     }
-    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+    if (keys & KeyUp)
     {
         rotationX -= rotationSpeed;
     }
-    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+    if (keys & KeyDown)
     {
         rotationX += rotationSpeed;
     }
@@ -51,15 +70,55 @@ void Camera::handleScroll(double yoffset)
         cameraDistance = maxDistance;
 }
 
-void Camera::setCameraUniforms(GLuint shaderProgram)
+void Camera::setViewportSize(int width, int height)
+{
+    if (width > 0 && height > 0)
+    {
+        aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+    }
+}
+
+void Camera::setRotation(float x, float y)
+{
+    rotationX = x;
+    rotationY = y;
+}
+
+void Camera::setCameraDistance(float distance)
+{
+    cameraDistance = distance;
+    if (cameraDistance < minDistance)
+        cameraDistance = minDistance;
+    if (cameraDistance > maxDistance)
+        cameraDistance = maxDistance;
+}
+
+glm::mat4 Camera::getViewMatrix() const
 {
     // 设置固定的相机位置
-    glm::mat4 view = glm::lookAt(
+    return glm::lookAt(
         glm::vec3(0.0f, 0.0f, cameraDistance),
         glm::vec3(0.0f, 0.0f, 0.0f),
         glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+glm::mat4 Camera::getProjectionMatrix() const
+{
+    return glm::perspective(glm::radians(45.0f), aspectRatio, nearPlane, farPlane);
+}
+
+glm::mat4 Camera::getRotationMatrix() const
+{
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::rotate(model, glm::radians(rotationX), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(rotationY), glm::vec3(0.0f, 1.0f, 0.0f));
+    return model;
+}
 
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+void Camera::setCameraUniforms(GLuint shaderProgram)
+{
+    glm::mat4 view = getViewMatrix();
+    glm::mat4 projection = getProjectionMatrix();
 
     // 设置视图和投影矩阵
     glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
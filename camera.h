@@ -7,6 +7,8 @@
 #pragma once
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <cstdint>
 #include <string>
 
 /**
@@ -40,6 +42,32 @@ public:
      */
     void handleInput(GLFWwindow *window);
 
+    /**
+     * @brief 方向键位掩码
+     */
+    enum KeyBits : uint8_t
+    {
+        KeyLeft = 1 << 0,
+        KeyRight = 1 << 1,
+        KeyUp = 1 << 2,
+        KeyDown = 1 << 3
+    };
+
+    /**
+     * @brief 读取方向键状态
+     * @param window GLFW窗口指针
+     * @return uint8_t 按下的方向键位掩码，见KeyBits
+     */
+    static uint8_t pollKeys(GLFWwindow *window);
+
+    /**
+     * @brief 按方向键位掩码旋转立方体
+     * @param keys 方向键位掩码
+     * @details 每帧调用一次，每个按下的键使对应角度变化rotationSpeed，
+     * 录制回放时由输入日志提供掩码
+     */
+    void applyKeys(uint8_t keys);
+
     /**
      * @brief 处理鼠标滚轮输入
      * @param yoffset 滚轮偏移量
@@ -54,6 +82,48 @@ public:
      */
     void setCameraUniforms(GLuint shaderProgram);
 
+    /**
+     * @brief 设置视口尺寸
+     * @param width 帧缓冲区宽度
+     * @param height 帧缓冲区高度
+     * @details 用于计算投影矩阵的宽高比，尺寸为0（窗口最小化）时保持原值
+     */
+    void setViewportSize(int width, int height);
+
+    /**
+     * @brief 设置物体整体的旋转角度
+     * @param x 绕X轴旋转角度（度）
+     * @param y 绕Y轴旋转角度（度）
+     */
+    void setRotation(float x, float y);
+
+    /**
+     * @brief 设置相机距离
+     * @param distance 相机到物体的距离，限制在最小和最大距离之间
+     */
+    void setCameraDistance(float distance);
+
+    /**
+     * @brief 获取视图矩阵
+     * @return glm::mat4 相机位于Z轴上、看向原点的视图矩阵
+     */
+    glm::mat4 getViewMatrix() const;
+
+    /**
+     * @brief 获取投影矩阵
+     * @return glm::mat4 按当前宽高比计算的透视投影矩阵
+     */
+    glm::mat4 getProjectionMatrix() const;
+
+    /**
+     * @brief 获取物体整体的旋转矩阵
+     * @return glm::mat4 先绕X轴、再绕Y轴旋转的模型矩阵
+     */
+    glm::mat4 getRotationMatrix() const;
+
+    static constexpr float nearPlane = 0.1f;  // 近裁剪面
+    static constexpr float farPlane = 100.0f; // 远裁剪面
+
     // Getters for UI display
     /**
      * @brief 获取X轴旋转角度
@@ -73,6 +143,12 @@ public:
      */
     float getCameraDistance() const { return cameraDistance; }
 
+    /**
+     * @brief 获取投影宽高比
+     * @return float 视口宽度与高度之比
+     */
+    float getAspectRatio() const { return aspectRatio; }
+
 private:
     // 私有构造函数和析构函数，确保单例模式
     Camera() = default;
@@ -85,6 +161,7 @@ private:
     float cameraDistance = 5.0f;      // 相机到物体的距离
     float rotationX = 0.0f;           // 立方体绕X轴旋转角度
     float rotationY = 0.0f;           // 立方体绕Y轴旋转角度
+    float aspectRatio = 4.0f / 3.0f;  // 投影宽高比
     const float rotationSpeed = 2.0f; // 旋转速度
     const float minDistance = 2.0f;   // 最小相机距离
     const float maxDistance = 10.0f;  // 最大相机距离
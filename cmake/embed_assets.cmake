@@ -0,0 +1,36 @@
+# 把着色器和shader_config.ini生成为C++资源表
+# 用法：cmake -DSOURCE_DIR=<源码目录> -DOUTPUT=<输出文件> -P embed_assets.cmake
+# 每个文件生成一项makeEmbeddedAsset("相对路径", R"EMBED(内容)EMBED")，哈希由编译器在编译期计算
+
+if(NOT SOURCE_DIR OR NOT OUTPUT)
+    message(FATAL_ERROR "embed_assets.cmake requires SOURCE_DIR and OUTPUT")
+endif()
+
+file(GLOB_RECURSE SHADER_FILES RELATIVE ${SOURCE_DIR}
+    ${SOURCE_DIR}/shaders/*.vert
+    ${SOURCE_DIR}/shaders/*.frag
+)
+list(SORT SHADER_FILES)
+set(ASSET_FILES shader_config.ini ${SHADER_FILES})
+
+set(CONTENT "// 由cmake/embed_assets.cmake生成，不要手动修改\n")
+string(APPEND CONTENT "#pragma once\n\n")
+string(APPEND CONTENT "constexpr EmbeddedAsset embeddedAssetTable[] = {\n")
+foreach(ASSET ${ASSET_FILES})
+    file(READ ${SOURCE_DIR}/${ASSET} DATA)
+    string(FIND "${DATA}" ")EMBED\"" CLASH)
+    if(NOT CLASH EQUAL -1)
+        message(FATAL_ERROR "${ASSET} contains the raw string delimiter )EMBED\"")
+    endif()
+    string(APPEND CONTENT "    makeEmbeddedAsset(\"${ASSET}\", R\"EMBED(${DATA})EMBED\"),\n")
+endforeach()
+string(APPEND CONTENT "};\n")
+
+# 内容不变时不改写，避免每次构建都重新编译embedded_assets.cpp
+set(PREVIOUS "")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if(NOT PREVIOUS STREQUAL CONTENT)
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
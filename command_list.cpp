@@ -0,0 +1,206 @@
+#include "command_list.h"
+#include <GL/glew.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstring>
+
+void CommandList::clear()
+{
+    commands.clear();
+    matrices.clear();
+    std::fill(std::begin(counts), std::end(counts), 0);
+}
+
+void CommandList::push(CommandOp op, uint32_t unit, uint32_t a, uint32_t b, uint32_t c)
+{
+    commands.push_back({op, static_cast<uint8_t>(unit), 0, a, b, c});
+    ++counts[static_cast<int>(op)];
+}
+
+void CommandList::bindProgram(uint32_t program)
+{
+    push(CommandOp::BindProgram, 0, program, 0, 0);
+}
+
+void CommandList::bindVertexArray(uint32_t vao)
+{
+    push(CommandOp::BindVertexArray, 0, vao, 0, 0);
+}
+
+void CommandList::bindTexture(uint32_t unit, uint32_t texture)
+{
+    push(CommandOp::BindTexture, unit, texture, 0, 0);
+}
+
+void CommandList::bindUniformRange(uint32_t binding, uint32_t buffer, uint32_t offset, uint32_t size)
+{
+    push(CommandOp::BindUniformRange, binding, buffer, offset, size);
+}
+
+void CommandList::setUniformMat4(int32_t location, const glm::mat4 &value)
+{
+    matrices.push_back(value);
+    push(CommandOp::SetUniformMat4, 0, static_cast<uint32_t>(location), static_cast<uint32_t>(matrices.size() - 1), 0);
+}
+
+void CommandList::setUniform1f(int32_t location, float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    push(CommandOp::SetUniform1f, 0, static_cast<uint32_t>(location), bits, 0);
+}
+
+void CommandList::drawElements(uint32_t firstIndex, uint32_t count, int32_t baseVertex)
+{
+    push(CommandOp::DrawElements, 0, firstIndex, count, static_cast<uint32_t>(baseVertex));
+}
+
+void CommandList::replay() const
+{
+    for (const Command &command : commands)
+    {
+        switch (command.op)
+        {
+        case CommandOp::BindProgram:
+            glUseProgram(command.a);
+            break;
+        case CommandOp::BindVertexArray:
+            glBindVertexArray(command.a);
+            break;
+        case CommandOp::BindTexture:
+            glActiveTexture(GL_TEXTURE0 + command.unit);
+            glBindTexture(GL_TEXTURE_2D, command.a);
+            break;
+        case CommandOp::BindUniformRange:
+            glBindBufferRange(GL_UNIFORM_BUFFER, command.unit, command.a, command.b, command.c);
+            break;
+        case CommandOp::SetUniformMat4:
+            glUniformMatrix4fv(static_cast<GLint>(command.a), 1, GL_FALSE, glm::value_ptr(matrices[command.b]));
+            break;
+        case CommandOp::SetUniform1f:
+        {
+            float value = 0.0f;
+            std::memcpy(&value, &command.b, sizeof(value));
+            glUniform1f(static_cast<GLint>(command.a), value);
+            break;
+        }
+        case CommandOp::DrawElements:
+            glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(command.b), GL_UNSIGNED_INT,
+                                     (void *)(static_cast<size_t>(command.a) * sizeof(uint32_t)),
+                                     static_cast<GLint>(command.c));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void CommandRecorder::setThreadCount(int count)
+{
+    count = std::max(count, 1);
+    if (count == getThreadCount())
+    {
+        return;
+    }
+
+    shutdown();
+    stopping = false;
+    for (int i = 1; i < count; ++i)
+    {
+        workers.emplace_back(&CommandRecorder::workerMain, this);
+    }
+}
+
+void CommandRecorder::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+}
+
+int CommandRecorder::getHardwareThreads()
+{
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+void CommandRecorder::run(int count, Job job, void *context)
+{
+    if (workers.empty() || count <= 1)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            job(context, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        currentJob = job;
+        currentContext = context;
+        jobCount = count;
+        remainingJobs.store(count);
+        nextJob.store(0);
+        ++generation;
+    }
+    jobReady.notify_all();
+
+    // 调用线程同样领取任务，任务数不多于线程数时不会空等
+    work();
+
+    // 等到所有工作线程都离开work，下一批任务重置计数时不会有线程领取到旧批次的序号
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobDone.wait(lock, [this] { return remainingJobs.load() == 0 && activeWorkers == 0; });
+}
+
+void CommandRecorder::work()
+{
+    while (true)
+    {
+        int index = nextJob.fetch_add(1);
+        if (index >= jobCount)
+        {
+            return;
+        }
+        currentJob(currentContext, index);
+        remainingJobs.fetch_sub(1);
+    }
+}
+
+void CommandRecorder::workerMain()
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+            // 醒来时本批任务已全部完成（run可能已经返回）则不再进入work
+            if (remainingJobs.load() == 0)
+            {
+                continue;
+            }
+            ++activeWorkers;
+        }
+
+        work();
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            --activeWorkers;
+        }
+        jobDone.notify_one();
+    }
+}
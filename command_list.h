@@ -0,0 +1,189 @@
+/**
+ * @file command_list.h
+ * @brief 绘制命令列表头文件
+ * @details 定义了与图形API无关的紧凑命令缓冲区和录制线程池：工作线程各自把绘制
+ * 翻译成命令（绑定程序、绑定uniform块范围、绑定VAO、绘制），GL线程按顺序回放
+ */
+
+#pragma once
+#include <glm/glm.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @enum CommandOp
+ * @brief 命令类型
+ */
+enum class CommandOp : uint8_t
+{
+    BindProgram,      // 绑定着色器程序
+    BindVertexArray,  // 绑定顶点数组对象
+    BindTexture,      // 绑定二维纹理到纹理单元
+    BindUniformRange, // 把缓冲区的一段绑定到uniform块绑定点
+    SetUniformMat4,   // 设置mat4 uniform，矩阵保存在列表的矩阵池中
+    SetUniform1f,     // 设置float uniform
+    DrawElements,     // 按基顶点绘制共享索引缓冲区中的三角形
+    Count
+};
+
+/**
+ * @class CommandList
+ * @brief 绘制命令列表
+ * @details 每条命令固定16字节，资源只以整数句柄记录，录制时不调用任何GL函数，
+ * 因此可以在没有GL上下文的工作线程上录制。clear保留容量，稳定状态下录制不分配内存
+ */
+class CommandList
+{
+public:
+    /**
+     * @brief 清空命令，保留容量
+     */
+    void clear();
+
+    void bindProgram(uint32_t program);
+    void bindVertexArray(uint32_t vao);
+    void bindTexture(uint32_t unit, uint32_t texture);
+    void bindUniformRange(uint32_t binding, uint32_t buffer, uint32_t offset, uint32_t size);
+    void setUniformMat4(int32_t location, const glm::mat4 &value);
+    void setUniform1f(int32_t location, float value);
+    void drawElements(uint32_t firstIndex, uint32_t count, int32_t baseVertex);
+
+    /**
+     * @brief 按录制顺序执行所有命令
+     * @details 只能在持有GL上下文的线程上调用
+     */
+    void replay() const;
+
+    /**
+     * @brief 获取命令数
+     * @return size_t 命令数
+     */
+    size_t size() const { return commands.size(); }
+
+    /**
+     * @brief 获取某类命令的数量
+     * @param op 命令类型
+     * @return int 本次录制中该类命令的条数
+     */
+    int getCount(CommandOp op) const { return counts[static_cast<int>(op)]; }
+
+    /**
+     * @brief 获取命令和矩阵池占用的字节数
+     * @return size_t 字节数
+     */
+    size_t getBytes() const { return commands.size() * sizeof(Command) + matrices.size() * sizeof(glm::mat4); }
+
+private:
+    /**
+     * @struct Command
+     * @brief 一条命令，各参数的含义由op决定
+     */
+    struct Command
+    {
+        CommandOp op;  // 命令类型
+        uint8_t unit;  // 纹理单元或uniform块绑定点
+        uint16_t pad;  // 填充
+        uint32_t a;    // 程序、VAO、纹理、缓冲区、uniform位置或起始顶点
+        uint32_t b;    // 偏移、顶点数、float的位模式或矩阵池序号
+        uint32_t c;    // 范围大小
+    };
+    static_assert(sizeof(Command) == 16, "commands are expected to stay compact");
+
+    /**
+     * @brief 追加一条命令并计数
+     */
+    void push(CommandOp op, uint32_t unit, uint32_t a, uint32_t b, uint32_t c);
+
+    std::vector<Command> commands;   // 命令
+    std::vector<glm::mat4> matrices; // SetUniformMat4引用的矩阵
+    int counts[static_cast<int>(CommandOp::Count)] = {}; // 各类命令的数量
+};
+
+/**
+ * @class CommandRecorder
+ * @brief 命令录制线程池，使用单例模式实现
+ * @details run把若干个录制任务分给工作线程和调用线程，全部完成后才返回。
+ * 任务以函数指针和上下文指针传递，分发时不分配内存
+ */
+class CommandRecorder
+{
+public:
+    using Job = void (*)(void *context, int index); // 录制任务，index为任务序号
+
+    /**
+     * @brief 获取CommandRecorder单例实例
+     * @return CommandRecorder& 单例实例的引用
+     */
+    static CommandRecorder &getInstance()
+    {
+        static CommandRecorder instance;
+        return instance;
+    }
+
+    /**
+     * @brief 设置参与录制的线程数
+     * @param count 线程数（包含调用线程），变化时重新创建工作线程
+     */
+    void setThreadCount(int count);
+
+    /**
+     * @brief 获取参与录制的线程数
+     * @return int 工作线程数加调用线程
+     */
+    int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    /**
+     * @brief 并行执行一批任务
+     * @param jobCount 任务数
+     * @param job 任务函数，同一批任务之间不能写共享数据
+     * @param context 传给任务函数的上下文
+     */
+    void run(int jobCount, Job job, void *context);
+
+    /**
+     * @brief 停止并回收所有工作线程
+     */
+    void shutdown();
+
+    /**
+     * @brief 获取硬件线程数
+     * @return int 至少为1
+     */
+    static int getHardwareThreads();
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    CommandRecorder() = default;
+    ~CommandRecorder() { shutdown(); }
+
+    // 删除拷贝构造函数和赋值运算符
+    CommandRecorder(const CommandRecorder &) = delete;
+    CommandRecorder &operator=(const CommandRecorder &) = delete;
+
+    /**
+     * @brief 工作线程主循环
+     */
+    void workerMain();
+
+    /**
+     * @brief 领取并执行任务直到本批任务分完
+     */
+    void work();
+
+    std::vector<std::thread> workers;   // 工作线程
+    std::mutex jobMutex;                // 保护以下批次状态
+    std::condition_variable jobReady;   // 新一批任务或退出
+    std::condition_variable jobDone;    // 本批任务完成
+    Job currentJob = nullptr;           // 本批任务函数
+    void *currentContext = nullptr;     // 本批任务上下文
+    int jobCount = 0;                   // 本批任务数
+    uint64_t generation = 0;            // 批次编号
+    int activeWorkers = 0;              // 正在领取本批任务的工作线程数
+    bool stopping = false;              // 工作线程是否应退出
+    std::atomic<int> nextJob{0};        // 下一个待领取的任务序号
+    std::atomic<int> remainingJobs{0};  // 尚未完成的任务数
+};
@@ -1,38 +1,64 @@
 #include "cube.h"
 #include <GL/glew.h>
+#include <cstring>
+#include <vector>
+
+static_assert(GeometryArena::getVertexStride(Cube::format) == 8 * sizeof(float),
+              "cube vertex layout must match the arena format");
 
 void Cube::init()
 {
-    // Generate and bind VAO
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    // Deduplicate the 36 triangle vertices into unique vertices and indices
+    std::vector<float> unique;
+    std::vector<uint32_t> indices;
+    unique.reserve(vertexCount * floatsPerVertex);
+    indices.reserve(vertexCount);
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        const float *vertex = vertices + i * floatsPerVertex;
+        uint32_t index = 0;
+        uint32_t uniqueCount = static_cast<uint32_t>(unique.size() / floatsPerVertex);
+        while (index < uniqueCount &&
+               std::memcmp(unique.data() + index * floatsPerVertex, vertex, floatsPerVertex * sizeof(float)) != 0)
+        {
+            ++index;
+        }
+        if (index == uniqueCount)
+        {
+            unique.insert(unique.end(), vertex, vertex + floatsPerVertex);
+        }
+        indices.push_back(index);
+    }
 
-    // Generate and bind VBO
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    mesh = GeometryArena::getInstance().createMesh(format, unique.data(),
+                                                   static_cast<uint32_t>(unique.size() / floatsPerVertex),
+                                                   indices.data(), static_cast<uint32_t>(indices.size()));
+}
 
-    // Position attribute (location = 0)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
+void Cube::render()
+{
+    bind();
+    draw();
+    unbind();
+}
 
-    // Color attribute (location = 1)
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+void Cube::bind() const
+{
+    GeometryArena::getInstance().bind(format);
+}
 
-    // Unbind VAO
-    glBindVertexArray(0);
+void Cube::draw() const
+{
+    GeometryArena::getInstance().draw(mesh); // 6 faces * 2 triangles * 3 indices
 }
 
-void Cube::render()
+void Cube::unbind() const
 {
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36); // 6 faces * 2 triangles * 3 vertices
     glBindVertexArray(0);
 }
 
 void Cube::cleanup()
 {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-}
\ No newline at end of file
+    GeometryArena::getInstance().destroyMesh(mesh);
+    mesh = GeometryArena::invalidMesh;
+}
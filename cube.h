@@ -5,6 +5,7 @@
  */
 
 #pragma once
+#include "geometry_arena.h"
 #include <GL/glew.h>
 #include <vector>
 #include <string>
@@ -12,7 +13,7 @@
 /**
  * @class Cube
  * @brief 立方体渲染类，使用单例模式实现
- * @details 负责立方体的顶点数据管理、缓冲区设置和渲染操作
+ * @details 负责立方体的顶点数据管理和渲染操作，顶点和索引存放在共享几何缓冲区中
  */
 class Cube
 {
@@ -29,7 +30,8 @@ public:
 
     /**
      * @brief 初始化立方体
-     * @details 创建和设置顶点缓冲区对象
+     * @details 把36个顶点去重为24个顶点和36个索引，在共享几何缓冲区中创建网格，
+     * 需要在GeometryArena::init之后调用
      */
     void init();
 
@@ -39,9 +41,41 @@ public:
      */
     void render();
 
+    /**
+     * @brief 绑定立方体顶点格式的共享顶点数组对象
+     * @details 连续绘制多个实例时只需绑定一次，之后多次调用draw
+     */
+    void bind() const;
+
+    /**
+     * @brief 绘制立方体
+     * @details 要求已调用bind，只提交一次绘制调用
+     */
+    void draw() const;
+
+    /**
+     * @brief 解绑顶点数组对象
+     */
+    void unbind() const;
+
+    /**
+     * @brief 获取立方体在共享几何缓冲区中的网格编号
+     * @return uint32_t 网格编号，范围用GeometryArena::getMesh读取
+     * @details 实例化绘制和渲染队列用它取得索引数、首索引和基顶点
+     */
+    uint32_t getMesh() const { return mesh; }
+
+    /**
+     * @brief 获取立方体的顶点数组对象
+     * @return GLuint 顶点格式的共享顶点数组对象，渲染队列按它判断是否需要切换VAO
+     */
+    GLuint getVertexArray() const { return GeometryArena::getInstance().getVertexArray(format); }
+
+    static constexpr VertexFormat format = VertexFormat::PositionColorTexCoord; // 顶点格式
+
     /**
      * @brief 清理资源
-     * @details 删除顶点缓冲区对象
+     * @details 释放共享几何缓冲区中的网格
      */
     void cleanup();
 
@@ -54,13 +88,14 @@ private:
     Cube(const Cube &) = delete;
     Cube &operator=(const Cube &) = delete;
 
-    GLuint VAO = 0; // 顶点数组对象
-    GLuint VBO = 0; // 顶点缓冲区对象
-    GLuint EBO = 0; // 元素缓冲区对象
+    uint32_t mesh = GeometryArena::invalidMesh; // 共享几何缓冲区中的网格
+
+    static constexpr int vertexCount = 36;     // 6个面 * 2个三角形 * 3个顶点
+    static constexpr int floatsPerVertex = 8;  // 位置、颜色和纹理坐标
 
     /**
      * @brief 立方体顶点数据
-     * @details 包含36个顶点，每个顶点包含位置(x,y,z)和颜色(r,g,b)
+     * @details 包含36个顶点，每个顶点包含位置(x,y,z)、颜色(r,g,b)和纹理坐标(u,v)，每个面的纹理坐标覆盖0~1
      * 每个面使用不同的颜色：
      * - 前面：红色 (1,0,0)
      * - 后面：绿色 (0,1,0)
@@ -69,52 +104,52 @@ private:
      * - 底面：青色 (0,1,1)
      * - 顶面：品红 (1,0,1)
      */
-    const float vertices[216] = {
+    const float vertices[288] = {
         // 前面 (红色)
-        -0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f,
-        0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f,
-        -0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f,
+        -0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+        -0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
 
         // 后面 (绿色)
-        -0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
-        0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
-        -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
-        -0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f,
+        -0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+        -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+        -0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
 
         // 左面 (蓝色)
-        -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f,
-        -0.5f, 0.5f, -0.5f, 0.0f, 0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 1.0f,
-        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f,
-        -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f,
+        -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        -0.5f, 0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+        -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
 
         // 右面 (黄色)
-        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 0.0f,
-        0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f,
-        0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f,
-        0.5f, -0.5f, 0.5f, 1.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f,
+        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+        0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.5f, -0.5f, 0.5f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f,
 
         // 底面 (青色)
-        -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f,
-        0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f,
-        0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
-        0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
-        -0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+        0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f,
+        0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+        0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+        -0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
 
         // 顶面 (品红)
-        -0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f,
-        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f,
-        0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f,
-        0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f,
-        -0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f,
-        -0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f};
+        -0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+        0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        -0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+        -0.5f, 0.5f, -0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f};
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "dynamic_resolution.h"
+#include <algorithm>
+#include <cmath>
+
+void DynamicResolution::init()
+{
+    scale = maxScale;
+    smoothedGpuMs = 0.0;
+    framesSinceChange = 0;
+}
+
+void DynamicResolution::update(double gpuMs)
+{
+    if (gpuMs <= 0.0)
+    {
+        return;
+    }
+
+    smoothedGpuMs = smoothedGpuMs <= 0.0 ? gpuMs : smoothedGpuMs + (gpuMs - smoothedGpuMs) * smoothing;
+    ++framesSinceChange;
+
+    if (!enabled || framesSinceChange < settleFrames || budgetMs <= 0.0f)
+    {
+        return;
+    }
+
+    double ratio = smoothedGpuMs / budgetMs;
+    if (ratio > 1.0 - tolerance && ratio < 1.0 + tolerance)
+    {
+        return;
+    }
+
+    // 像素数与比例平方成正比，按耗时比值的平方根修正
+    float target = scale / static_cast<float>(std::sqrt(ratio));
+    target = std::min(std::max(target, scale - maxStep), scale + maxStep);
+    target = std::min(std::max(target, minScale), maxScale);
+
+    if (std::fabs(target - scale) > 0.005f)
+    {
+        scale = target;
+        framesSinceChange = 0;
+    }
+}
+
+void DynamicResolution::getRenderSize(int windowWidth, int windowHeight, int *outWidth, int *outHeight) const
+{
+    float s = getScale();
+    *outWidth = std::max(1, static_cast<int>(windowWidth * s + 0.5f));
+    *outHeight = std::max(1, static_cast<int>(windowHeight * s + 0.5f));
+}
+
+void DynamicResolution::getTargetSize(int windowWidth, int windowHeight, int *outWidth, int *outHeight) const
+{
+    // 降低maxScale后当前比例要等下一次调整才回到范围内，取两者较大值保证视口不超出目标
+    float s = std::max(getScale(), enabled ? maxScale : fixedScale);
+    *outWidth = std::max(1, static_cast<int>(windowWidth * s + 0.5f));
+    *outHeight = std::max(1, static_cast<int>(windowHeight * s + 0.5f));
+}
@@ -0,0 +1,88 @@
+/**
+ * @file dynamic_resolution.h
+ * @brief 动态分辨率控制头文件
+ * @details 定义了根据GPU帧时间调整场景渲染比例的控制器
+ */
+
+#pragma once
+
+/**
+ * @class DynamicResolution
+ * @brief 动态分辨率控制器，使用单例模式实现
+ * @details 根据测得的GPU场景耗时与预算的比值调整渲染比例。像素数与比例的平方成正比，
+ * 因此按耗时比值的平方根修正比例，并对测量值做指数平滑、对调整幅度和频率做限制，
+ * 避免查询结果滞后带来的振荡
+ */
+class DynamicResolution
+{
+public:
+    /**
+     * @brief 获取DynamicResolution单例实例
+     * @return DynamicResolution& 单例实例的引用
+     */
+    static DynamicResolution &getInstance()
+    {
+        static DynamicResolution instance;
+        return instance;
+    }
+
+    /**
+     * @brief 重置控制器状态
+     * @details 渲染比例恢复为最大值，清除平滑后的测量值
+     */
+    void init();
+
+    /**
+     * @brief 根据新的GPU耗时更新渲染比例
+     * @param gpuMs 最近一次完成的场景GPU耗时（毫秒），0表示尚无结果
+     */
+    void update(double gpuMs);
+
+    /**
+     * @brief 计算指定窗口尺寸下的场景渲染尺寸
+     * @param windowWidth 窗口帧缓冲区宽度
+     * @param windowHeight 窗口帧缓冲区高度
+     * @param outWidth 输出场景宽度
+     * @param outHeight 输出场景高度
+     */
+    void getRenderSize(int windowWidth, int windowHeight, int *outWidth, int *outHeight) const;
+
+    /**
+     * @brief 计算场景渲染目标的分配尺寸
+     * @param windowWidth 窗口帧缓冲区宽度
+     * @param windowHeight 窗口帧缓冲区高度
+     * @param outWidth 输出目标宽度
+     * @param outHeight 输出目标高度
+     * @details 自动调整时按最大比例分配，场景只渲染到左下角getRenderSize大小的视口，
+     * 比例变化不会改变目标尺寸，渲染图可以继续复用同一组物理资源
+     */
+    void getTargetSize(int windowWidth, int windowHeight, int *outWidth, int *outHeight) const;
+
+    float getScale() const { return enabled ? scale : fixedScale; }
+    double getSmoothedGpuMs() const { return smoothedGpuMs; }
+
+    bool enabled = true;      // 是否根据GPU耗时自动调整
+    float budgetMs = 16.0f;   // 场景GPU耗时预算（毫秒）
+    float minScale = 0.5f;    // 最小渲染比例
+    float maxScale = 1.0f;    // 最大渲染比例
+    float fixedScale = 1.0f;  // 关闭自动调整时使用的比例
+    int msaaSamples = 0;      // 场景多重采样数，0表示关闭
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    DynamicResolution() = default;
+    ~DynamicResolution() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    DynamicResolution(const DynamicResolution &) = delete;
+    DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+    static constexpr double smoothing = 0.2;    // 指数平滑系数
+    static constexpr double tolerance = 0.1;    // 预算容差，比值在[1-t, 1+t]内不调整
+    static constexpr float maxStep = 0.1f;      // 单次调整的最大比例变化
+    static constexpr int settleFrames = 8;      // 两次调整之间的最少帧数，等待查询结果跟上
+
+    float scale = 1.0f;          // 当前渲染比例
+    double smoothedGpuMs = 0.0;  // 平滑后的GPU耗时
+    int framesSinceChange = 0;   // 距离上次调整的帧数
+};
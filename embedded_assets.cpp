@@ -0,0 +1,40 @@
+#include "embedded_assets.h"
+
+#ifdef EMBED_ASSETS
+// 由cmake/embed_assets.cmake生成，定义embeddedAssetTable
+#include "embedded_assets_data.inc"
+#endif
+
+namespace
+{
+#ifdef EMBED_ASSETS
+    constexpr const EmbeddedAsset *assetsBegin = embeddedAssetTable;
+    constexpr size_t assetCount = sizeof(embeddedAssetTable) / sizeof(embeddedAssetTable[0]);
+#else
+    constexpr const EmbeddedAsset *assetsBegin = nullptr;
+    constexpr size_t assetCount = 0;
+#endif
+}
+
+bool EmbeddedAssets::isEnabled()
+{
+    return assetCount > 0;
+}
+
+const EmbeddedAsset *EmbeddedAssets::find(std::string_view path)
+{
+    const uint64_t hash = hashAssetBytes(path);
+    for (size_t i = 0; i < assetCount; ++i)
+    {
+        if (assetsBegin[i].pathHash == hash && assetsBegin[i].path == path)
+        {
+            return &assetsBegin[i];
+        }
+    }
+    return nullptr;
+}
+
+size_t EmbeddedAssets::getCount()
+{
+    return assetCount;
+}
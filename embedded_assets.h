@@ -0,0 +1,78 @@
+/**
+ * @file embedded_assets.h
+ * @brief 内嵌资源头文件
+ * @details 以EMBED_ASSETS构建时，CMake在构建目录生成embedded_assets_data.inc，把shaders/下的着色器和
+ * shader_config.ini编译进程序。资源以constexpr字符串视图保存，路径和内容的哈希在编译期算好，
+ * 启动时不需要读取文件。未以EMBED_ASSETS构建时资源表为空
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief 计算字节串的FNV-1a哈希
+ * @param bytes 字节串
+ * @return uint64_t 64位哈希值
+ */
+constexpr uint64_t hashAssetBytes(std::string_view bytes)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : bytes)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @struct EmbeddedAsset
+ * @brief 一个内嵌资源
+ */
+struct EmbeddedAsset
+{
+    std::string_view path; // 相对源码目录的路径，例如 "shaders/vertex/normal.vert"
+    std::string_view data; // 文件内容
+    uint64_t pathHash;     // 路径的哈希，查找时先比较
+    uint64_t dataHash;     // 内容的哈希，用于判断运行时文件是否与内嵌版本不同
+};
+
+/**
+ * @brief 在编译期构造内嵌资源
+ * @param path 资源路径
+ * @param data 文件内容
+ * @return EmbeddedAsset 带有预先计算的哈希的资源
+ */
+constexpr EmbeddedAsset makeEmbeddedAsset(std::string_view path, std::string_view data)
+{
+    return {path, data, hashAssetBytes(path), hashAssetBytes(data)};
+}
+
+/**
+ * @class EmbeddedAssets
+ * @brief 内嵌资源表的查询接口
+ */
+class EmbeddedAssets
+{
+public:
+    /**
+     * @brief 是否以EMBED_ASSETS构建
+     * @return bool 资源表是否可用
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief 按路径查找内嵌资源
+     * @param path 资源路径，与生成资源表时使用的相对路径一致
+     * @return const EmbeddedAsset* 找到时返回资源，否则返回nullptr
+     */
+    static const EmbeddedAsset *find(std::string_view path);
+
+    /**
+     * @brief 获取内嵌资源数
+     * @return size_t 资源数
+     */
+    static size_t getCount();
+};
@@ -0,0 +1,67 @@
+#include "frame_arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+FrameArena &FrameArena::forThread()
+{
+    thread_local FrameArena arena;
+    return arena;
+}
+
+FrameArena::~FrameArena()
+{
+    for (void *chunk : overflow)
+    {
+        ::operator delete(chunk);
+    }
+    ::operator delete(block);
+}
+
+void *FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (block == nullptr)
+    {
+        capacity = initialBlockBytes;
+        block = static_cast<char *>(::operator new(capacity));
+    }
+
+    // 在主块中按对齐要求移动偏移量
+    std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block);
+    std::size_t aligned = ((base + offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1)) - base;
+    if (aligned + bytes <= capacity)
+    {
+        usedBytes += aligned + bytes - offset;
+        offset = aligned + bytes;
+        return block + aligned;
+    }
+
+    // 主块不够时分配单独的溢出块，reset时合并进主块
+    void *chunk = ::operator new(bytes + alignment);
+    overflow.push_back(chunk);
+    ++overflowCount;
+    usedBytes += bytes + alignment;
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(chunk);
+    address = (address + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    return reinterpret_cast<void *>(address);
+}
+
+void FrameArena::reset()
+{
+    lastFrameBytes = usedBytes;
+    if (!overflow.empty())
+    {
+        for (void *chunk : overflow)
+        {
+            ::operator delete(chunk);
+        }
+        overflow.clear();
+
+        // 主块至少翻倍且不小于本帧总用量的1.5倍，之后同样规模的帧不再溢出
+        ::operator delete(block);
+        capacity = std::max(capacity * 2, usedBytes + usedBytes / 2);
+        block = static_cast<char *>(::operator new(capacity));
+    }
+    offset = 0;
+    usedBytes = 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file frame_arena.h
+ * @brief 帧分配器头文件
+ * @details 定义了每个线程一个的线性分配器：帧内只移动偏移量分配，帧结束时整体重置，
+ * 通过std::pmr::memory_resource接口供热路径上的临时容器使用
+ */
+
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @class FrameArena
+ * @brief 线程局部的帧线性分配器
+ * @details 每个线程通过forThread取得自己的实例，无需加锁。deallocate不回收内存，
+ * 所有分配在reset时一起失效，因此只能用于生命周期不超过当前帧（或当前任务）的数据。
+ * 当前块不够时临时从堆上分配溢出块，reset时把主块扩大到本帧的总用量，
+ * 稳定状态下每帧只使用一个块，不再访问通用堆
+ */
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t initialBlockBytes = 64 * 1024; // 主块的初始大小
+
+    /**
+     * @brief 获取调用线程的帧分配器
+     * @return FrameArena& 线程局部实例的引用，第一次调用时创建
+     */
+    static FrameArena &forThread();
+
+    /**
+     * @brief 使本帧的所有分配失效
+     * @details 由拥有该分配器的线程在帧结束（或任务结束）时调用，之后不能再访问之前分配的内存
+     */
+    void reset();
+
+    /**
+     * @brief 获取当前帧已分配的字节数
+     * @return std::size_t 包含对齐填充
+     */
+    std::size_t getUsedBytes() const { return usedBytes; }
+
+    /**
+     * @brief 获取上一次reset之前一帧的用量
+     * @return std::size_t 字节数
+     */
+    std::size_t getLastFrameBytes() const { return lastFrameBytes; }
+
+    /**
+     * @brief 获取主块容量
+     * @return std::size_t 字节数
+     */
+    std::size_t getCapacityBytes() const { return capacity; }
+
+    /**
+     * @brief 获取累计的溢出块次数
+     * @return long long 主块不够用而从堆上分配的次数
+     */
+    long long getOverflowCount() const { return overflowCount; }
+
+    // 帧分配器只能通过forThread取得，禁止拷贝
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+    FrameArena() = default;
+    ~FrameArena() override;
+
+    char *block = nullptr;           // 主块
+    std::size_t capacity = 0;        // 主块大小
+    std::size_t offset = 0;          // 主块中下一次分配的起点
+    std::size_t usedBytes = 0;       // 本帧已分配的字节数（含溢出块）
+    std::size_t lastFrameBytes = 0;  // 上一帧的用量
+    std::vector<void *> overflow;    // 本帧的溢出块
+    long long overflowCount = 0;     // 累计溢出次数
+};
@@ -0,0 +1,180 @@
+#include "frame_snapshot.h"
+#include "dynamic_resolution.h"
+#include "bloom.h"
+#include "ui.h"
+#include "frame_arena.h"
+#include <backends/imgui_impl_opengl3.h>
+#include <cstring>
+
+namespace
+{
+    // ImVector的赋值运算符会先释放再分配，这里保留已有容量，只拷贝内容
+    template <typename T>
+    void copyVector(const ImVector<T> &source, ImVector<T> *target)
+    {
+        target->resize(source.Size);
+        if (source.Size > 0)
+        {
+            std::memcpy(target->Data, source.Data, static_cast<size_t>(source.Size) * sizeof(T));
+        }
+    }
+}
+
+RenderSettings RenderSettings::capture()
+{
+    const Scene &scene = Scene::getInstance();
+    const DynamicResolution &resolution = DynamicResolution::getInstance();
+
+    RenderSettings settings;
+    settings.sortFrontToBack = scene.sortFrontToBack;
+    settings.depthPrepass = scene.depthPrepass;
+    settings.showOverdraw = scene.showOverdraw;
+    settings.occlusionMode = scene.occlusionMode;
+    settings.mixedPrograms = scene.mixedPrograms;
+    settings.renderQueue = scene.useRenderQueue;
+    settings.commandThreads = scene.commandThreads;
+    settings.highlightInstance = scene.highlightInstance;
+    settings.dynamicResolution = resolution.enabled;
+    settings.budgetMs = resolution.budgetMs;
+    settings.minScale = resolution.minScale;
+    settings.maxScale = resolution.maxScale;
+    settings.fixedScale = resolution.fixedScale;
+    settings.msaaSamples = resolution.msaaSamples;
+    settings.aliasTransients = RenderGraph::getInstance().aliasingEnabled;
+    settings.bloom = Bloom::getInstance().enabled;
+    settings.voxelWorld = VoxelWorld::getInstance().enabled;
+    settings.voxelMeshMode = VoxelWorld::getInstance().meshMode;
+    settings.particles = ParticleSystem::getInstance().enabled;
+    settings.particleCount = ParticleSystem::getInstance().particleCount;
+    settings.particleCpuUpdate = ParticleSystem::getInstance().cpuUpdate;
+    settings.textureCompression = TextureManager::getInstance().compress;
+    settings.textureBudgetKB = static_cast<int>(TextureManager::getInstance().uploadBudgetBytes / 1024);
+    return settings;
+}
+
+void RenderSettings::apply() const
+{
+    Scene &scene = Scene::getInstance();
+    DynamicResolution &resolution = DynamicResolution::getInstance();
+
+    scene.sortFrontToBack = sortFrontToBack;
+    scene.depthPrepass = depthPrepass;
+    scene.showOverdraw = showOverdraw;
+    scene.occlusionMode = occlusionMode;
+    scene.mixedPrograms = mixedPrograms;
+    scene.useRenderQueue = renderQueue;
+    scene.commandThreads = commandThreads;
+    scene.highlightInstance = highlightInstance;
+    resolution.enabled = dynamicResolution;
+    resolution.budgetMs = budgetMs;
+    resolution.minScale = minScale;
+    resolution.maxScale = maxScale;
+    resolution.fixedScale = fixedScale;
+    resolution.msaaSamples = msaaSamples;
+    RenderGraph::getInstance().aliasingEnabled = aliasTransients;
+    Bloom::getInstance().enabled = bloom;
+    VoxelWorld::getInstance().enabled = voxelWorld;
+    VoxelWorld::getInstance().meshMode = voxelMeshMode;
+    ParticleSystem::getInstance().enabled = particles;
+    ParticleSystem::getInstance().particleCount = particleCount;
+    ParticleSystem::getInstance().cpuUpdate = particleCpuUpdate;
+    TextureManager::getInstance().compress = textureCompression;
+    TextureManager::getInstance().uploadBudgetBytes = static_cast<long long>(textureBudgetKB) * 1024;
+}
+
+void RenderStats::collect()
+{
+    const Scene &scene = Scene::getInstance();
+    const DynamicResolution &resolution = DynamicResolution::getInstance();
+
+    sceneDrawCalls = scene.getLastDrawCalls();
+    sortMs = scene.getLastSortMs();
+    shadedPerPixel = scene.getShadedFragmentsPerPixel();
+    occlusionGroups = scene.getOcclusionGroupCount();
+    occludedFraction = scene.getOccludedGroupFraction();
+    stateChanges = scene.getRenderQueueStats();
+    renderScale = resolution.getScale();
+    sceneGpuMs = resolution.getSmoothedGpuMs();
+    graph = RenderGraph::getInstance().getStats();
+    uiDrawCalls = UI::getInstance().getLastDrawCalls();
+    particles = ParticleSystem::getInstance().getStats();
+    textures = TextureManager::getInstance().getStats();
+    geometry = GeometryArena::getInstance().getStats();
+    glCalls = GlTrace::getInstance().getLastFrame();
+    const FrameArena &arena = FrameArena::forThread();
+    arenaBytes = arena.getLastFrameBytes();
+    arenaCapacity = arena.getCapacityBytes();
+
+    // 体素模式下场景绘制调用来自分块网格
+    const VoxelWorld &world = VoxelWorld::getInstance();
+    voxel = world.getStats();
+    if (world.enabled)
+    {
+        sceneDrawCalls = voxel.drawCalls;
+    }
+}
+
+UIDrawSnapshot::~UIDrawSnapshot()
+{
+    for (ImDrawList *list : lists)
+    {
+        IM_DELETE(list);
+    }
+}
+
+void UIDrawSnapshot::assign(const ImDrawData *source)
+{
+    listCount = source->CmdListsCount;
+
+    // 只拷贝后端绘制需要的命令、顶点和索引缓冲区
+    while (static_cast<int>(lists.size()) < listCount)
+    {
+        lists.push_back(IM_NEW(ImDrawList)(nullptr));
+    }
+    for (int i = 0; i < listCount; ++i)
+    {
+        const ImDrawList *sourceList = source->CmdLists[i];
+        ImDrawList *target = lists[i];
+        copyVector(sourceList->CmdBuffer, &target->CmdBuffer);
+        copyVector(sourceList->IdxBuffer, &target->IdxBuffer);
+        copyVector(sourceList->VtxBuffer, &target->VtxBuffer);
+        target->Flags = sourceList->Flags;
+    }
+
+    drawData.Valid = true;
+    drawData.CmdListsCount = listCount;
+    drawData.TotalVtxCount = source->TotalVtxCount;
+    drawData.TotalIdxCount = source->TotalIdxCount;
+    drawData.DisplayPos = source->DisplayPos;
+    drawData.DisplaySize = source->DisplaySize;
+    drawData.FramebufferScale = source->FramebufferScale;
+#if IMGUI_VERSION_NUM >= 18973
+    // 1.89.8起CmdLists改为ImVector，resize在容量足够时不分配内存
+    drawData.CmdLists.resize(listCount);
+    for (int i = 0; i < listCount; ++i)
+    {
+        drawData.CmdLists[i] = lists[i];
+    }
+#else
+    drawData.CmdLists = listCount > 0 ? lists.data() : nullptr;
+#endif
+}
+
+void UIDrawSnapshot::render() const
+{
+    // 后端只读取绘制数据
+    ImGui_ImplOpenGL3_RenderDrawData(const_cast<ImDrawData *>(&drawData));
+
+    // ImGui后端可能通过自带的加载器修改绑定，之后的绑定不能与之前跟踪的状态比较
+    GlTrace::getInstance().invalidateState();
+}
+
+int UIDrawSnapshot::getCommandCount() const
+{
+    int commands = 0;
+    for (int i = 0; i < listCount; ++i)
+    {
+        commands += lists[i]->CmdBuffer.Size;
+    }
+    return commands;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file frame_snapshot.h
+ * @brief 帧快照头文件
+ * @details 定义了主线程交给渲染的每帧状态（相机、程序选择、变换、UI绘制数据、渲染设置），
+ * 以及渲染侧回传给UI的统计信息。单线程和渲染线程两种模式使用同一套结构
+ */
+
+#pragma once
+#include <imgui.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "render_graph.h"
+#include "scene.h"
+#include "voxel_world.h"
+#include "particle_system.h"
+#include "texture_manager.h"
+#include "geometry_arena.h"
+#include "gl_trace.h"
+
+/**
+ * @struct RenderSettings
+ * @brief 由UI控制的渲染设置
+ * @details 主线程上的UI只修改这份设置，渲染侧在每帧开始时通过apply写入各渲染模块，
+ * 使Scene、DynamicResolution和RenderGraph的字段只被执行渲染的线程访问
+ */
+struct RenderSettings
+{
+    bool sortFrontToBack = true;   // 是否按视空间深度从前到后排序
+    bool depthPrepass = false;     // 是否绘制深度预通道
+    bool showOverdraw = false;     // 是否显示过度绘制热力图
+    Scene::OcclusionMode occlusionMode = Scene::OcclusionMode::Off; // 遮挡剔除模式
+    bool mixedPrograms = false;    // 是否让每个实例使用各自的着色器组合
+    bool renderQueue = false;      // 是否经由排序渲染队列提交
+    int commandThreads = 0;        // 录制命令列表的线程数，0表示直接提交
+    int highlightInstance = -1;    // 鼠标拾取到的高亮实例，-1表示不高亮
+    bool dynamicResolution = true; // 是否根据GPU耗时自动调整渲染比例
+    float budgetMs = 16.0f;        // 场景GPU耗时预算（毫秒）
+    float minScale = 0.5f;         // 最小渲染比例
+    float maxScale = 1.0f;         // 最大渲染比例
+    float fixedScale = 1.0f;       // 关闭自动调整时使用的比例
+    int msaaSamples = 0;           // 场景多重采样数
+    bool aliasTransients = true;   // 是否启用渲染图临时资源别名
+    bool bloom = false;            // 是否叠加泛光
+    bool voxelWorld = false;       // 是否用体素世界替代立方体场景
+    VoxelMeshMode voxelMeshMode = VoxelMeshMode::Greedy; // 体素网格生成方式
+    bool particles = false;        // 是否模拟并绘制粒子
+    int particleCount = 100000;    // 粒子数
+    bool particleCpuUpdate = false; // 是否由CPU更新粒子
+    bool textureCompression = false; // 是否使用压缩纹理格式
+    int textureBudgetKB = 1024;    // 每帧纹理上传预算（KB）
+
+    /**
+     * @brief 从各渲染模块读取当前设置
+     * @return RenderSettings 当前设置
+     */
+    static RenderSettings capture();
+
+    /**
+     * @brief 将设置写入各渲染模块
+     * @details 只能在执行渲染的线程上调用
+     */
+    void apply() const;
+};
+
+/**
+ * @struct RenderStats
+ * @brief 渲染侧回传给UI的统计信息
+ */
+struct RenderStats
+{
+    int sceneDrawCalls = 0;          // 场景绘制调用数
+    double sortMs = 0.0;             // 场景排序耗时
+    double shadedPerPixel = 0.0;     // 每像素着色片段数
+    int occlusionGroups = 0;         // 遮挡剔除的组数
+    double occludedFraction = 0.0;   // 被遮挡而跳过的组所占比例
+    RenderQueueStats stateChanges;   // 场景绘制的状态切换统计
+    float renderScale = 1.0f;        // 场景渲染比例
+    double sceneGpuMs = 0.0;         // 平滑后的场景GPU耗时
+    RGStats graph;                   // 渲染图统计
+    int uiDrawCalls = 0;             // UI绘制调用数
+    bool renderThread = false;       // 是否由渲染线程提交
+    double latencyMs = 0.0;          // 平滑后的输入到呈现延迟
+    double latencyMaxMs = 0.0;       // 最近统计窗口内的最大延迟
+    long long presentedFrames = 0;   // 已呈现帧数
+    long long droppedFrames = 0;     // 被新快照覆盖而未渲染的帧数
+    VoxelStats voxel;                // 体素世界统计
+    ParticleStats particles;         // 粒子系统统计
+    TextureStats textures;           // 纹理流式加载统计
+    GeometryArenaStats geometry;     // 共享几何缓冲区的占用和碎片
+    GlCallStats glCalls;             // 上一帧的GL调用统计
+    size_t arenaBytes = 0;           // 渲染侧帧分配器上一帧的用量
+    size_t arenaCapacity = 0;        // 渲染侧帧分配器主块容量
+
+    /**
+     * @brief 从各渲染模块收集统计
+     * @details 只能在执行渲染的线程上调用，延迟相关字段由调用方填写
+     */
+    void collect();
+};
+
+/**
+ * @struct UIDrawSnapshot
+ * @brief ImGui绘制数据的深拷贝
+ * @details ImGui::Render产生的ImDrawData指向上下文内部的绘制列表，下一次NewFrame时即失效，
+ * 交给渲染线程前需要拷贝。绘制列表对象在帧之间复用，稳定状态下不再分配内存
+ */
+struct UIDrawSnapshot
+{
+    UIDrawSnapshot() = default;
+    ~UIDrawSnapshot();
+    UIDrawSnapshot(const UIDrawSnapshot &) = delete;
+    UIDrawSnapshot &operator=(const UIDrawSnapshot &) = delete;
+
+    /**
+     * @brief 拷贝ImGui绘制数据
+     * @param source ImGui::GetDrawData()的结果
+     */
+    void assign(const ImDrawData *source);
+
+    /**
+     * @brief 用拷贝的数据调用ImGui OpenGL3后端绘制
+     * @details 只能在拥有GL上下文的线程上调用
+     */
+    void render() const;
+
+    /**
+     * @brief 统计绘制命令数
+     * @return int 所有绘制列表中的命令数之和
+     */
+    int getCommandCount() const;
+
+    bool redraw = false;       // 本帧是否重新构建了面板，为false时只合成缓存纹理
+    bool cachePanel = true;    // 是否使用面板纹理缓存
+
+private:
+    std::vector<ImDrawList *> lists; // 拷贝的绘制列表（对象池，前listCount个有效）
+    int listCount = 0;               // 有效绘制列表数
+    ImDrawData drawData;             // 指向lists的绘制数据，在assign中填写，render直接交给后端
+};
+
+/**
+ * @struct FrameSnapshot
+ * @brief 一帧的渲染输入
+ */
+struct FrameSnapshot
+{
+    uint64_t frameId = 0;                            // 帧序号
+    std::chrono::steady_clock::time_point inputTime; // 采样输入的时间，用于统计输入到呈现的延迟
+    int framebufferWidth = 0;                        // 窗口帧缓冲区宽度
+    int framebufferHeight = 0;                       // 窗口帧缓冲区高度
+    int vertexShader = 0;                            // 顶点着色器索引
+    int fragmentShader = 0;                          // 片段着色器索引
+    double time = 0.0;                               // 着色器time值
+    SceneView view;                                  // 相机矩阵
+    glm::mat4 rotation = glm::mat4(1.0f);            // 场景整体的旋转矩阵，体素世界使用
+    std::vector<glm::mat4> models;                   // 实例的模型矩阵
+    RenderSettings settings;                         // 渲染设置
+    UIDrawSnapshot ui;                               // UI绘制数据
+};
@@ -0,0 +1,454 @@
+#include "geometry_arena.h"
+#include "memory_tracker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+void OffsetAllocator::reset(uint32_t newCapacity)
+{
+    freeBlocks.clear();
+    capacity = newCapacity;
+    used = 0;
+    if (capacity > 0)
+    {
+        freeBlocks[0] = capacity;
+    }
+}
+
+void OffsetAllocator::grow(uint32_t newCapacity)
+{
+    if (newCapacity <= capacity)
+    {
+        return;
+    }
+    uint32_t oldCapacity = capacity;
+    capacity = newCapacity;
+    free(oldCapacity, newCapacity - oldCapacity);
+    used += newCapacity - oldCapacity;
+}
+
+uint32_t OffsetAllocator::allocate(uint32_t size, uint32_t alignment)
+{
+    alignment = std::max(alignment, 1u);
+
+    // 最佳适配：选择对齐后仍能容纳请求的最小空闲区间
+    auto best = freeBlocks.end();
+    uint32_t bestStart = 0;
+    for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+    {
+        uint32_t start = (it->first + alignment - 1) / alignment * alignment;
+        uint32_t end = it->first + it->second;
+        if (start > end || end - start < size)
+        {
+            continue;
+        }
+        if (best == freeBlocks.end() || it->second < best->second)
+        {
+            best = it;
+            bestStart = start;
+        }
+    }
+    if (best == freeBlocks.end())
+    {
+        return invalidOffset;
+    }
+
+    // 对齐跳过的前段和剩余的后段仍为空闲
+    uint32_t blockOffset = best->first;
+    uint32_t blockEnd = best->first + best->second;
+    freeBlocks.erase(best);
+    if (bestStart > blockOffset)
+    {
+        freeBlocks[blockOffset] = bestStart - blockOffset;
+    }
+    if (bestStart + size < blockEnd)
+    {
+        freeBlocks[bestStart + size] = blockEnd - bestStart - size;
+    }
+    used += size;
+    return bestStart;
+}
+
+void OffsetAllocator::free(uint32_t offset, uint32_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    used -= size;
+
+    // 与后一个空闲区间相邻时合并
+    auto next = freeBlocks.lower_bound(offset);
+    if (next != freeBlocks.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = freeBlocks.erase(next);
+    }
+
+    // 与前一个空闲区间相邻时并入前者
+    if (next != freeBlocks.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            previous->second += size;
+            return;
+        }
+    }
+    freeBlocks[offset] = size;
+}
+
+uint32_t OffsetAllocator::getLargestFree() const
+{
+    uint32_t largest = 0;
+    for (const auto &block : freeBlocks)
+    {
+        largest = std::max(largest, block.second);
+    }
+    return largest;
+}
+
+double OffsetAllocator::getFragmentation() const
+{
+    uint32_t freeBytes = getFree();
+    return freeBytes > 0 ? 1.0 - static_cast<double>(getLargestFree()) / freeBytes : 0.0;
+}
+
+void GeometryArena::init()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, initialVertexBytes, nullptr, GL_STATIC_DRAW);
+    tracker.trackGpu(GpuResourceKind::Buffer, vertexBuffer, initialVertexBytes, "Geometry");
+    vertexAllocator.reset(initialVertexBytes);
+
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, initialIndexBytes, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    tracker.trackGpu(GpuResourceKind::Buffer, indexBuffer, initialIndexBytes, "Geometry");
+    indexAllocator.reset(initialIndexBytes);
+
+    // 每种格式一个VAO，属性都指向同一个顶点缓冲区的开头，索引缓冲区记录在VAO中
+    glGenVertexArrays(static_cast<GLsizei>(VertexFormat::Count), vertexArrays);
+    for (int i = 0; i < static_cast<int>(VertexFormat::Count); ++i)
+    {
+        glBindVertexArray(vertexArrays[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        setupAttributes(static_cast<VertexFormat>(i));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryArena::cleanup()
+{
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    if (vertexBuffer != 0)
+    {
+        tracker.untrackGpu(GpuResourceKind::Buffer, vertexBuffer);
+        tracker.untrackGpu(GpuResourceKind::Buffer, indexBuffer);
+        glDeleteVertexArrays(static_cast<GLsizei>(VertexFormat::Count), vertexArrays);
+        glDeleteBuffers(1, &vertexBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+    }
+    vertexBuffer = 0;
+    indexBuffer = 0;
+    std::fill(std::begin(vertexArrays), std::end(vertexArrays), 0);
+    meshes.clear();
+    freeMeshIds.clear();
+}
+
+void GeometryArena::setupAttributes(VertexFormat format)
+{
+    const GLsizei stride = static_cast<GLsizei>(getVertexStride(format));
+    if (format == VertexFormat::VoxelPositionColor)
+    {
+        // 整数位置和字节颜色由属性格式转换为浮点，着色器与立方体共用
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_FALSE, stride, (void *)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)8);
+        glEnableVertexAttribArray(1);
+        return;
+    }
+
+    // 位置(location=0)、颜色(location=1)和纹理坐标(location=3)，location 2留给粒子的实例偏移
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (void *)(6 * sizeof(float)));
+    glEnableVertexAttribArray(3);
+}
+
+uint32_t GeometryArena::createMesh(VertexFormat format, const void *vertices, uint32_t vertexCount,
+                                   const uint32_t *indices, uint32_t indexCount)
+{
+    uint32_t id = 0;
+    if (!freeMeshIds.empty())
+    {
+        id = freeMeshIds.back();
+        freeMeshIds.pop_back();
+    }
+    else
+    {
+        id = static_cast<uint32_t>(meshes.size());
+        meshes.emplace_back();
+    }
+
+    GeometryMesh &mesh = meshes[id];
+    mesh = GeometryMesh();
+    mesh.format = format;
+    mesh.live = true;
+
+    // 分配可能整理缓冲区，网格在分配完成后才记录索引区间，整理时不会把它当作已占用的区间搬移
+    if (indices != nullptr && indexCount > 0)
+    {
+        const uint32_t bytes = indexCount * static_cast<uint32_t>(sizeof(uint32_t));
+        uint32_t offset = allocateIndices(bytes);
+        GeometryMesh &current = meshes[id];
+        current.indexOffset = offset;
+        current.indexBytes = bytes;
+        current.indexCount = indexCount;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    updateRanges(meshes[id]);
+
+    if (vertices != nullptr && vertexCount > 0)
+    {
+        updateVertices(id, vertices, vertexCount);
+    }
+    return id;
+}
+
+void GeometryArena::updateVertices(uint32_t id, const void *vertices, uint32_t vertexCount)
+{
+    GeometryMesh &mesh = meshes[id];
+    const uint32_t stride = getVertexStride(mesh.format);
+    const uint32_t bytes = vertexCount * stride;
+
+    // 新数据放不下或不到原区间一半时重新分配，分配可能整理缓冲区，之后重新读取网格
+    if (bytes > mesh.vertexBytes || bytes < mesh.vertexBytes / 2)
+    {
+        if (mesh.vertexBytes > 0)
+        {
+            vertexAllocator.free(mesh.vertexOffset, mesh.vertexBytes);
+            mesh.vertexBytes = 0;
+        }
+        if (bytes > 0)
+        {
+            uint32_t offset = allocateVertices(bytes, stride);
+            meshes[id].vertexOffset = offset;
+            meshes[id].vertexBytes = bytes;
+        }
+    }
+
+    GeometryMesh &current = meshes[id];
+    current.vertexCount = vertexCount;
+    updateRanges(current);
+    if (bytes > 0)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, current.vertexOffset, bytes, vertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+}
+
+void GeometryArena::destroyMesh(uint32_t id)
+{
+    if (id == invalidMesh || id >= meshes.size() || !meshes[id].live)
+    {
+        return;
+    }
+
+    GeometryMesh &mesh = meshes[id];
+    if (mesh.vertexBytes > 0)
+    {
+        vertexAllocator.free(mesh.vertexOffset, mesh.vertexBytes);
+    }
+    if (mesh.indexBytes > 0)
+    {
+        indexAllocator.free(mesh.indexOffset, mesh.indexBytes);
+    }
+    mesh = GeometryMesh();
+    freeMeshIds.push_back(id);
+}
+
+void GeometryArena::bind(VertexFormat format) const
+{
+    glBindVertexArray(vertexArrays[static_cast<int>(format)]);
+}
+
+void GeometryArena::draw(uint32_t id) const
+{
+    const GeometryMesh &mesh = meshes[id];
+    drawRange(static_cast<GLsizei>(mesh.indexCount), mesh.firstIndex, mesh.baseVertex);
+}
+
+void GeometryArena::drawRange(GLsizei indexCount, GLuint firstIndex, GLint baseVertex, GLenum mode)
+{
+    glDrawElementsBaseVertex(mode, indexCount, GL_UNSIGNED_INT,
+                             (void *)(static_cast<size_t>(firstIndex) * sizeof(uint32_t)), baseVertex);
+}
+
+void GeometryArena::update()
+{
+    if (defragmentRequested.exchange(false))
+    {
+        defragment();
+    }
+}
+
+uint32_t GeometryArena::allocateVertices(uint32_t bytes, uint32_t alignment)
+{
+    uint32_t offset = vertexAllocator.allocate(bytes, alignment);
+    if (offset == OffsetAllocator::invalidOffset && vertexAllocator.getFree() >= bytes + alignment)
+    {
+        // 空闲空间总量足够，只是不连续
+        defragment();
+        offset = vertexAllocator.allocate(bytes, alignment);
+    }
+    if (offset == OffsetAllocator::invalidOffset)
+    {
+        growBuffer(vertexBuffer, vertexAllocator, bytes + alignment);
+        offset = vertexAllocator.allocate(bytes, alignment);
+    }
+    return offset;
+}
+
+uint32_t GeometryArena::allocateIndices(uint32_t bytes)
+{
+    const uint32_t alignment = sizeof(uint32_t);
+    uint32_t offset = indexAllocator.allocate(bytes, alignment);
+    if (offset == OffsetAllocator::invalidOffset && indexAllocator.getFree() >= bytes)
+    {
+        defragment();
+        offset = indexAllocator.allocate(bytes, alignment);
+    }
+    if (offset == OffsetAllocator::invalidOffset)
+    {
+        growBuffer(indexBuffer, indexAllocator, bytes);
+        offset = indexAllocator.allocate(bytes, alignment);
+    }
+    return offset;
+}
+
+void GeometryArena::growBuffer(GLuint buffer, OffsetAllocator &allocator, uint32_t required)
+{
+    const uint32_t oldCapacity = allocator.getCapacity();
+    uint32_t capacity = std::max(oldCapacity, 1u << 16);
+    while (capacity - oldCapacity < required)
+    {
+        capacity *= 2;
+    }
+
+    // 原内容先复制到临时缓冲区，重新分配存储后再复制回来，缓冲区名称不变
+    GLuint scratch = 0;
+    glGenBuffers(1, &scratch);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+    glBufferData(GL_COPY_WRITE_BUFFER, oldCapacity, nullptr, GL_STREAM_COPY);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity);
+
+    glBufferData(GL_COPY_READ_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, scratch);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &scratch);
+
+    allocator.grow(capacity);
+    MemoryTracker::getInstance().trackGpu(GpuResourceKind::Buffer, buffer, capacity, "Geometry");
+    ++growths;
+}
+
+void GeometryArena::defragment()
+{
+    auto start = std::chrono::steady_clock::now();
+    compactBuffer(vertexBuffer, vertexAllocator, true);
+    compactBuffer(indexBuffer, indexAllocator, false);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    lastDefragmentMs = elapsed.count();
+    ++defragmentations;
+}
+
+void GeometryArena::compactBuffer(GLuint buffer, OffsetAllocator &allocator, bool vertices)
+{
+    // 按原偏移顺序重新分配，空分配器上依次分配得到的就是紧凑的布局
+    std::vector<uint32_t> order;
+    for (uint32_t id = 0; id < meshes.size(); ++id)
+    {
+        const GeometryMesh &mesh = meshes[id];
+        if (mesh.live && (vertices ? mesh.vertexBytes : mesh.indexBytes) > 0)
+        {
+            order.push_back(id);
+        }
+    }
+    std::sort(order.begin(), order.end(), [this, vertices](uint32_t a, uint32_t b)
+              {
+                  return vertices ? meshes[a].vertexOffset < meshes[b].vertexOffset
+                                  : meshes[a].indexOffset < meshes[b].indexOffset;
+              });
+
+    const uint32_t capacity = allocator.getCapacity();
+    GLuint scratch = 0;
+    glGenBuffers(1, &scratch);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STREAM_COPY);
+
+    allocator.reset(capacity);
+    uint32_t end = 0;
+    for (uint32_t id : order)
+    {
+        GeometryMesh &mesh = meshes[id];
+        uint32_t &offset = vertices ? mesh.vertexOffset : mesh.indexOffset;
+        const uint32_t bytes = vertices ? mesh.vertexBytes : mesh.indexBytes;
+        const uint32_t alignment = vertices ? getVertexStride(mesh.format) : sizeof(uint32_t);
+        uint32_t compacted = allocator.allocate(bytes, alignment);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, compacted, bytes);
+        offset = compacted;
+        end = std::max(end, compacted + bytes);
+        updateRanges(mesh);
+    }
+
+    // 紧凑后的前段复制回原缓冲区，VAO中的绑定保持有效
+    if (end > 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, scratch);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, end);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &scratch);
+}
+
+void GeometryArena::updateRanges(GeometryMesh &mesh)
+{
+    mesh.baseVertex = static_cast<GLint>(mesh.vertexOffset / getVertexStride(mesh.format));
+    mesh.firstIndex = mesh.indexOffset / static_cast<uint32_t>(sizeof(uint32_t));
+}
+
+GeometryArenaStats GeometryArena::getStats() const
+{
+    GeometryArenaStats stats;
+    stats.meshes = static_cast<int>(meshes.size() - freeMeshIds.size());
+    stats.vertexCapacityBytes = vertexAllocator.getCapacity();
+    stats.vertexUsedBytes = vertexAllocator.getUsed();
+    stats.vertexFreeBlocks = vertexAllocator.getFreeBlockCount();
+    stats.vertexFragmentation = vertexAllocator.getFragmentation();
+    stats.indexCapacityBytes = indexAllocator.getCapacity();
+    stats.indexUsedBytes = indexAllocator.getUsed();
+    stats.indexFreeBlocks = indexAllocator.getFreeBlockCount();
+    stats.indexFragmentation = indexAllocator.getFragmentation();
+    stats.defragmentations = defragmentations;
+    stats.growths = growths;
+    stats.lastDefragmentMs = lastDefragmentMs;
+    return stats;
+}
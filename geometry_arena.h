@@ -0,0 +1,322 @@
+/**
+ * @file geometry_arena.h
+ * @brief 几何缓冲区分配器头文件
+ * @details 定义了所有网格共用的一个顶点缓冲区和一个索引缓冲区：缓冲区内的区间由带空闲链表合并的
+ * 偏移分配器管理，每种顶点格式共用一个VAO，网格以基顶点和首索引描述，用glDrawElementsBaseVertex绘制
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/**
+ * @enum VertexFormat
+ * @brief 顶点格式，每种格式对应一个共享VAO
+ */
+enum class VertexFormat : int
+{
+    PositionColorTexCoord, // 浮点位置、颜色和纹理坐标，立方体使用
+    VoxelPositionColor,    // 整数位置和字节颜色，体素分块使用
+    Count
+};
+
+/**
+ * @class OffsetAllocator
+ * @brief 区间分配器
+ * @details 空闲区间按偏移保存在有序映射中，分配时选择能容纳请求的最小区间（最佳适配），
+ * 释放时与前后相邻的空闲区间合并。偏移和大小的单位由调用方决定，这里都是字节
+ */
+class OffsetAllocator
+{
+public:
+    static constexpr uint32_t invalidOffset = UINT32_MAX; // 分配失败
+
+    /**
+     * @brief 清空所有分配，整个容量成为一个空闲区间
+     * @param capacity 容量
+     */
+    void reset(uint32_t capacity);
+
+    /**
+     * @brief 扩大容量，新增部分与末尾的空闲区间合并
+     * @param capacity 新容量，不小于当前容量
+     */
+    void grow(uint32_t capacity);
+
+    /**
+     * @brief 分配一个区间
+     * @param size 大小
+     * @param alignment 起始偏移需要是它的整数倍，不要求是2的幂
+     * @return uint32_t 起始偏移，没有足够大的空闲区间时返回invalidOffset
+     * @details 对齐跳过的部分留作空闲区间
+     */
+    uint32_t allocate(uint32_t size, uint32_t alignment);
+
+    /**
+     * @brief 释放一个区间
+     * @param offset allocate返回的偏移
+     * @param size 分配时的大小
+     */
+    void free(uint32_t offset, uint32_t size);
+
+    uint32_t getCapacity() const { return capacity; }
+    uint32_t getUsed() const { return used; }
+    uint32_t getFree() const { return capacity - used; }
+    int getFreeBlockCount() const { return static_cast<int>(freeBlocks.size()); }
+
+    /**
+     * @brief 获取最大的空闲区间
+     * @return uint32_t 大小
+     */
+    uint32_t getLargestFree() const;
+
+    /**
+     * @brief 获取碎片率
+     * @return double 1减去最大空闲区间占全部空闲空间的比例，空闲空间连续时为0
+     */
+    double getFragmentation() const;
+
+private:
+    std::map<uint32_t, uint32_t> freeBlocks; // 空闲区间，偏移到大小
+    uint32_t capacity = 0;                   // 容量
+    uint32_t used = 0;                       // 已分配的大小之和
+};
+
+/**
+ * @struct GeometryMesh
+ * @brief 一个网格在共享缓冲区中的位置
+ * @details 整理碎片或扩容之后基顶点和首索引会变化，绘制时应通过网格编号重新读取
+ */
+struct GeometryMesh
+{
+    VertexFormat format = VertexFormat::PositionColorTexCoord; // 顶点格式
+    uint32_t vertexOffset = 0;   // 顶点区间的字节偏移
+    uint32_t vertexBytes = 0;    // 顶点区间的字节数
+    uint32_t vertexCount = 0;    // 有效顶点数
+    uint32_t indexOffset = 0;    // 索引区间的字节偏移
+    uint32_t indexBytes = 0;     // 索引区间的字节数
+    uint32_t indexCount = 0;     // 索引数
+    GLint baseVertex = 0;        // 加到每个索引上的基顶点
+    GLuint firstIndex = 0;       // 第一个索引在索引缓冲区中的序号
+    bool live = false;           // 编号是否在使用
+};
+
+/**
+ * @struct GeometryArenaStats
+ * @brief 共享几何缓冲区的占用和碎片统计
+ */
+struct GeometryArenaStats
+{
+    int meshes = 0;                    // 在用的网格数
+    long long vertexCapacityBytes = 0; // 顶点缓冲区容量
+    long long vertexUsedBytes = 0;     // 已分配的顶点字节数
+    int vertexFreeBlocks = 0;          // 顶点缓冲区的空闲区间数
+    double vertexFragmentation = 0.0;  // 顶点缓冲区碎片率
+    long long indexCapacityBytes = 0;  // 索引缓冲区容量
+    long long indexUsedBytes = 0;      // 已分配的索引字节数
+    int indexFreeBlocks = 0;           // 索引缓冲区的空闲区间数
+    double indexFragmentation = 0.0;   // 索引缓冲区碎片率
+    int defragmentations = 0;          // 整理碎片次数
+    int growths = 0;                   // 扩容次数
+    double lastDefragmentMs = 0.0;     // 最近一次整理的CPU耗时（毫秒）
+};
+
+/**
+ * @class GeometryArena
+ * @brief 共享几何缓冲区，使用单例模式实现
+ * @details 顶点区间按所属格式的步长对齐，基顶点即偏移除以步长；索引保存网格内的相对序号。
+ * 分配失败时，空闲空间足够则先整理碎片，否则容量翻倍。整理和扩容都经由临时缓冲区复制，
+ * 缓冲区名称保持不变，各VAO记录的绑定继续有效。只能在持有GL上下文的线程上调用，
+ * requestDefragment除外
+ */
+class GeometryArena
+{
+public:
+    static constexpr uint32_t invalidMesh = UINT32_MAX;              // 无效网格编号
+    static constexpr uint32_t initialVertexBytes = 4u << 20;         // 顶点缓冲区初始容量
+    static constexpr uint32_t initialIndexBytes = 1u << 20;          // 索引缓冲区初始容量
+
+    /**
+     * @brief 获取GeometryArena单例实例
+     * @return GeometryArena& 单例实例的引用
+     */
+    static GeometryArena &getInstance()
+    {
+        static GeometryArena instance;
+        return instance;
+    }
+
+    /**
+     * @brief 创建缓冲区和各顶点格式的VAO
+     * @details 需要在GL上下文创建之后、任何网格创建之前调用
+     */
+    void init();
+
+    /**
+     * @brief 删除缓冲区和VAO
+     */
+    void cleanup();
+
+    /**
+     * @brief 创建网格
+     * @param format 顶点格式
+     * @param vertices 顶点数据，可以为空（只分配索引，供其他网格共用）
+     * @param vertexCount 顶点数
+     * @param indices 网格内的相对索引，可以为空（只分配顶点，绘制时使用其他网格的索引）
+     * @param indexCount 索引数
+     * @return uint32_t 网格编号
+     */
+    uint32_t createMesh(VertexFormat format, const void *vertices, uint32_t vertexCount,
+                        const uint32_t *indices, uint32_t indexCount);
+
+    /**
+     * @brief 替换网格的顶点
+     * @param mesh 网格编号
+     * @param vertices 新顶点数据
+     * @param vertexCount 新顶点数
+     * @details 不超过原区间且没有缩小一半以上时原地更新，否则释放后重新分配
+     */
+    void updateVertices(uint32_t mesh, const void *vertices, uint32_t vertexCount);
+
+    /**
+     * @brief 释放网格的区间，编号之后可被复用
+     * @param mesh 网格编号，为invalidMesh时忽略
+     */
+    void destroyMesh(uint32_t mesh);
+
+    /**
+     * @brief 获取网格的当前位置
+     * @param mesh 网格编号
+     * @return const GeometryMesh& 网格
+     */
+    const GeometryMesh &getMesh(uint32_t mesh) const { return meshes[mesh]; }
+
+    /**
+     * @brief 绑定格式的共享VAO
+     * @param format 顶点格式
+     */
+    void bind(VertexFormat format) const;
+
+    /**
+     * @brief 获取格式的共享VAO
+     * @param format 顶点格式
+     * @return GLuint 顶点数组对象，已绑定共享索引缓冲区
+     */
+    GLuint getVertexArray(VertexFormat format) const { return vertexArrays[static_cast<int>(format)]; }
+
+    GLuint getVertexBuffer() const { return vertexBuffer; }
+    GLuint getIndexBuffer() const { return indexBuffer; }
+
+    /**
+     * @brief 绘制整个网格
+     * @param mesh 网格编号
+     * @details 要求已绑定网格格式的VAO（或绑定了同一索引缓冲区、同一属性布局的VAO）
+     */
+    void draw(uint32_t mesh) const;
+
+    /**
+     * @brief 绘制一段索引
+     * @param indexCount 索引数
+     * @param firstIndex 第一个索引的序号
+     * @param baseVertex 基顶点
+     * @param mode 图元类型
+     */
+    static void drawRange(GLsizei indexCount, GLuint firstIndex, GLint baseVertex, GLenum mode = GL_TRIANGLES);
+
+    /**
+     * @brief 为当前绑定的GL_ARRAY_BUFFER设置格式的顶点属性
+     * @param format 顶点格式
+     * @details 属性偏移从0开始，绘制时由基顶点定位到网格；供需要额外实例属性的VAO使用
+     */
+    static void setupAttributes(VertexFormat format);
+
+    /**
+     * @brief 获取格式的顶点步长
+     * @param format 顶点格式
+     * @return uint32_t 每个顶点的字节数，各模块的顶点结构用static_assert与之保持一致
+     */
+    static constexpr uint32_t getVertexStride(VertexFormat format)
+    {
+        return format == VertexFormat::VoxelPositionColor ? 12 : 32;
+    }
+
+    /**
+     * @brief 请求在下一次update时整理碎片
+     * @details 可在任意线程调用
+     */
+    void requestDefragment() { defragmentRequested.store(true); }
+
+    /**
+     * @brief 处理整理请求
+     * @details 在渲染侧每帧调用一次
+     */
+    void update();
+
+    /**
+     * @brief 把所有在用的区间紧凑地移到缓冲区开头
+     */
+    void defragment();
+
+    /**
+     * @brief 获取统计
+     * @return GeometryArenaStats 当前占用和碎片
+     */
+    GeometryArenaStats getStats() const;
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    GeometryArena() = default;
+    ~GeometryArena() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    GeometryArena(const GeometryArena &) = delete;
+    GeometryArena &operator=(const GeometryArena &) = delete;
+
+    /**
+     * @brief 在顶点缓冲区中分配，必要时整理或扩容
+     * @return uint32_t 字节偏移
+     */
+    uint32_t allocateVertices(uint32_t bytes, uint32_t alignment);
+
+    /**
+     * @brief 在索引缓冲区中分配，必要时整理或扩容
+     * @return uint32_t 字节偏移
+     */
+    uint32_t allocateIndices(uint32_t bytes);
+
+    /**
+     * @brief 扩大缓冲区并保留原有内容，缓冲区名称不变
+     * @param buffer 缓冲区
+     * @param allocator 对应的分配器
+     * @param required 至少需要的连续空闲字节数
+     */
+    void growBuffer(GLuint buffer, OffsetAllocator &allocator, uint32_t required);
+
+    /**
+     * @brief 紧凑一个缓冲区中的所有区间
+     * @param buffer 缓冲区
+     * @param allocator 对应的分配器
+     * @param vertices 是否为顶点缓冲区
+     */
+    void compactBuffer(GLuint buffer, OffsetAllocator &allocator, bool vertices);
+
+    /**
+     * @brief 根据偏移重新计算网格的基顶点和首索引
+     */
+    static void updateRanges(GeometryMesh &mesh);
+
+    GLuint vertexBuffer = 0;                                         // 共享顶点缓冲区
+    GLuint indexBuffer = 0;                                          // 共享索引缓冲区
+    GLuint vertexArrays[static_cast<int>(VertexFormat::Count)] = {}; // 每种格式一个VAO
+    OffsetAllocator vertexAllocator;                                 // 顶点缓冲区的区间
+    OffsetAllocator indexAllocator;                                  // 索引缓冲区的区间
+    std::vector<GeometryMesh> meshes;                                // 按编号保存的网格
+    std::vector<uint32_t> freeMeshIds;                               // 可复用的网格编号
+    std::atomic<bool> defragmentRequested{false};                    // 是否请求整理
+    int defragmentations = 0;                                        // 整理次数
+    int growths = 0;                                                 // 扩容次数
+    double lastDefragmentMs = 0.0;                                   // 最近一次整理耗时
+};
@@ -0,0 +1,495 @@
+#include "gl_trace.h"
+#include <GL/glew.h>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    const char *const entryNames[static_cast<int>(GlEntry::Count)] = {
+        "glUseProgram",
+        "glBindVertexArray",
+        "glBindBuffer",
+        "glBindBufferBase",
+        "glBindBufferRange",
+        "glActiveTexture",
+        "glBindFramebuffer",
+        "glGetUniformLocation",
+        "glUniform1f",
+        "glUniform1i",
+        "glUniform3fv",
+        "glUniformMatrix4fv",
+        "glBufferData",
+        "glBufferSubData",
+        "glMapBufferRange",
+        "glDrawArraysInstanced",
+        "glDrawElementsBaseVertex",
+        "glDrawElementsInstancedBaseVertex",
+        "glBeginQuery",
+        "glEndQuery",
+        "glBeginConditionalRender",
+        "glBlitFramebuffer",
+    };
+}
+
+#ifdef GL_TRACE
+namespace
+{
+    constexpr GLuint unknown = 0xFFFFFFFFu; // 绑定状态未知
+
+    /**
+     * @struct BufferBinding
+     * @brief 通用或带索引的缓冲区绑定点
+     */
+    struct BufferBinding
+    {
+        GLenum target;     // 绑定目标
+        GLuint index;      // 索引，通用绑定点为unknown
+        GLuint buffer;     // 缓冲区
+        GLintptr offset;   // 范围起点
+        GLsizeiptr size;   // 范围大小，glBindBufferBase为0
+    };
+
+    /**
+     * @struct TrackedState
+     * @brief 经由GLEW设置的绑定状态
+     */
+    struct TrackedState
+    {
+        GLuint program = unknown;         // 当前程序
+        GLuint vertexArray = unknown;     // 当前VAO
+        GLenum activeTexture = unknown;   // 当前纹理单元
+        GLuint drawFramebuffer = unknown; // 当前绘制帧缓冲区
+        GLuint readFramebuffer = unknown; // 当前读取帧缓冲区
+        BufferBinding buffers[32];        // 已知的缓冲区绑定点
+        int bufferCount = 0;              // buffers中的有效项数
+    };
+
+    TrackedState state;
+    std::unordered_map<uint64_t, uint64_t> uniformValues; // (程序, 位置) -> 上次上传值的散列
+    std::unordered_set<uint64_t> queriedLocations;        // 已查询过的(程序, 名称)散列
+
+    PFNGLUSEPROGRAMPROC realUseProgram = nullptr;
+    PFNGLBINDVERTEXARRAYPROC realBindVertexArray = nullptr;
+    PFNGLBINDBUFFERPROC realBindBuffer = nullptr;
+    PFNGLBINDBUFFERBASEPROC realBindBufferBase = nullptr;
+    PFNGLBINDBUFFERRANGEPROC realBindBufferRange = nullptr;
+    PFNGLACTIVETEXTUREPROC realActiveTexture = nullptr;
+    PFNGLBINDFRAMEBUFFERPROC realBindFramebuffer = nullptr;
+    PFNGLGETUNIFORMLOCATIONPROC realGetUniformLocation = nullptr;
+    PFNGLUNIFORM1FPROC realUniform1f = nullptr;
+    PFNGLUNIFORM1IPROC realUniform1i = nullptr;
+    PFNGLUNIFORM3FVPROC realUniform3fv = nullptr;
+    PFNGLUNIFORMMATRIX4FVPROC realUniformMatrix4fv = nullptr;
+    PFNGLBUFFERDATAPROC realBufferData = nullptr;
+    PFNGLBUFFERSUBDATAPROC realBufferSubData = nullptr;
+    PFNGLMAPBUFFERRANGEPROC realMapBufferRange = nullptr;
+    PFNGLDRAWARRAYSINSTANCEDPROC realDrawArraysInstanced = nullptr;
+    PFNGLDRAWELEMENTSBASEVERTEXPROC realDrawElementsBaseVertex = nullptr;
+    PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC realDrawElementsInstancedBaseVertex = nullptr;
+    PFNGLBEGINQUERYPROC realBeginQuery = nullptr;
+    PFNGLENDQUERYPROC realEndQuery = nullptr;
+    PFNGLBEGINCONDITIONALRENDERPROC realBeginConditionalRender = nullptr;
+    PFNGLBLITFRAMEBUFFERPROC realBlitFramebuffer = nullptr;
+
+    uint64_t hashBytes(const void *data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief 记录调用并在跟踪时写出一行
+     * @param entry 入口
+     * @param redundant 是否冗余
+     * @param format 参数的printf格式
+     */
+    void record(GlEntry entry, bool redundant, const char *format, ...)
+    {
+        GlTrace &trace = GlTrace::getInstance();
+        trace.count(entry, redundant);
+        std::ofstream *stream = trace.getTraceStream();
+        if (stream == nullptr)
+        {
+            return;
+        }
+
+        char arguments[160];
+        va_list list;
+        va_start(list, format);
+        std::vsnprintf(arguments, sizeof(arguments), format, list);
+        va_end(list);
+        *stream << GlTrace::getEntryName(entry) << "(" << arguments << ")" << (redundant ? " # redundant" : "") << "\n";
+    }
+
+    /**
+     * @brief 查找缓冲区绑定点，不存在时创建
+     */
+    BufferBinding &findBinding(GLenum target, GLuint index)
+    {
+        for (int i = 0; i < state.bufferCount; ++i)
+        {
+            if (state.buffers[i].target == target && state.buffers[i].index == index)
+            {
+                return state.buffers[i];
+            }
+        }
+        // 绑定点数量有限，表满时复用最后一项
+        int slot = state.bufferCount < 32 ? state.bufferCount++ : 31;
+        state.buffers[slot] = {target, index, unknown, 0, 0};
+        return state.buffers[slot];
+    }
+
+    /**
+     * @brief 记录当前程序的uniform上传，返回是否与上次的值相同
+     */
+    bool isIdenticalUniform(GLint location, const void *data, size_t size)
+    {
+        if (location < 0)
+        {
+            return true;
+        }
+        uint64_t key = (static_cast<uint64_t>(state.program) << 32) | static_cast<uint32_t>(location);
+        uint64_t hash = hashBytes(data, size);
+        auto it = uniformValues.find(key);
+        if (it != uniformValues.end() && it->second == hash && state.program != unknown)
+        {
+            GlTrace::getInstance().countIdenticalUniform();
+            return true;
+        }
+        uniformValues[key] = hash;
+        return false;
+    }
+
+    void GLAPIENTRY traceUseProgram(GLuint program)
+    {
+        record(GlEntry::UseProgram, state.program == program, "%u", program);
+        state.program = program;
+        realUseProgram(program);
+    }
+
+    void GLAPIENTRY traceBindVertexArray(GLuint array)
+    {
+        record(GlEntry::BindVertexArray, state.vertexArray == array, "%u", array);
+        state.vertexArray = array;
+        realBindVertexArray(array);
+    }
+
+    void GLAPIENTRY traceBindBuffer(GLenum target, GLuint buffer)
+    {
+        // 元素缓冲区绑定属于VAO状态，切换VAO后无法得知，不判定冗余
+        bool redundant = false;
+        if (target != GL_ELEMENT_ARRAY_BUFFER)
+        {
+            BufferBinding &binding = findBinding(target, unknown);
+            redundant = binding.buffer == buffer;
+            binding.buffer = buffer;
+        }
+        record(GlEntry::BindBuffer, redundant, "0x%04X, %u", target, buffer);
+        realBindBuffer(target, buffer);
+    }
+
+    void GLAPIENTRY traceBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        BufferBinding &binding = findBinding(target, index);
+        bool redundant = binding.buffer == buffer && binding.size == 0;
+        binding.buffer = buffer;
+        binding.offset = 0;
+        binding.size = 0;
+        findBinding(target, unknown).buffer = buffer;
+        record(GlEntry::BindBufferBase, redundant, "0x%04X, %u, %u", target, index, buffer);
+        realBindBufferBase(target, index, buffer);
+    }
+
+    void GLAPIENTRY traceBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        BufferBinding &binding = findBinding(target, index);
+        bool redundant = binding.buffer == buffer && binding.offset == offset && binding.size == size;
+        binding.buffer = buffer;
+        binding.offset = offset;
+        binding.size = size;
+        findBinding(target, unknown).buffer = buffer;
+        record(GlEntry::BindBufferRange, redundant, "0x%04X, %u, %u, %lld, %lld", target, index, buffer,
+               static_cast<long long>(offset), static_cast<long long>(size));
+        realBindBufferRange(target, index, buffer, offset, size);
+    }
+
+    void GLAPIENTRY traceActiveTexture(GLenum texture)
+    {
+        record(GlEntry::ActiveTexture, state.activeTexture == texture, "GL_TEXTURE%u", texture - GL_TEXTURE0);
+        state.activeTexture = texture;
+        realActiveTexture(texture);
+    }
+
+    void GLAPIENTRY traceBindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+        bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+        bool redundant = (!draw || state.drawFramebuffer == framebuffer) && (!read || state.readFramebuffer == framebuffer);
+        state.drawFramebuffer = draw ? framebuffer : state.drawFramebuffer;
+        state.readFramebuffer = read ? framebuffer : state.readFramebuffer;
+        record(GlEntry::BindFramebuffer, redundant, "0x%04X, %u", target, framebuffer);
+        realBindFramebuffer(target, framebuffer);
+    }
+
+    GLint GLAPIENTRY traceGetUniformLocation(GLuint program, const GLchar *name)
+    {
+        // 同一程序同一名称的位置在链接之后不会变化，重复查询都可以缓存
+        uint64_t key = hashBytes(name, std::strlen(name), hashBytes(&program, sizeof(program)));
+        bool redundant = !queriedLocations.insert(key).second;
+        record(GlEntry::GetUniformLocation, redundant, "%u, \"%s\"", program, name);
+        return realGetUniformLocation(program, name);
+    }
+
+    void GLAPIENTRY traceUniform1f(GLint location, GLfloat value)
+    {
+        record(GlEntry::Uniform1f, isIdenticalUniform(location, &value, sizeof(value)), "%d, %g", location, value);
+        realUniform1f(location, value);
+    }
+
+    void GLAPIENTRY traceUniform1i(GLint location, GLint value)
+    {
+        record(GlEntry::Uniform1i, isIdenticalUniform(location, &value, sizeof(value)), "%d, %d", location, value);
+        realUniform1i(location, value);
+    }
+
+    void GLAPIENTRY traceUniform3fv(GLint location, GLsizei count, const GLfloat *value)
+    {
+        bool identical = isIdenticalUniform(location, value, sizeof(GLfloat) * 3 * count);
+        record(GlEntry::Uniform3fv, identical, "%d, %d, {%g, %g, %g}", location, count, value[0], value[1], value[2]);
+        realUniform3fv(location, count, value);
+    }
+
+    void GLAPIENTRY traceUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+    {
+        bool identical = isIdenticalUniform(location, value, sizeof(GLfloat) * 16 * count);
+        record(GlEntry::UniformMatrix4fv, identical, "%d, %d, %d, {%g, %g, %g, ...}", location, count, transpose,
+               value[0], value[1], value[2]);
+        realUniformMatrix4fv(location, count, transpose, value);
+    }
+
+    void GLAPIENTRY traceBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+    {
+        record(GlEntry::BufferData, false, "0x%04X, %lld, %s, 0x%04X", target, static_cast<long long>(size),
+               data != nullptr ? "data" : "NULL", usage);
+        realBufferData(target, size, data, usage);
+    }
+
+    void GLAPIENTRY traceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+    {
+        record(GlEntry::BufferSubData, false, "0x%04X, %lld, %lld", target, static_cast<long long>(offset),
+               static_cast<long long>(size));
+        realBufferSubData(target, offset, size, data);
+    }
+
+    void *GLAPIENTRY traceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+        record(GlEntry::MapBufferRange, false, "0x%04X, %lld, %lld, 0x%X", target, static_cast<long long>(offset),
+               static_cast<long long>(length), access);
+        return realMapBufferRange(target, offset, length, access);
+    }
+
+    void GLAPIENTRY traceDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+    {
+        record(GlEntry::DrawArraysInstanced, false, "0x%04X, %d, %d, %d", mode, first, count, instances);
+        realDrawArraysInstanced(mode, first, count, instances);
+    }
+
+    void GLAPIENTRY traceDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, void *indices,
+                                                GLint baseVertex)
+    {
+        record(GlEntry::DrawElementsBaseVertex, false, "0x%04X, %d, 0x%04X, %p, %d", mode, count, type, indices,
+               baseVertex);
+        realDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+    }
+
+    void GLAPIENTRY traceDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                         GLsizei instances, GLint baseVertex)
+    {
+        record(GlEntry::DrawElementsInstancedBaseVertex, false, "0x%04X, %d, 0x%04X, %p, %d, %d", mode, count, type,
+               indices, instances, baseVertex);
+        realDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+    }
+
+    void GLAPIENTRY traceBeginQuery(GLenum target, GLuint id)
+    {
+        record(GlEntry::BeginQuery, false, "0x%04X, %u", target, id);
+        realBeginQuery(target, id);
+    }
+
+    void GLAPIENTRY traceEndQuery(GLenum target)
+    {
+        record(GlEntry::EndQuery, false, "0x%04X", target);
+        realEndQuery(target);
+    }
+
+    void GLAPIENTRY traceBeginConditionalRender(GLuint id, GLenum mode)
+    {
+        record(GlEntry::BeginConditionalRender, false, "%u, 0x%04X", id, mode);
+        realBeginConditionalRender(id, mode);
+    }
+
+    void GLAPIENTRY traceBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0,
+                                         GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+    {
+        record(GlEntry::BlitFramebuffer, false, "%d, %d, %d, %d -> %d, %d, %d, %d, 0x%X, 0x%04X", srcX0, srcY0, srcX1,
+               srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+        realBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    }
+}
+#endif
+
+bool GlTrace::install()
+{
+#ifdef GL_TRACE
+    if (installed)
+    {
+        return true;
+    }
+
+    // 保存驱动的入口，再把GLEW的函数指针指向包装函数；此后所有经由GLEW宏的调用都先经过这里
+    realUseProgram = __glewUseProgram;
+    realBindVertexArray = __glewBindVertexArray;
+    realBindBuffer = __glewBindBuffer;
+    realBindBufferBase = __glewBindBufferBase;
+    realBindBufferRange = __glewBindBufferRange;
+    realActiveTexture = __glewActiveTexture;
+    realBindFramebuffer = __glewBindFramebuffer;
+    realGetUniformLocation = __glewGetUniformLocation;
+    realUniform1f = __glewUniform1f;
+    realUniform1i = __glewUniform1i;
+    realUniform3fv = __glewUniform3fv;
+    realUniformMatrix4fv = __glewUniformMatrix4fv;
+    realBufferData = __glewBufferData;
+    realBufferSubData = __glewBufferSubData;
+    realMapBufferRange = __glewMapBufferRange;
+    realDrawArraysInstanced = __glewDrawArraysInstanced;
+    realDrawElementsBaseVertex = __glewDrawElementsBaseVertex;
+    realDrawElementsInstancedBaseVertex = __glewDrawElementsInstancedBaseVertex;
+    realBeginQuery = __glewBeginQuery;
+    realEndQuery = __glewEndQuery;
+    realBeginConditionalRender = __glewBeginConditionalRender;
+    realBlitFramebuffer = __glewBlitFramebuffer;
+
+    __glewUseProgram = traceUseProgram;
+    __glewBindVertexArray = traceBindVertexArray;
+    __glewBindBuffer = traceBindBuffer;
+    __glewBindBufferBase = traceBindBufferBase;
+    __glewBindBufferRange = traceBindBufferRange;
+    __glewActiveTexture = traceActiveTexture;
+    __glewBindFramebuffer = traceBindFramebuffer;
+    __glewGetUniformLocation = traceGetUniformLocation;
+    __glewUniform1f = traceUniform1f;
+    __glewUniform1i = traceUniform1i;
+    __glewUniform3fv = traceUniform3fv;
+    __glewUniformMatrix4fv = traceUniformMatrix4fv;
+    __glewBufferData = traceBufferData;
+    __glewBufferSubData = traceBufferSubData;
+    __glewMapBufferRange = traceMapBufferRange;
+    __glewDrawArraysInstanced = traceDrawArraysInstanced;
+    __glewDrawElementsBaseVertex = traceDrawElementsBaseVertex;
+    __glewDrawElementsInstancedBaseVertex = traceDrawElementsInstancedBaseVertex;
+    __glewBeginQuery = traceBeginQuery;
+    __glewEndQuery = traceEndQuery;
+    __glewBeginConditionalRender = traceBeginConditionalRender;
+    __glewBlitFramebuffer = traceBlitFramebuffer;
+
+    // 预留表项，稳定状态下统计本身不再分配内存
+    uniformValues.reserve(4096);
+    queriedLocations.reserve(1024);
+    installed = true;
+    current.enabled = true;
+    lastFrame.enabled = true;
+    totals.enabled = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void GlTrace::endFrame()
+{
+    if (!installed)
+    {
+        return;
+    }
+
+    for (int i = 0; i < static_cast<int>(GlEntry::Count); ++i)
+    {
+        current.totalCalls += current.calls[i];
+        current.redundantCalls += current.redundant[i];
+    }
+
+    // 第一帧包含初始化阶段的调用，不计入累计统计
+    if (frameCount > 0)
+    {
+        for (int i = 0; i < static_cast<int>(GlEntry::Count); ++i)
+        {
+            totals.calls[i] += current.calls[i];
+            totals.redundant[i] += current.redundant[i];
+        }
+        totals.totalCalls += current.totalCalls;
+        totals.redundantCalls += current.redundantCalls;
+        totals.identicalUniforms += current.identicalUniforms;
+    }
+    lastFrame = current;
+    current = GlCallStats();
+    current.enabled = true;
+    ++frameCount;
+
+    // 调用序列按帧分段，每段以帧号开头
+    if (tracing && frameCount >= traceStart + traceFrames)
+    {
+        tracing = false;
+        traceStart = -1;
+        traceFile.close();
+        std::cout << "GL call trace written" << std::endl;
+    }
+    else if (!tracing && traceStart >= 0 && frameCount >= traceStart)
+    {
+        tracing = true;
+    }
+    if (tracing)
+    {
+        traceFile << "# frame " << frameCount << "\n";
+    }
+}
+
+void GlTrace::invalidateState()
+{
+#ifdef GL_TRACE
+    TrackedState reset;
+    state = reset;
+#endif
+}
+
+bool GlTrace::startTrace(const std::string &path)
+{
+    if (!installed)
+    {
+        std::cerr << "GL call tracing requires a build with -DGL_TRACE=ON" << std::endl;
+        return false;
+    }
+    traceFile.open(path);
+    if (!traceFile)
+    {
+        std::cerr << "Failed to open GL trace output: " << path << std::endl;
+        return false;
+    }
+    traceStart = frameCount + traceWarmupFrames;
+    return true;
+}
+
+const char *GlTrace::getEntryName(GlEntry entry)
+{
+    int index = static_cast<int>(entry);
+    return index >= 0 && index < static_cast<int>(GlEntry::Count) ? entryNames[index] : "unknown";
+}
@@ -0,0 +1,175 @@
+/**
+ * @file gl_trace.h
+ * @brief GL调用拦截头文件
+ * @details 定义了可选的GL调用统计层：以GL_TRACE构建时把GLEW的函数指针替换为计数和跟踪的包装函数，
+ * 按入口统计每帧调用次数，标记冗余的状态设置和相同的uniform上传，并可把完整调用序列写入文件
+ */
+
+#pragma once
+#include <fstream>
+#include <string>
+
+/**
+ * @enum GlEntry
+ * @brief 被拦截的GL入口
+ * @details 只有GLEW以函数指针提供的入口（GL 1.2及以后）可以被替换，
+ * glDrawArrays、glBindTexture、glClear等GL 1.1入口直接链接到驱动库，不在统计范围内
+ */
+enum class GlEntry : int
+{
+    UseProgram,
+    BindVertexArray,
+    BindBuffer,
+    BindBufferBase,
+    BindBufferRange,
+    ActiveTexture,
+    BindFramebuffer,
+    GetUniformLocation,
+    Uniform1f,
+    Uniform1i,
+    Uniform3fv,
+    UniformMatrix4fv,
+    BufferData,
+    BufferSubData,
+    MapBufferRange,
+    DrawArraysInstanced,
+    DrawElementsBaseVertex,
+    DrawElementsInstancedBaseVertex,
+    BeginQuery,
+    EndQuery,
+    BeginConditionalRender,
+    BlitFramebuffer,
+    Count
+};
+
+/**
+ * @struct GlCallStats
+ * @brief 一帧的GL调用统计
+ */
+struct GlCallStats
+{
+    bool enabled = false;                                    // 是否已安装拦截层
+    long long calls[static_cast<int>(GlEntry::Count)] = {};     // 各入口调用次数
+    long long redundant[static_cast<int>(GlEntry::Count)] = {}; // 各入口的冗余调用次数
+    long long totalCalls = 0;                                // 所有入口调用次数之和
+    long long redundantCalls = 0;                            // 冗余调用次数之和
+    long long identicalUniforms = 0;                         // 与该程序该位置上次上传值相同的uniform调用
+};
+
+/**
+ * @class GlTrace
+ * @brief GL调用统计层，使用单例模式实现
+ * @details 冗余的判定：绑定与当前绑定相同的程序、VAO、缓冲区、纹理单元或帧缓冲区；
+ * 对同一程序同一名称重复查询uniform位置；向-1位置上传或上传与上次相同的uniform值。
+ * 绑定状态只跟踪经过GLEW的调用，ImGui后端自带加载器发出的调用之后需要invalidateState。
+ * 所有被拦截的调用都应来自持有GL上下文的线程
+ */
+class GlTrace
+{
+public:
+    /**
+     * @brief 获取GlTrace单例实例
+     * @return GlTrace& 单例实例的引用
+     */
+    static GlTrace &getInstance()
+    {
+        static GlTrace instance;
+        return instance;
+    }
+
+    /**
+     * @brief 替换GLEW函数指针
+     * @return bool 是否已安装，未以GL_TRACE构建时返回false；需要在glewInit之后调用
+     */
+    bool install();
+
+    /**
+     * @brief 结束一帧
+     * @details 在交换缓冲区之后由持有GL上下文的线程调用，保存本帧统计并清零计数
+     */
+    void endFrame();
+
+    /**
+     * @brief 清除跟踪的绑定状态
+     * @details 在不经过GLEW的代码修改了绑定之后调用，避免把之后的绑定误判为冗余
+     */
+    void invalidateState();
+
+    /**
+     * @brief 把之后若干帧的完整调用序列写入文件
+     * @param path 输出文件路径，每行一次调用，便于两次运行之间对比
+     * @return bool 文件是否成功打开
+     * @details 先跳过traceWarmupFrames帧，再记录traceFrames帧
+     */
+    bool startTrace(const std::string &path);
+
+    /**
+     * @brief 获取上一帧的统计
+     * @return const GlCallStats& 统计
+     */
+    const GlCallStats &getLastFrame() const { return lastFrame; }
+
+    /**
+     * @brief 获取累计统计
+     * @return const GlCallStats& 除第一帧（含初始化）以外所有帧的累计统计
+     */
+    const GlCallStats &getTotals() const { return totals; }
+
+    /**
+     * @brief 获取已结束的帧数
+     * @return long long 帧数，包括第一帧
+     */
+    long long getFrameCount() const { return frameCount; }
+
+    /**
+     * @brief 获取入口名称
+     * @param entry 入口
+     * @return const char* 例如 "glUseProgram"
+     */
+    static const char *getEntryName(GlEntry entry);
+
+    /**
+     * @brief 记录一次调用
+     * @param entry 入口
+     * @param redundant 是否冗余
+     */
+    void count(GlEntry entry, bool redundant)
+    {
+        int index = static_cast<int>(entry);
+        ++current.calls[index];
+        current.redundant[index] += redundant ? 1 : 0;
+    }
+
+    /**
+     * @brief 记录一次相同值的uniform上传
+     */
+    void countIdenticalUniform() { ++current.identicalUniforms; }
+
+    /**
+     * @brief 获取跟踪输出流
+     * @return std::ofstream* 正在记录调用序列时返回输出流，否则返回nullptr
+     */
+    std::ofstream *getTraceStream() { return tracing ? &traceFile : nullptr; }
+
+    int traceWarmupFrames = 60; // 开始记录调用序列之前跳过的帧数
+    int traceFrames = 3;        // 记录调用序列的帧数
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    GlTrace() = default;
+    ~GlTrace() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    GlTrace(const GlTrace &) = delete;
+    GlTrace &operator=(const GlTrace &) = delete;
+
+    GlCallStats current;         // 本帧统计
+    GlCallStats lastFrame;       // 上一帧统计
+    GlCallStats totals;          // 累计统计
+    long long frameCount = 0;    // 已结束的帧数
+    bool installed = false;      // 是否已替换函数指针
+
+    std::ofstream traceFile;     // 调用序列输出文件
+    long long traceStart = -1;   // 开始记录的帧号，-1表示未请求
+    bool tracing = false;        // 本帧是否记录调用序列
+};
@@ -0,0 +1,113 @@
+#include "gpu_query.h"
+
+void GpuQuery::init()
+{
+    glGenQueries(queryCount, queries);
+    for (int i = 0; i < queryCount; ++i)
+    {
+        pending[i] = false;
+    }
+    current = 0;
+    active = false;
+    resetTotals();
+}
+
+void GpuQuery::cleanup()
+{
+    if (queries[0] != 0)
+    {
+        glDeleteQueries(queryCount, queries);
+        for (int i = 0; i < queryCount; ++i)
+        {
+            queries[i] = 0;
+            pending[i] = false;
+        }
+    }
+    active = false;
+}
+
+void GpuQuery::begin()
+{
+    if (queries[0] == 0 || active)
+    {
+        return;
+    }
+
+    // 按提交顺序收集所有已完成的结果
+    for (int offset = 0; offset < queryCount; ++offset)
+    {
+        int index = (current + offset) % queryCount;
+        if (pending[index])
+        {
+            collect(index, false);
+        }
+    }
+
+    // 下一个查询仍在进行中时跳过本次查询，不等待GPU
+    if (pending[current])
+    {
+        return;
+    }
+
+    glBeginQuery(target, queries[current]);
+    active = true;
+}
+
+void GpuQuery::end()
+{
+    if (!active)
+    {
+        return;
+    }
+
+    glEndQuery(target);
+    pending[current] = true;
+    current = (current + 1) % queryCount;
+    active = false;
+}
+
+void GpuQuery::flush()
+{
+    // 按提交顺序收集，保证lastMs为最新一次结果
+    for (int offset = 0; offset < queryCount; ++offset)
+    {
+        int index = (current + offset) % queryCount;
+        if (pending[index])
+        {
+            collect(index, true);
+        }
+    }
+}
+
+void GpuQuery::resetTotals()
+{
+    lastValue = 0;
+    totalValue = 0;
+    minValue = 0;
+    maxValue = 0;
+    resultCount = 0;
+}
+
+bool GpuQuery::collect(int index, bool wait)
+{
+    if (!wait)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            return false;
+        }
+    }
+
+    GLuint64 value = 0;
+    glGetQueryObjectui64v(queries[index], GL_QUERY_RESULT, &value);
+    pending[index] = false;
+
+    lastValue = value;
+    totalValue += value;
+    minValue = resultCount == 0 ? value : (value < minValue ? value : minValue);
+    maxValue = value > maxValue ? value : maxValue;
+    ++resultCount;
+    return true;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file gpu_query.h
+ * @brief GPU查询头文件
+ * @details 定义了异步读取结果的GL查询对象环，用于计时和样本计数，不会阻塞CPU
+ */
+
+#pragma once
+#include <GL/glew.h>
+
+/**
+ * @class GpuQuery
+ * @brief 异步GPU查询
+ * @details 使用环形排列的多个查询对象，每帧只读取已经完成的查询结果，
+ * 因此测得的值通常滞后若干帧。同一目标同一时刻只能有一个查询处于begin/end之间
+ */
+class GpuQuery
+{
+public:
+    /**
+     * @brief 构造查询
+     * @param target 查询目标，例如GL_TIME_ELAPSED或GL_SAMPLES_PASSED
+     */
+    explicit GpuQuery(GLenum target) : target(target) {}
+    ~GpuQuery() = default;
+
+    // 查询对象属于GL上下文，禁止拷贝
+    GpuQuery(const GpuQuery &) = delete;
+    GpuQuery &operator=(const GpuQuery &) = delete;
+
+    /**
+     * @brief 创建查询对象
+     * @details 需要在GL上下文创建之后调用
+     */
+    void init();
+
+    /**
+     * @brief 删除查询对象
+     */
+    void cleanup();
+
+    /**
+     * @brief 开始查询
+     * @details 若环中下一个查询的结果尚未就绪，则跳过本次查询以避免阻塞
+     */
+    void begin();
+
+    /**
+     * @brief 结束查询
+     */
+    void end();
+
+    /**
+     * @brief 阻塞等待所有进行中的查询并收集结果
+     * @details 仅用于基准测试等需要精确结果的场景
+     */
+    void flush();
+
+    /**
+     * @brief 获取最近一次完成的查询结果
+     * @return GLuint64 原始结果（计时为纳秒，样本计数为样本数），尚无结果时为0
+     */
+    GLuint64 getLastValue() const { return lastValue; }
+
+    /**
+     * @brief 获取累计完成的查询次数
+     * @return int 已读取结果的查询数量
+     */
+    int getResultCount() const { return resultCount; }
+
+    /**
+     * @brief 获取累计的查询结果
+     * @return GLuint64 所有已读取结果之和
+     */
+    GLuint64 getTotalValue() const { return totalValue; }
+
+    /**
+     * @brief 获取累计结果中的最小值
+     * @return GLuint64 自上次清零以来的最小结果，尚无结果时为0
+     */
+    GLuint64 getMinValue() const { return minValue; }
+
+    /**
+     * @brief 获取累计结果中的最大值
+     * @return GLuint64 自上次清零以来的最大结果
+     */
+    GLuint64 getMaxValue() const { return maxValue; }
+
+    /**
+     * @brief 清零累计结果
+     */
+    void resetTotals();
+
+private:
+    /**
+     * @brief 读取指定查询的结果
+     * @param index 查询在环中的索引
+     * @param wait 是否阻塞等待结果
+     * @return bool 是否读取到结果
+     */
+    bool collect(int index, bool wait);
+
+    static constexpr int queryCount = 4; // 环中查询对象数量
+
+    GLenum target;                   // 查询目标
+    GLuint queries[queryCount] = {}; // 查询对象
+    bool pending[queryCount] = {};   // 查询是否已提交但未读取
+    int current = 0;                 // 下一个使用的查询索引
+    bool active = false;             // 当前是否处于begin/end之间
+    GLuint64 lastValue = 0;          // 最近一次完成的结果
+    GLuint64 totalValue = 0;         // 累计结果
+    GLuint64 minValue = 0;           // 累计结果中的最小值
+    GLuint64 maxValue = 0;           // 累计结果中的最大值
+    int resultCount = 0;             // 累计查询次数
+};
@@ -0,0 +1,43 @@
+/**
+ * @file gpu_timer.h
+ * @brief GPU计时器头文件
+ * @details 定义了基于GL_TIME_ELAPSED查询的GPU计时器
+ */
+
+#pragma once
+#include "gpu_query.h"
+
+/**
+ * @class GpuTimer
+ * @brief GPU计时器
+ * @details 在GpuQuery基础上把纳秒结果换算为毫秒。同一时刻只能有一个计时器处于begin/end之间
+ */
+class GpuTimer : public GpuQuery
+{
+public:
+    GpuTimer() : GpuQuery(GL_TIME_ELAPSED) {}
+
+    /**
+     * @brief 获取最近一次完成的GPU耗时
+     * @return double GPU耗时（毫秒），尚无结果时为0
+     */
+    double getLastMs() const { return static_cast<double>(getLastValue()) / 1.0e6; }
+
+    /**
+     * @brief 获取累计的GPU耗时
+     * @return double 所有已读取结果之和（毫秒）
+     */
+    double getTotalMs() const { return static_cast<double>(getTotalValue()) / 1.0e6; }
+
+    /**
+     * @brief 获取累计结果中的最小GPU耗时
+     * @return double 最小耗时（毫秒）
+     */
+    double getMinMs() const { return static_cast<double>(getMinValue()) / 1.0e6; }
+
+    /**
+     * @brief 获取累计结果中的最大GPU耗时
+     * @return double 最大耗时（毫秒）
+     */
+    double getMaxMs() const { return static_cast<double>(getMaxValue()) / 1.0e6; }
+};
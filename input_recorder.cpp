@@ -0,0 +1,309 @@
+#include "input_recorder.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+    const char fileMagic[4] = {'S', 'D', 'I', 'R'};
+}
+
+void InputRecorder::startRecording(const std::string &path, double timeStep)
+{
+    this->path = path;
+    this->timeStep = timeStep;
+    mode = Mode::Record;
+    buffer.clear();
+    lastFrame = 0;
+    currentFrame = 0;
+    lastKeys = 0;
+    hasState = false;
+
+    uint16_t version = formatVersion;
+    uint16_t reserved = 0;
+    writeBytes(fileMagic, sizeof(fileMagic));
+    writeBytes(&version, sizeof(version));
+    writeBytes(&reserved, sizeof(reserved));
+    writeBytes(&timeStep, sizeof(timeStep));
+}
+
+bool InputRecorder::startReplay(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Failed to open input log: " << path << std::endl;
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    readOffset = 0;
+    char magic[4] = {};
+    uint16_t version = 0;
+    uint16_t reserved = 0;
+    if (!readBytes(magic, sizeof(magic)) || std::memcmp(magic, fileMagic, sizeof(magic)) != 0 ||
+        !readBytes(&version, sizeof(version)) || !readBytes(&reserved, sizeof(reserved)) ||
+        !readBytes(&timeStep, sizeof(timeStep)))
+    {
+        std::cerr << "Invalid input log: " << path << std::endl;
+        buffer.clear();
+        return false;
+    }
+    if (version != formatVersion)
+    {
+        std::cerr << "Unsupported input log version " << version << " (expected " << formatVersion
+                  << "), re-record " << path << std::endl;
+        buffer.clear();
+        return false;
+    }
+
+    // 扫描一遍得到总帧数，再回到第一个事件
+    size_t firstEvent = readOffset;
+    lastFrame = 0;
+    hasPending = false;
+    frameCount = 0;
+    Event event;
+    while (peekEvent(&event))
+    {
+        frameCount = event.type == EventType::End ? event.frame : event.frame + 1;
+        hasPending = false;
+        readOffset = pendingEnd;
+    }
+
+    readOffset = firstEvent;
+    lastFrame = 0;
+    lastKeys = 0;
+    hasPending = false;
+    mode = Mode::Replay;
+    return true;
+}
+
+bool InputRecorder::stop()
+{
+    bool ok = true;
+    if (mode == Mode::Record)
+    {
+        writeHeader(EventType::End);
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        ok = static_cast<bool>(file);
+        if (ok)
+            std::cout << "Input log written to " << path << " (" << buffer.size() << " bytes, "
+                      << currentFrame << " frames)" << std::endl;
+        else
+            std::cerr << "Failed to write input log: " << path << std::endl;
+    }
+
+    mode = Mode::Off;
+    buffer.clear();
+    return ok;
+}
+
+void InputRecorder::recordKeys(uint8_t keys)
+{
+    if (mode != Mode::Record || keys == lastKeys)
+    {
+        return;
+    }
+    writeHeader(EventType::Keys);
+    writeBytes(&keys, sizeof(keys));
+    lastKeys = keys;
+}
+
+void InputRecorder::recordScroll(float yoffset)
+{
+    if (mode != Mode::Record)
+    {
+        return;
+    }
+    writeHeader(EventType::Scroll);
+    writeBytes(&yoffset, sizeof(yoffset));
+}
+
+void InputRecorder::recordUiState(const UiState &state)
+{
+    if (mode != Mode::Record || (hasState && state == lastState))
+    {
+        return;
+    }
+    writeHeader(EventType::UiState);
+    writeState(state);
+    lastState = state;
+    hasState = true;
+}
+
+void InputRecorder::recordCameraReset()
+{
+    if (mode != Mode::Record)
+    {
+        return;
+    }
+    writeHeader(EventType::CameraReset);
+}
+
+uint8_t InputRecorder::replayFrameBegin(const std::function<void(const Event &)> &apply)
+{
+    Event event;
+    while (mode == Mode::Replay && peekEvent(&event) && event.frame == currentFrame &&
+           (event.type == EventType::Keys || event.type == EventType::UiState))
+    {
+        hasPending = false;
+        readOffset = pendingEnd;
+        if (event.type == EventType::Keys)
+            lastKeys = event.keys;
+        else
+            apply(event);
+    }
+    return lastKeys;
+}
+
+void InputRecorder::replayFrameEnd(const std::function<void(const Event &)> &apply)
+{
+    Event event;
+    while (mode == Mode::Replay && peekEvent(&event) && event.frame <= currentFrame &&
+           event.type != EventType::End)
+    {
+        hasPending = false;
+        readOffset = pendingEnd;
+        if (event.type == EventType::Keys)
+            lastKeys = event.keys;
+        else
+            apply(event);
+    }
+}
+
+void InputRecorder::writeHeader(EventType type)
+{
+    // 帧号增量用LEB128编码，绝大多数事件只占1字节
+    uint32_t delta = currentFrame - lastFrame;
+    lastFrame = currentFrame;
+    do
+    {
+        uint8_t byte = delta & 0x7F;
+        delta >>= 7;
+        if (delta != 0)
+            byte |= 0x80;
+        buffer.push_back(byte);
+    } while (delta != 0);
+
+    buffer.push_back(static_cast<uint8_t>(type));
+}
+
+bool InputRecorder::peekEvent(Event *event)
+{
+    if (hasPending)
+    {
+        *event = pending;
+        return true;
+    }
+
+    size_t start = readOffset;
+    uint32_t delta = 0;
+    int shift = 0;
+    uint8_t byte = 0;
+    do
+    {
+        if (!readBytes(&byte, sizeof(byte)) || shift > 28)
+        {
+            readOffset = start;
+            return false;
+        }
+        delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    uint8_t type = 0;
+    Event decoded;
+    bool ok = readBytes(&type, sizeof(type));
+    decoded.type = static_cast<EventType>(type);
+    decoded.frame = lastFrame + delta;
+    switch (decoded.type)
+    {
+    case EventType::Keys:
+        ok = ok && readBytes(&decoded.keys, sizeof(decoded.keys));
+        break;
+    case EventType::Scroll:
+        ok = ok && readBytes(&decoded.scroll, sizeof(decoded.scroll));
+        break;
+    case EventType::UiState:
+        ok = ok && readState(&decoded.state);
+        break;
+    case EventType::CameraReset:
+    case EventType::End:
+        break;
+    default:
+        ok = false;
+        break;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Corrupt input log at offset " << start << std::endl;
+        readOffset = buffer.size();
+        return false;
+    }
+
+    // 解码后回退读取位置，由调用方决定是否消费
+    pendingEnd = readOffset;
+    readOffset = start;
+    lastFrame = decoded.frame;
+    pending = decoded;
+    hasPending = true;
+    *event = decoded;
+    return true;
+}
+
+void InputRecorder::writeState(const UiState &state)
+{
+    writeBytes(&state.vertexShader, sizeof(state.vertexShader));
+    writeBytes(&state.fragmentShader, sizeof(state.fragmentShader));
+    writeBytes(&state.instanceCount, sizeof(state.instanceCount));
+    writeBytes(&state.flags, sizeof(state.flags));
+    writeBytes(&state.msaaSamples, sizeof(state.msaaSamples));
+    writeBytes(&state.budgetMs, sizeof(state.budgetMs));
+    writeBytes(&state.minScale, sizeof(state.minScale));
+    writeBytes(&state.maxScale, sizeof(state.maxScale));
+    writeBytes(&state.fixedScale, sizeof(state.fixedScale));
+    writeBytes(&state.commandThreads, sizeof(state.commandThreads));
+    writeBytes(&state.textureBudgetKB, sizeof(state.textureBudgetKB));
+    writeBytes(&state.particleCount, sizeof(state.particleCount));
+    writeBytes(&state.voxelMeshMode, sizeof(state.voxelMeshMode));
+    writeBytes(&state.highlightInstance, sizeof(state.highlightInstance));
+}
+
+bool InputRecorder::readState(UiState *state)
+{
+    return readBytes(&state->vertexShader, sizeof(state->vertexShader)) &&
+           readBytes(&state->fragmentShader, sizeof(state->fragmentShader)) &&
+           readBytes(&state->instanceCount, sizeof(state->instanceCount)) &&
+           readBytes(&state->flags, sizeof(state->flags)) &&
+           readBytes(&state->msaaSamples, sizeof(state->msaaSamples)) &&
+           readBytes(&state->budgetMs, sizeof(state->budgetMs)) &&
+           readBytes(&state->minScale, sizeof(state->minScale)) &&
+           readBytes(&state->maxScale, sizeof(state->maxScale)) &&
+           readBytes(&state->fixedScale, sizeof(state->fixedScale)) &&
+           readBytes(&state->commandThreads, sizeof(state->commandThreads)) &&
+           readBytes(&state->textureBudgetKB, sizeof(state->textureBudgetKB)) &&
+           readBytes(&state->particleCount, sizeof(state->particleCount)) &&
+           readBytes(&state->voxelMeshMode, sizeof(state->voxelMeshMode)) &&
+           readBytes(&state->highlightInstance, sizeof(state->highlightInstance));
+}
+
+void InputRecorder::writeBytes(const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+bool InputRecorder::readBytes(void *data, size_t size)
+{
+    if (readOffset + size > buffer.size())
+    {
+        return false;
+    }
+    std::memcpy(data, buffer.data() + readOffset, size);
+    readOffset += size;
+    return true;
+}
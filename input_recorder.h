@@ -0,0 +1,245 @@
+/**
+ * @file input_recorder.h
+ * @brief 输入录制与回放头文件
+ * @details 定义了按帧记录键盘、滚轮和UI操作的紧凑二进制日志，以及按相同帧序回放日志的录制器
+ */
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @class InputRecorder
+ * @brief 输入录制器，使用单例模式实现
+ * @details 日志格式：8字节文件头（"SDIR"、版本号、保留字段）、8字节的固定时间步长，
+ * 之后是事件序列。每个事件以LEB128编码的帧号增量开头，随后是1字节类型和定长负载。
+ * UI状态负载包含UI能修改的全部渲染设置，增减字段时提升版本号，旧版本的日志拒绝回放。
+ * 方向键和UI状态只在变化时记录，在帧开始渲染前采样；滚轮和相机重置在事件发生时记录。
+ * 回放时帧开始前应用该帧的按键和UI状态事件，帧结束后应用其余事件，与交互运行时的顺序一致
+ */
+class InputRecorder
+{
+public:
+    /**
+     * @brief 录制器工作模式
+     */
+    enum class Mode
+    {
+        Off,
+        Record,
+        Replay
+    };
+
+    /**
+     * @brief 事件类型
+     */
+    enum class EventType : uint8_t
+    {
+        Keys = 1,        // 方向键位掩码变化
+        Scroll = 2,      // 滚轮偏移
+        UiState = 3,     // UI控制的状态变化
+        CameraReset = 4, // UI重置相机
+        End = 5          // 日志结束，帧号为总帧数
+    };
+
+    /**
+     * @struct UiState
+     * @brief 由UI控制的渲染状态
+     */
+    struct UiState
+    {
+        uint8_t vertexShader = 0;   // 顶点着色器索引
+        uint8_t fragmentShader = 0; // 片段着色器索引
+        uint32_t instanceCount = 1; // 立方体数量
+        uint32_t flags = 0;         // 渲染设置的开关，见Flag*常量
+        uint8_t msaaSamples = 0;    // 多重采样数
+        float budgetMs = 16.0f;     // 动态分辨率的GPU耗时预算（毫秒）
+        float minScale = 0.5f;      // 动态分辨率的最小渲染比例
+        float maxScale = 1.0f;      // 动态分辨率的最大渲染比例
+        float fixedScale = 1.0f;    // 关闭自动调整时的渲染比例
+        uint16_t commandThreads = 0; // 渲染队列录制命令列表的线程数
+        uint32_t textureBudgetKB = 1024; // 每帧纹理上传预算（KB）
+        uint32_t particleCount = 100000; // 粒子数
+        uint8_t voxelMeshMode = 2;  // 体素网格生成方式，VoxelMeshMode的取值
+        int32_t highlightInstance = -1; // 鼠标拾取的高亮实例，-1表示不高亮
+
+        bool operator==(const UiState &other) const
+        {
+            return vertexShader == other.vertexShader && fragmentShader == other.fragmentShader &&
+                   instanceCount == other.instanceCount && flags == other.flags && msaaSamples == other.msaaSamples &&
+                   budgetMs == other.budgetMs && minScale == other.minScale && maxScale == other.maxScale &&
+                   fixedScale == other.fixedScale && commandThreads == other.commandThreads &&
+                   textureBudgetKB == other.textureBudgetKB && particleCount == other.particleCount &&
+                   voxelMeshMode == other.voxelMeshMode && highlightInstance == other.highlightInstance;
+        }
+        bool operator!=(const UiState &other) const { return !(*this == other); }
+    };
+
+    // UiState::flags的位定义
+    static constexpr uint32_t FlagSortFrontToBack = 1u << 0;
+    static constexpr uint32_t FlagDepthPrepass = 1u << 1;
+    static constexpr uint32_t FlagShowOverdraw = 1u << 2;
+    static constexpr uint32_t FlagDynamicResolution = 1u << 3;
+    static constexpr uint32_t FlagOcclusionConditional = 1u << 4;
+    static constexpr uint32_t FlagOcclusionTemporal = 1u << 5;
+    static constexpr uint32_t FlagVoxelWorld = 1u << 6;
+    static constexpr uint32_t FlagParticles = 1u << 7;
+    static constexpr uint32_t FlagAliasTransients = 1u << 8;
+    static constexpr uint32_t FlagMixedPrograms = 1u << 9;
+    static constexpr uint32_t FlagRenderQueue = 1u << 10;
+    static constexpr uint32_t FlagTextureCompression = 1u << 11;
+    static constexpr uint32_t FlagParticleCpuUpdate = 1u << 12;
+    static constexpr uint32_t FlagBloom = 1u << 13;
+
+    /**
+     * @struct Event
+     * @brief 解码后的事件
+     */
+    struct Event
+    {
+        uint32_t frame = 0;                   // 事件所在帧
+        EventType type = EventType::End;      // 事件类型
+        uint8_t keys = 0;                     // Keys事件的方向键位掩码
+        float scroll = 0.0f;                  // Scroll事件的偏移
+        UiState state;                        // UiState事件的状态
+    };
+
+    /**
+     * @brief 获取InputRecorder单例实例
+     * @return InputRecorder& 单例实例的引用
+     */
+    static InputRecorder &getInstance()
+    {
+        static InputRecorder instance;
+        return instance;
+    }
+
+    /**
+     * @brief 开始录制
+     * @param path 日志文件路径，stop时写入
+     * @param timeStep 回放时每帧推进的着色器time值
+     */
+    void startRecording(const std::string &path, double timeStep);
+
+    /**
+     * @brief 加载日志并开始回放
+     * @param path 日志文件路径
+     * @return bool 日志是否有效
+     */
+    bool startReplay(const std::string &path);
+
+    /**
+     * @brief 停止录制或回放
+     * @return bool 录制模式下日志是否成功写出，其他模式总是返回true
+     */
+    bool stop();
+
+    /**
+     * @brief 获取当前模式
+     */
+    Mode getMode() const { return mode; }
+
+    /**
+     * @brief 获取日志的固定时间步长
+     */
+    double getTimeStep() const { return timeStep; }
+
+    /**
+     * @brief 获取回放日志的总帧数
+     */
+    uint32_t getFrameCount() const { return frameCount; }
+
+    /**
+     * @brief 设置当前帧号
+     * @param frame 帧号，录制的事件以此为时间戳
+     */
+    void beginFrame(uint32_t frame) { currentFrame = frame; }
+
+    /**
+     * @brief 录制方向键状态，只在变化时写入
+     */
+    void recordKeys(uint8_t keys);
+
+    /**
+     * @brief 录制滚轮偏移
+     */
+    void recordScroll(float yoffset);
+
+    /**
+     * @brief 录制UI状态，只在变化时写入
+     */
+    void recordUiState(const UiState &state);
+
+    /**
+     * @brief 录制相机重置
+     */
+    void recordCameraReset();
+
+    /**
+     * @brief 回放当前帧开始前的按键和UI状态事件
+     * @param apply 对每个UI状态事件调用的回调
+     * @return uint8_t 本帧生效的方向键位掩码
+     */
+    uint8_t replayFrameBegin(const std::function<void(const Event &)> &apply);
+
+    /**
+     * @brief 回放当前帧结束时的事件
+     * @param apply 对每个事件调用的回调
+     */
+    void replayFrameEnd(const std::function<void(const Event &)> &apply);
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    InputRecorder() = default;
+    ~InputRecorder() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    InputRecorder(const InputRecorder &) = delete;
+    InputRecorder &operator=(const InputRecorder &) = delete;
+
+    /**
+     * @brief 写入事件头（帧号增量和类型）
+     */
+    void writeHeader(EventType type);
+
+    /**
+     * @brief 解码下一个事件
+     * @param event 输出的事件
+     * @return bool 是否还有事件
+     */
+    bool peekEvent(Event *event);
+
+    /**
+     * @brief 写入UI状态负载
+     */
+    void writeState(const UiState &state);
+
+    /**
+     * @brief 读取UI状态负载
+     * @return bool 负载是否完整
+     */
+    bool readState(UiState *state);
+
+    void writeBytes(const void *data, size_t size);
+    bool readBytes(void *data, size_t size);
+
+    // 日志格式版本，UiState负载或事件编码的任何变化都要提升；版本2在多次追加字段后布局不唯一，一律拒绝
+    static constexpr uint16_t formatVersion = 3;
+
+    Mode mode = Mode::Off;        // 当前模式
+    std::string path;             // 录制日志路径
+    std::vector<uint8_t> buffer;  // 录制缓冲区或加载的日志
+    size_t readOffset = 0;        // 回放读取位置
+    uint32_t lastFrame = 0;       // 上一个事件的帧号
+    uint32_t currentFrame = 0;    // 当前帧号
+    uint32_t frameCount = 0;      // 回放日志的总帧数
+    double timeStep = 1.0 / 60.0; // 固定时间步长
+    uint8_t lastKeys = 0;         // 上一次录制或回放的方向键位掩码
+    UiState lastState;            // 上一次录制的UI状态
+    bool hasState = false;        // 是否已录制过UI状态
+    bool hasPending = false;      // 是否有已解码未消费的事件
+    Event pending;                // 已解码未消费的事件
+    size_t pendingEnd = 0;        // 已解码事件之后的读取位置
+};
@@ -0,0 +1,331 @@
+#include "instance_picker.h"
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define INSTANCE_PICKER_SSE 1
+#endif
+
+void InstancePicker::build(const std::vector<Scene::Instance> &instances)
+{
+    auto start = std::chrono::steady_clock::now();
+    const uint32_t count = static_cast<uint32_t>(instances.size());
+
+    instanceCubes.resize(count);
+    cubeIndex.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        instanceCubes[i] = glm::vec4(instances[i].position, 0.5f * instances[i].scale);
+        cubeIndex[i] = i;
+    }
+
+    // 每个四叉节点平均覆盖约十个实例，预留后构建期间不重新分配
+    nodes.clear();
+    nodes.reserve(count / 8 + 1);
+    stats.depth = 0;
+    if (count > 0)
+    {
+        buildNode(0, count, 1);
+    }
+
+    // 立方体按叶子顺序排列，叶子内的精确测试连续访问内存
+    cubes.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        cubes[i] = instanceCubes[cubeIndex[i]];
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    stats.instances = static_cast<int>(count);
+    stats.nodes = static_cast<int>(nodes.size());
+    stats.buildMs = elapsed.count();
+}
+
+uint32_t InstancePicker::buildNode(uint32_t begin, uint32_t end, int depth)
+{
+    const uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    stats.depth = std::max(stats.depth, depth);
+
+    // 先一分为二，超过叶子容量的一半再各分一次，最多四个子区间
+    uint32_t bounds[5] = {begin, end, end, end, end};
+    int lanes = 1;
+    if (end - begin > static_cast<uint32_t>(leafSize))
+    {
+        uint32_t middle = splitRange(begin, end);
+        uint32_t halves[3] = {begin, middle, end};
+        lanes = 0;
+        for (int half = 0; half < 2; ++half)
+        {
+            bounds[lanes++] = halves[half];
+            if (halves[half + 1] - halves[half] > static_cast<uint32_t>(leafSize))
+            {
+                bounds[lanes++] = splitRange(halves[half], halves[half + 1]);
+            }
+        }
+        bounds[lanes] = end;
+    }
+
+    Node node = {};
+    node.laneMask = (1 << lanes) - 1;
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        // 空的子节点包围盒放在无穷远，掩码之外的结果本来也会被丢弃
+        node.minX[lane] = node.minY[lane] = node.minZ[lane] = FLT_MAX;
+        node.maxX[lane] = node.maxY[lane] = node.maxZ[lane] = FLT_MAX;
+    }
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        const uint32_t first = bounds[lane];
+        const uint32_t last = bounds[lane + 1];
+        glm::vec3 low(FLT_MAX);
+        glm::vec3 high(-FLT_MAX);
+        for (uint32_t i = first; i < last; ++i)
+        {
+            const glm::vec4 &cube = instanceCubes[cubeIndex[i]];
+            low = glm::min(low, glm::vec3(cube) - glm::vec3(cube.w));
+            high = glm::max(high, glm::vec3(cube) + glm::vec3(cube.w));
+        }
+        node.minX[lane] = low.x;
+        node.minY[lane] = low.y;
+        node.minZ[lane] = low.z;
+        node.maxX[lane] = high.x;
+        node.maxY[lane] = high.y;
+        node.maxZ[lane] = high.z;
+        if (last - first <= static_cast<uint32_t>(leafSize))
+        {
+            node.child[lane] = first;
+            node.count[lane] = last - first;
+        }
+        else
+        {
+            node.child[lane] = buildNode(first, last, depth + 1);
+            node.count[lane] = 0;
+        }
+    }
+    nodes[index] = node;
+    return index;
+}
+
+uint32_t InstancePicker::splitRange(uint32_t begin, uint32_t end)
+{
+    glm::vec3 low(FLT_MAX);
+    glm::vec3 high(-FLT_MAX);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const glm::vec3 center(instanceCubes[cubeIndex[i]]);
+        low = glm::min(low, center);
+        high = glm::max(high, center);
+    }
+
+    glm::vec3 extent = high - low;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+    uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(cubeIndex.begin() + begin, cubeIndex.begin() + middle, cubeIndex.begin() + end,
+                     [this, axis](uint32_t a, uint32_t b)
+                     {
+                         return instanceCubes[a][axis] < instanceCubes[b][axis];
+                     });
+    return middle;
+}
+
+int InstancePicker::pick(const glm::vec3 &origin, const glm::vec3 &direction, float *distance)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Ray ray;
+    ray.origin = origin;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float component = std::fabs(direction[axis]) > 1e-20f ? direction[axis] : 1e-20f;
+        ray.inverseDir[axis] = 1.0f / component;
+    }
+
+    /**
+     * @struct Entry
+     * @brief 遍历栈中的节点和射线进入它的参数
+     */
+    struct Entry
+    {
+        uint32_t node; // 节点索引
+        float entry;   // 进入参数，比当前最近命中更远时出栈后直接跳过
+    };
+
+    float best = FLT_MAX;
+    int hit = -1;
+    int visited = 0;
+    int cubeTests = 0;
+    Entry stack[traversalStackSize];
+    int top = 0;
+    if (!nodes.empty())
+    {
+        stack[top++] = {0, 0.0f};
+    }
+    while (top > 0)
+    {
+        const Entry current = stack[--top];
+        if (current.entry > best)
+        {
+            continue;
+        }
+        const Node &node = nodes[current.node];
+        ++visited;
+
+        alignas(16) float entries[4];
+        int mask = intersectNode(node, ray, best, entries);
+
+        // 叶子立即做精确测试，缩小最近命中距离后再决定压栈哪些内部节点
+        int inner[4];
+        int innerCount = 0;
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            if ((mask & (1 << lane)) == 0)
+            {
+                continue;
+            }
+            if (node.count[lane] == 0)
+            {
+                inner[innerCount++] = lane;
+                continue;
+            }
+            const uint32_t first = node.child[lane];
+            for (uint32_t i = first; i < first + node.count[lane]; ++i)
+            {
+                float t = 0.0f;
+                ++cubeTests;
+                if (intersectCube(cubes[i], ray, &t) && t < best)
+                {
+                    best = t;
+                    hit = static_cast<int>(cubeIndex[i]);
+                }
+            }
+        }
+
+        // 远的先压栈，近的先出栈，尽早得到最近命中以剪掉更远的子树
+        std::sort(inner, inner + innerCount, [&entries](int a, int b)
+                  {
+                      return entries[a] > entries[b];
+                  });
+        for (int i = 0; i < innerCount; ++i)
+        {
+            const int lane = inner[i];
+            if (entries[lane] <= best && top < traversalStackSize)
+            {
+                stack[top++] = {node.child[lane], entries[lane]};
+            }
+        }
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    stats.lastInstance = hit;
+    stats.lastMs = elapsed.count();
+    stats.lastNodes = visited;
+    stats.lastCubeTests = cubeTests;
+    ++stats.picks;
+    totalPickMs += elapsed.count();
+    stats.maxMs = std::max(stats.maxMs, elapsed.count());
+    if (distance != nullptr)
+    {
+        *distance = best;
+    }
+    return hit;
+}
+
+int InstancePicker::pickScreen(double cursorX, double cursorY, int windowWidth, int windowHeight,
+                               const glm::mat4 &view, const glm::mat4 &projection, const glm::mat4 &rotation)
+{
+    const std::vector<Scene::Instance> &instances = Scene::getInstance().getInstances();
+    if (static_cast<int>(instances.size()) != stats.instances)
+    {
+        build(instances);
+    }
+
+    glm::vec3 origin;
+    glm::vec3 direction;
+    unproject(cursorX, cursorY, windowWidth, windowHeight, view, projection, &origin, &direction);
+
+    // 变换到旋转之前的局部坐标系，旋转不改变长度，命中参数与世界空间一致
+    glm::mat4 inverseRotation = glm::inverse(rotation);
+    glm::vec3 localOrigin = glm::vec3(inverseRotation * glm::vec4(origin, 1.0f));
+    glm::vec3 localDirection = glm::vec3(inverseRotation * glm::vec4(direction, 0.0f));
+    return pick(localOrigin, localDirection);
+}
+
+void InstancePicker::unproject(double cursorX, double cursorY, int windowWidth, int windowHeight,
+                               const glm::mat4 &view, const glm::mat4 &projection, glm::vec3 *origin,
+                               glm::vec3 *direction)
+{
+    // 窗口坐标的Y轴向下，NDC的Y轴向上
+    float x = static_cast<float>(2.0 * cursorX / std::max(windowWidth, 1) - 1.0);
+    float y = static_cast<float>(1.0 - 2.0 * cursorY / std::max(windowHeight, 1));
+    glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+    glm::vec3 nearPosition = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 farPosition = glm::vec3(farPoint) / farPoint.w;
+    *origin = nearPosition;
+    *direction = glm::normalize(farPosition - nearPosition);
+}
+
+int InstancePicker::intersectNode(const Node &node, const Ray &ray, float maxDistance, float *entry)
+{
+#ifdef INSTANCE_PICKER_SSE
+    __m128 enter = _mm_setzero_ps();
+    __m128 exit = _mm_set1_ps(maxDistance);
+    const float *minimum[3] = {node.minX, node.minY, node.minZ};
+    const float *maximum[3] = {node.maxX, node.maxY, node.maxZ};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const __m128 origin = _mm_set1_ps(ray.origin[axis]);
+        const __m128 inverse = _mm_set1_ps(ray.inverseDir[axis]);
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(minimum[axis]), origin), inverse);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(maximum[axis]), origin), inverse);
+        enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+        exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+    }
+    _mm_store_ps(entry, enter);
+    return _mm_movemask_ps(_mm_cmple_ps(enter, exit)) & node.laneMask;
+#else
+    int mask = 0;
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        const float minimum[3] = {node.minX[lane], node.minY[lane], node.minZ[lane]};
+        const float maximum[3] = {node.maxX[lane], node.maxY[lane], node.maxZ[lane]};
+        float enter = 0.0f;
+        float exit = maxDistance;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float t0 = (minimum[axis] - ray.origin[axis]) * ray.inverseDir[axis];
+            float t1 = (maximum[axis] - ray.origin[axis]) * ray.inverseDir[axis];
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+        }
+        entry[lane] = enter;
+        mask |= enter <= exit ? 1 << lane : 0;
+    }
+    return mask & node.laneMask;
+#endif
+}
+
+bool InstancePicker::intersectCube(const glm::vec4 &cube, const Ray &ray, float *distance)
+{
+    const glm::vec3 center(cube);
+    glm::vec3 t0 = (center - glm::vec3(cube.w) - ray.origin) * ray.inverseDir;
+    glm::vec3 t1 = (center + glm::vec3(cube.w) - ray.origin) * ray.inverseDir;
+    glm::vec3 near = glm::min(t0, t1);
+    glm::vec3 far = glm::max(t0, t1);
+    float enter = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+    float exit = std::min(std::min(far.x, far.y), far.z);
+    *distance = enter;
+    return enter <= exit;
+}
+
+PickStats InstancePicker::getStats() const
+{
+    PickStats result = stats;
+    result.meanMs = stats.picks > 0 ? totalPickMs / stats.picks : 0.0;
+    return result;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file instance_picker.h
+ * @brief 实例拾取头文件
+ * @details 定义了鼠标拾取立方体实例的加速结构：光标按相机的视图和投影矩阵反投影为射线，
+ * 在实例的四叉包围盒层次（BVH）中遍历，每个节点用SIMD一次测试射线与四个子包围盒，
+ * 到达叶子后对候选立方体做精确的射线相交测试，返回最近的实例
+ */
+
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "scene.h"
+
+/**
+ * @struct PickStats
+ * @brief 拾取统计
+ */
+struct PickStats
+{
+    int instances = 0;       // BVH覆盖的实例数
+    int nodes = 0;           // BVH节点数
+    int depth = 0;           // BVH最大深度
+    double buildMs = 0.0;    // 最近一次构建耗时（毫秒）
+    int lastInstance = -1;   // 最近一次拾取到的实例，-1表示未命中
+    double lastMs = 0.0;     // 最近一次拾取耗时（毫秒，不含构建）
+    int lastNodes = 0;       // 最近一次访问的节点数
+    int lastCubeTests = 0;   // 最近一次精确测试的立方体数
+    long long picks = 0;     // 累计拾取次数
+    double meanMs = 0.0;     // 平均拾取耗时（毫秒）
+    double maxMs = 0.0;      // 最大拾取耗时（毫秒）
+};
+
+/**
+ * @class InstancePicker
+ * @brief 实例拾取，使用单例模式实现
+ * @details BVH在场景旋转之前的局部坐标系中构建，所有实例共享同一个旋转，
+ * 射线变换到局部坐标系后立方体都与坐标轴对齐，板块法测试即为精确的射线与立方体相交。
+ * 实例位置只由实例数决定，实例数变化后在下一次拾取时重新构建。
+ * 顶点着色器的动画（wave、breathing）不参与拾取，按静止的立方体计算。只在主线程上使用
+ */
+class InstancePicker
+{
+public:
+    static constexpr int leafSize = 4;           // 叶子最多包含的立方体数
+    static constexpr int traversalStackSize = 64; // 遍历栈容量，中位数划分使深度不超过log4(实例数)
+
+    /**
+     * @brief 获取InstancePicker单例实例
+     * @return InstancePicker& 单例实例的引用
+     */
+    static InstancePicker &getInstance()
+    {
+        static InstancePicker instance;
+        return instance;
+    }
+
+    /**
+     * @brief 为实例构建BVH
+     * @param instances 场景实例
+     * @details 每个节点先按子集中心分布最长的轴在中位数处一分为二，两半再各分一次，
+     * 最多得到四个子区间，不超过leafSize个实例的子区间成为叶子
+     */
+    void build(const std::vector<Scene::Instance> &instances);
+
+    /**
+     * @brief 用局部坐标系中的射线拾取
+     * @param origin 射线起点
+     * @param direction 射线方向，不要求归一化
+     * @param distance 输出命中点的射线参数，可以为空
+     * @return int 最近的命中实例，未命中时返回-1
+     */
+    int pick(const glm::vec3 &origin, const glm::vec3 &direction, float *distance = nullptr);
+
+    /**
+     * @brief 拾取光标下的实例
+     * @param cursorX 光标X坐标（窗口坐标，左上角为原点）
+     * @param cursorY 光标Y坐标
+     * @param windowWidth 窗口宽度（与光标同一坐标系）
+     * @param windowHeight 窗口高度
+     * @param view 视图矩阵
+     * @param projection 投影矩阵
+     * @param rotation 场景整体的旋转矩阵
+     * @return int 最近的命中实例，未命中时返回-1
+     * @details 实例数与已构建的BVH不一致时先重新构建
+     */
+    int pickScreen(double cursorX, double cursorY, int windowWidth, int windowHeight,
+                   const glm::mat4 &view, const glm::mat4 &projection, const glm::mat4 &rotation);
+
+    /**
+     * @brief 把光标反投影为世界空间射线
+     * @param cursorX 光标X坐标
+     * @param cursorY 光标Y坐标
+     * @param windowWidth 窗口宽度
+     * @param windowHeight 窗口高度
+     * @param view 视图矩阵
+     * @param projection 投影矩阵
+     * @param origin 输出近平面上的射线起点
+     * @param direction 输出指向远平面的单位方向
+     */
+    static void unproject(double cursorX, double cursorY, int windowWidth, int windowHeight,
+                          const glm::mat4 &view, const glm::mat4 &projection, glm::vec3 *origin, glm::vec3 *direction);
+
+    /**
+     * @brief 获取统计
+     * @return PickStats 构建和拾取统计
+     */
+    PickStats getStats() const;
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    InstancePicker() = default;
+    ~InstancePicker() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    InstancePicker(const InstancePicker &) = delete;
+    InstancePicker &operator=(const InstancePicker &) = delete;
+
+    /**
+     * @struct Node
+     * @brief 四叉BVH节点
+     * @details 四个子包围盒按分量分别存放，可以直接装入SIMD寄存器
+     */
+    struct alignas(16) Node
+    {
+        float minX[4], minY[4], minZ[4]; // 子包围盒最小角
+        float maxX[4], maxY[4], maxZ[4]; // 子包围盒最大角
+        uint32_t child[4];               // 内部子节点的索引，叶子为第一个立方体在cubes中的位置
+        uint32_t count[4];               // 叶子的立方体数，内部子节点为0
+        int laneMask;                    // 有效子节点的位掩码
+    };
+
+    /**
+     * @struct Ray
+     * @brief 遍历使用的射线
+     */
+    struct Ray
+    {
+        glm::vec3 origin;     // 起点
+        glm::vec3 inverseDir; // 方向各分量的倒数，分量为0时用极小值代替，避免0乘无穷
+    };
+
+    /**
+     * @brief 构建一个节点及其子树
+     * @param begin 区间起点
+     * @param end 区间终点，区间不为空
+     * @param depth 节点深度
+     * @return uint32_t 节点索引
+     */
+    uint32_t buildNode(uint32_t begin, uint32_t end, int depth);
+
+    /**
+     * @brief 在中心分布最长的轴上按中位数划分区间
+     * @return uint32_t 划分点
+     */
+    uint32_t splitRange(uint32_t begin, uint32_t end);
+
+    /**
+     * @brief 用SIMD同时测试射线与节点的四个子包围盒
+     * @param node 节点
+     * @param ray 射线
+     * @param maxDistance 当前最近命中的射线参数，更远的子节点视为未命中
+     * @param entry 输出各子包围盒的进入参数
+     * @return int 命中的子节点位掩码
+     */
+    static int intersectNode(const Node &node, const Ray &ray, float maxDistance, float *entry);
+
+    /**
+     * @brief 精确测试射线与一个立方体
+     * @param cube xyz为中心，w为半边长
+     * @param ray 射线
+     * @param distance 输出进入参数，起点在立方体内时为0
+     * @return bool 是否相交
+     */
+    static bool intersectCube(const glm::vec4 &cube, const Ray &ray, float *distance);
+
+    std::vector<Node> nodes;         // BVH节点，0为根
+    std::vector<glm::vec4> cubes;    // 按叶子顺序排列的立方体，xyz为中心，w为半边长
+    std::vector<uint32_t> cubeIndex; // cubes中每个立方体对应的实例索引
+    std::vector<glm::vec4> instanceCubes; // 构建时按实例索引排列的立方体
+    PickStats stats;                 // 统计
+    double totalPickMs = 0.0;        // 累计拾取耗时
+};
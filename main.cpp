@@ -9,12 +9,35 @@
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <string>
 #include "shader.h"
 #include "camera.h"
 #include "cube.h"
+#include "geometry_arena.h"
+#include "scene.h"
 #include "ui.h"
+#include "render_graph.h"
+#include "gpu_timer.h"
+#include "dynamic_resolution.h"
+#include "benchmark.h"
+#include "batch_mode.h"
+#include "memory_tracker.h"
+#include "frame_arena.h"
+#include "gl_trace.h"
+#include "input_recorder.h"
+#include "frame_snapshot.h"
+#include "render_thread.h"
+#include "voxel_world.h"
+#include "particle_system.h"
+#include "bloom.h"
+#include "texture_manager.h"
+#include "render_server.h"
+#include "instance_picker.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -39,25 +62,42 @@ public:
 
     /**
      * @brief 初始化应用程序
+     * @param options 运行参数，批处理和服务模式下使用其中的窗口尺寸并隐藏窗口
      * @return bool 初始化是否成功
-     * @details 初始化GLFW、OpenGL上下文、各个模块等
+     * @details 初始化GLFW、OpenGL上下文、各个模块等，各阶段耗时记入运行统计
      */
-    bool init()
+    bool init(const BatchOptions &options)
     {
+        BatchMode &stats = BatchMode::getInstance();
+        auto phaseStart = std::chrono::steady_clock::now();
+        auto endPhase = [&stats, &phaseStart](const char *name)
+        {
+            auto now = std::chrono::steady_clock::now();
+            std::chrono::duration<double, std::milli> elapsed = now - phaseStart;
+            stats.addPhase(name, elapsed.count());
+            phaseStart = now;
+        };
+
         // 初始化GLFW
         if (!glfwInit())
         {
             std::cerr << "Failed to initialize GLFW" << std::endl;
             return false;
         }
+        endPhase("glfw_init");
 
         // 配置GLFW
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        const bool headless = options.enabled || !options.serverSocketPath.empty();
+        if (headless)
+        {
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        }
 
         // 创建窗口
-        window = glfwCreateWindow(1024, 768, "Shader Demo", nullptr, nullptr);
+        window = glfwCreateWindow(options.width, options.height, "Shader Demo", nullptr, nullptr);
         if (!window)
         {
             std::cerr << "Failed to create GLFW window" << std::endl;
@@ -67,89 +107,715 @@ public:
 
         glfwMakeContextCurrent(window);
 
+        // 批处理和服务模式关闭垂直同步，使帧时间反映实际开销
+        if (headless)
+        {
+            glfwSwapInterval(0);
+        }
+        endPhase("window_context");
+
         // 初始化GLEW
         if (glewInit() != GLEW_OK)
         {
             std::cerr << "Failed to initialize GLEW" << std::endl;
             return false;
         }
+        // 以GL_TRACE构建时在任何GL调用之前替换函数指针
+        if (GlTrace::getInstance().install() && !options.glTracePath.empty())
+        {
+            GlTrace::getInstance().startTrace(options.glTracePath);
+        }
+        else if (!options.glTracePath.empty())
+        {
+            std::cerr << "--gl-trace requires a build with -DGL_TRACE=ON" << std::endl;
+        }
+        endPhase("glew_init");
 
         // 设置回调函数
         glfwSetFramebufferSizeCallback(window, [](GLFWwindow *w, int width, int height)
-                                       { glViewport(0, 0, width, height); });
+                                       {
+                                           // 渲染线程持有GL上下文时视口由渲染图的各通道设置
+                                           if (!RenderThread::getInstance().isRunning())
+                                           {
+                                               glViewport(0, 0, width, height);
+                                           }
+                                           Camera::getInstance().setViewportSize(width, height);
+                                           UI::getInstance().markDirty();
+                                       });
 
         glfwSetScrollCallback(window, [](GLFWwindow *w, double xoffset, double yoffset)
-                              { Camera::getInstance().handleScroll(yoffset); });
+                              {
+                                  Camera::getInstance().handleScroll(yoffset);
+                                  InputRecorder::getInstance().recordScroll(static_cast<float>(yoffset));
+                                  UI::getInstance().markDirty();
+                              });
+
+        // 键盘和文字输入只能由回调得知，需要重绘面板以显示输入框等控件的变化
+        glfwSetKeyCallback(window, [](GLFWwindow *w, int key, int scancode, int action, int mods)
+                           {
+                               UI::getInstance().markDirty();
+                           });
+
+        glfwSetCharCallback(window, [](GLFWwindow *w, unsigned int codepoint)
+                            {
+                                UI::getInstance().markDirty();
+                            });
 
         // 初始化各个模块
         Shader::getInstance().init();
+        endPhase("shaders");
         UI::getInstance().init(window);
+        endPhase("ui");
         Camera::getInstance().init();
+        GeometryArena::getInstance().init();
         Cube::getInstance().init();
+        Scene::getInstance().init();
+        DynamicResolution::getInstance().init();
+        VoxelWorld::getInstance().init();
+        ParticleSystem::getInstance().init();
+        Bloom::getInstance().init();
+        TextureManager::getInstance().init();
+        sceneTimer.init();
+        settings = RenderSettings::capture();
+
+        int width = 0;
+        int height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        Camera::getInstance().setViewportSize(width, height);
 
         // 启用深度测试
         glEnable(GL_DEPTH_TEST);
+        endPhase("modules");
 
         return true;
     }
 
     /**
      * @brief 运行应用程序主循环
-     * @details 处理渲染循环、输入事件和UI更新
+     * @param renderThread 是否把GL提交和呈现交给专用渲染线程
+     * @details 处理渲染循环、输入事件和UI更新。主线程每帧采样输入、构建UI并填写帧快照，
+     * 单线程时直接渲染快照，否则发布给渲染线程。录制输入时着色器time按日志的固定步长推进，
+     * 使回放画面与录制时一致
      */
-    void run()
+    void run(bool renderThread)
     {
+        InputRecorder &recorder = InputRecorder::getInstance();
+        RenderThread &thread = RenderThread::getInstance();
+        bool recording = recorder.getMode() == InputRecorder::Mode::Record;
+        uint32_t frame = 0;
+
+        if (renderThread)
+        {
+            thread.start(window, [this](const FrameSnapshot &snapshot, RenderStats *stats)
+                         {
+                             renderSnapshot(snapshot, stats);
+                         });
+        }
+
         while (!glfwWindowShouldClose(window))
         {
-            // 处理相机输入
-            Camera::getInstance().handleInput(window);
+            // 获取窗口帧缓冲区尺寸
+            int windowWidth = 0;
+            int windowHeight = 0;
+            glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+            if (windowWidth == 0 || windowHeight == 0)
+            {
+                // 窗口最小化时不渲染，阻塞等待事件（恢复窗口时会收到尺寸变化），不空转占用CPU
+                glfwWaitEvents();
+                continue;
+            }
 
-            // 清除缓冲区
-            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            // 渲染线程模式下等待上一帧快照被取走后再采样输入，使延迟统计从采样时刻算起
+            FrameSnapshot &snapshot = renderThread ? thread.beginSnapshot() : directSnapshot;
+
+            // 处理拾取和相机输入，录制时先记录UI状态（含拾取结果）和按键再渲染
+            auto inputTime = std::chrono::steady_clock::now();
+            recorder.beginFrame(frame);
+            handlePicking();
+            recorder.recordUiState(captureUiState());
+            Camera::getInstance().handleInput(window);
+            recorder.recordKeys(Camera::pollKeys(window));
 
-            // 使用当前着色器程序
-            Shader::getInstance().useShaderProgram(currentVertexShader, currentFragmentShader);
+            MemoryTracker::getInstance().beginFrame();
+            frameTime = recording ? frame * recorder.getTimeStep() : glfwGetTime();
+            fillSnapshot(&snapshot, frame, inputTime, windowWidth, windowHeight);
+            ++frame;
 
-            // 设置时间uniform变量
-            float timeValue = glfwGetTime();
-            GLuint currentProgram = Shader::getInstance().getCurrentProgram();
-            int timeLocation = glGetUniformLocation(currentProgram, "time");
-            if (timeLocation != -1)
+            if (renderThread)
             {
-                glUniform1f(timeLocation, timeValue);
+                thread.publishSnapshot();
+                thread.fetchStats(&renderStats);
+            }
+            else
+            {
+                renderSnapshot(snapshot, &renderStats);
+                glfwSwapBuffers(window);
+                GlTrace::getInstance().endFrame();
             }
 
-            // 设置相机uniform变量
-            Camera::getInstance().setCameraUniforms(currentProgram);
+            // 处理事件，本帧的临时数据随帧分配器重置一起失效
+            glfwPollEvents();
+            FrameArena::forThread().reset();
+        }
 
-            // 设置模型矩阵
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::rotate(model, glm::radians(Camera::getInstance().getRotationX()), glm::vec3(1.0f, 0.0f, 0.0f));
-            model = glm::rotate(model, glm::radians(Camera::getInstance().getRotationY()), glm::vec3(0.0f, 1.0f, 0.0f));
-            glUniformMatrix4fv(glGetUniformLocation(currentProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
+        if (renderThread)
+        {
+            thread.stop();
+        }
+    }
 
-            // 渲染立方体
-            Cube::getInstance().render();
+    /**
+     * @brief 以批处理模式渲染固定帧数
+     * @param options 运行参数
+     * @return bool 是否成功写出运行摘要
+     * @details 不处理键盘输入，着色器time按固定步长推进，始终在主线程上渲染，
+     * 每帧记录从填写帧快照到交换缓冲区返回的墙钟时间。
+     * 回放输入日志时按帧应用日志中的按键、滚轮和UI操作
+     */
+    bool runBatch(const BatchOptions &options)
+    {
+        currentVertexShader = options.vertexShader;
+        currentFragmentShader = options.fragmentShader;
+        Camera::getInstance().setRotation(options.rotationX, options.rotationY);
+        Camera::getInstance().setCameraDistance(options.distance);
+        Scene::getInstance().setInstanceCount(options.objects);
 
-            // 渲染UI
-            UI::getInstance().render(&currentVertexShader, &currentFragmentShader);
+        BatchMode &stats = BatchMode::getInstance();
+        stats.begin(options.frames);
+        InputRecorder &recorder = InputRecorder::getInstance();
+        auto applyEvent = [this](const InputRecorder::Event &event)
+        {
+            applyRecordedEvent(event);
+        };
 
-            // 交换缓冲区和处理事件
+        for (int frame = 0; frame < options.frames && !glfwWindowShouldClose(window); ++frame)
+        {
+            int windowWidth = 0;
+            int windowHeight = 0;
+            glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+            if (windowWidth == 0 || windowHeight == 0)
+            {
+                std::cerr << "Batch mode requires a non-empty framebuffer" << std::endl;
+                return false;
+            }
+
+            if (recorder.getMode() == InputRecorder::Mode::Replay)
+            {
+                recorder.beginFrame(static_cast<uint32_t>(frame));
+                Camera::getInstance().applyKeys(recorder.replayFrameBegin(applyEvent));
+            }
+
+            MemoryTracker::getInstance().beginFrame();
+            auto start = std::chrono::steady_clock::now();
+            frameTime = frame * options.timeStep;
+            fillSnapshot(&directSnapshot, static_cast<uint64_t>(frame), start, windowWidth, windowHeight);
+            renderSnapshot(directSnapshot, &renderStats);
             glfwSwapBuffers(window);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            GlTrace::getInstance().endFrame();
+
+            int drawCalls = renderStats.sceneDrawCalls + renderStats.uiDrawCalls;
+            stats.addFrame(elapsed.count(), sceneTimer.getLastMs(), drawCalls);
+
             glfwPollEvents();
+            recorder.replayFrameEnd(applyEvent);
+            FrameArena::forThread().reset();
+        }
+
+        // 用均匀分布的光标位置测量拾取延迟，结果随运行摘要写出
+        if (!settings.voxelWorld)
+        {
+            const Camera &camera = Camera::getInstance();
+            int width = 0;
+            int height = 0;
+            glfwGetWindowSize(window, &width, &height);
+            for (int y = 0; y < pickSweepSide; ++y)
+            {
+                for (int x = 0; x < pickSweepSide; ++x)
+                {
+                    InstancePicker::getInstance().pickScreen((x + 0.5) * width / pickSweepSide,
+                                                             (y + 0.5) * height / pickSweepSide, width, height,
+                                                             camera.getViewMatrix(), camera.getProjectionMatrix(),
+                                                             camera.getRotationMatrix());
+                }
+            }
+        }
+
+        return stats.writeSummary(options);
+    }
+
+    /**
+     * @brief 运行着色器基准测试
+     * @param outputPath 结果文件路径
+     * @return bool 是否成功完成并写出结果
+     */
+    bool runBenchmark(const std::string &outputPath)
+    {
+        return Benchmark::getInstance().run(window, outputPath);
+    }
+
+    /**
+     * @brief 运行命令列表录制基准测试
+     * @param outputPath 结果文件路径
+     * @return bool 是否成功完成并写出结果
+     */
+    bool runCommandBenchmark(const std::string &outputPath)
+    {
+        return Benchmark::getInstance().runRecording(window, outputPath);
+    }
+
+    /**
+     * @brief 以本地渲染服务模式运行
+     * @param options 运行参数，使用其中的套接字路径和立方体数量
+     * @return bool 是否成功监听并正常退出
+     */
+    bool runServer(const BatchOptions &options)
+    {
+        Scene::getInstance().setInstanceCount(options.objects);
+        return RenderServer::getInstance().run(window, options.serverSocketPath);
+    }
+
+private:
+    /**
+     * @brief 采集由UI控制的渲染状态
+     * @return InputRecorder::UiState 当前状态
+     */
+    InputRecorder::UiState captureUiState() const
+    {
+        InputRecorder::UiState state;
+        state.vertexShader = static_cast<uint8_t>(currentVertexShader);
+        state.fragmentShader = static_cast<uint8_t>(currentFragmentShader);
+        state.instanceCount = static_cast<uint32_t>(Scene::getInstance().getInstanceCount());
+        state.flags = (settings.sortFrontToBack ? InputRecorder::FlagSortFrontToBack : 0u) |
+                      (settings.depthPrepass ? InputRecorder::FlagDepthPrepass : 0u) |
+                      (settings.showOverdraw ? InputRecorder::FlagShowOverdraw : 0u) |
+                      (settings.dynamicResolution ? InputRecorder::FlagDynamicResolution : 0u) |
+                      (settings.voxelWorld ? InputRecorder::FlagVoxelWorld : 0u) |
+                      (settings.particles ? InputRecorder::FlagParticles : 0u) |
+                      (settings.aliasTransients ? InputRecorder::FlagAliasTransients : 0u) |
+                      (settings.mixedPrograms ? InputRecorder::FlagMixedPrograms : 0u) |
+                      (settings.renderQueue ? InputRecorder::FlagRenderQueue : 0u) |
+                      (settings.textureCompression ? InputRecorder::FlagTextureCompression : 0u) |
+                      (settings.particleCpuUpdate ? InputRecorder::FlagParticleCpuUpdate : 0u) |
+                      (settings.bloom ? InputRecorder::FlagBloom : 0u);
+        if (settings.occlusionMode == Scene::OcclusionMode::Conditional)
+        {
+            state.flags |= InputRecorder::FlagOcclusionConditional;
+        }
+        else if (settings.occlusionMode == Scene::OcclusionMode::Temporal)
+        {
+            state.flags |= InputRecorder::FlagOcclusionTemporal;
+        }
+        state.msaaSamples = static_cast<uint8_t>(settings.msaaSamples);
+        state.budgetMs = settings.budgetMs;
+        state.minScale = settings.minScale;
+        state.maxScale = settings.maxScale;
+        state.fixedScale = settings.fixedScale;
+        state.commandThreads = static_cast<uint16_t>(settings.commandThreads);
+        state.textureBudgetKB = static_cast<uint32_t>(settings.textureBudgetKB);
+        state.particleCount = static_cast<uint32_t>(settings.particleCount);
+        state.voxelMeshMode = static_cast<uint8_t>(settings.voxelMeshMode);
+        state.highlightInstance = settings.highlightInstance;
+        return state;
+    }
+
+    /**
+     * @brief 应用回放的事件
+     * @param event 输入日志中的事件
+     */
+    void applyRecordedEvent(const InputRecorder::Event &event)
+    {
+        switch (event.type)
+        {
+        case InputRecorder::EventType::Scroll:
+            Camera::getInstance().handleScroll(event.scroll);
+            break;
+        case InputRecorder::EventType::CameraReset:
+            Camera::getInstance().init();
+            break;
+        case InputRecorder::EventType::UiState:
+        {
+            Scene &scene = Scene::getInstance();
+            currentVertexShader = event.state.vertexShader;
+            currentFragmentShader = event.state.fragmentShader;
+            if (scene.getInstanceCount() != static_cast<int>(event.state.instanceCount))
+            {
+                scene.setInstanceCount(static_cast<int>(event.state.instanceCount));
+            }
+            settings.sortFrontToBack = (event.state.flags & InputRecorder::FlagSortFrontToBack) != 0;
+            settings.depthPrepass = (event.state.flags & InputRecorder::FlagDepthPrepass) != 0;
+            settings.showOverdraw = (event.state.flags & InputRecorder::FlagShowOverdraw) != 0;
+            settings.dynamicResolution = (event.state.flags & InputRecorder::FlagDynamicResolution) != 0;
+            settings.voxelWorld = (event.state.flags & InputRecorder::FlagVoxelWorld) != 0;
+            settings.particles = (event.state.flags & InputRecorder::FlagParticles) != 0;
+            settings.aliasTransients = (event.state.flags & InputRecorder::FlagAliasTransients) != 0;
+            settings.mixedPrograms = (event.state.flags & InputRecorder::FlagMixedPrograms) != 0;
+            settings.renderQueue = (event.state.flags & InputRecorder::FlagRenderQueue) != 0;
+            settings.textureCompression = (event.state.flags & InputRecorder::FlagTextureCompression) != 0;
+            settings.particleCpuUpdate = (event.state.flags & InputRecorder::FlagParticleCpuUpdate) != 0;
+            settings.bloom = (event.state.flags & InputRecorder::FlagBloom) != 0;
+            settings.msaaSamples = event.state.msaaSamples;
+            settings.budgetMs = event.state.budgetMs;
+            settings.minScale = event.state.minScale;
+            settings.maxScale = event.state.maxScale;
+            settings.fixedScale = event.state.fixedScale;
+            settings.commandThreads = event.state.commandThreads;
+            settings.textureBudgetKB = static_cast<int>(event.state.textureBudgetKB);
+            settings.particleCount = static_cast<int>(event.state.particleCount);
+            settings.voxelMeshMode = static_cast<VoxelMeshMode>(std::min<int>(event.state.voxelMeshMode,
+                                                                              static_cast<int>(VoxelMeshMode::Greedy)));
+            settings.highlightInstance = event.state.highlightInstance;
+            settings.occlusionMode = Scene::OcclusionMode::Off;
+            if (event.state.flags & InputRecorder::FlagOcclusionConditional)
+            {
+                settings.occlusionMode = Scene::OcclusionMode::Conditional;
+            }
+            else if (event.state.flags & InputRecorder::FlagOcclusionTemporal)
+            {
+                settings.occlusionMode = Scene::OcclusionMode::Temporal;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    /**
+     * @brief 处理鼠标拾取
+     * @details 左键按下时拾取光标下的实例并写入渲染设置，本帧快照即带上新的高亮。
+     * 光标在ImGui窗口上或显示体素世界时不拾取；实例数变化后原来的索引不再指向同一个立方体，清除高亮
+     */
+    void handlePicking()
+    {
+        const Scene &scene = Scene::getInstance();
+        if (scene.getInstanceCount() != pickedInstanceCount)
+        {
+            pickedInstanceCount = scene.getInstanceCount();
+            settings.highlightInstance = -1;
+        }
+
+        bool down = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        bool pressed = down && !mouseDown;
+        mouseDown = down;
+        if (!pressed || ImGui::GetIO().WantCaptureMouse || settings.voxelWorld)
+        {
+            return;
+        }
+
+        double cursorX = 0.0;
+        double cursorY = 0.0;
+        int width = 0;
+        int height = 0;
+        glfwGetCursorPos(window, &cursorX, &cursorY);
+        glfwGetWindowSize(window, &width, &height);
+        const Camera &camera = Camera::getInstance();
+        settings.highlightInstance = InstancePicker::getInstance().pickScreen(cursorX, cursorY, width, height,
+                                                                              camera.getViewMatrix(),
+                                                                              camera.getProjectionMatrix(),
+                                                                              camera.getRotationMatrix());
+        UI::getInstance().markDirty();
+    }
+
+    /**
+     * @brief 填写本帧的帧快照
+     * @param snapshot 输出的快照，容器容量在帧之间复用
+     * @param frame 帧序号
+     * @param inputTime 采样输入的时间
+     * @param windowWidth 窗口帧缓冲区宽度
+     * @param windowHeight 窗口帧缓冲区高度
+     * @details 在主线程上调用。相机、程序选择和渲染设置取自帧开始时的状态（与输入日志一致），
+     * UI在此之后构建，面板上的操作从下一帧开始生效
+     */
+    void fillSnapshot(FrameSnapshot *snapshot, uint64_t frame, std::chrono::steady_clock::time_point inputTime,
+                      int windowWidth, int windowHeight)
+    {
+        const Camera &camera = Camera::getInstance();
+        snapshot->frameId = frame;
+        snapshot->inputTime = inputTime;
+        snapshot->framebufferWidth = windowWidth;
+        snapshot->framebufferHeight = windowHeight;
+        snapshot->vertexShader = currentVertexShader;
+        snapshot->fragmentShader = currentFragmentShader;
+        snapshot->time = frameTime;
+        snapshot->view.view = camera.getViewMatrix();
+        snapshot->view.projection = camera.getProjectionMatrix();
+        snapshot->rotation = camera.getRotationMatrix();
+        snapshot->settings = settings;
+        Scene::getInstance().computeModels(camera.getRotationMatrix(), &snapshot->models);
+
+        UI::getInstance().buildFrame(&currentVertexShader, &currentFragmentShader, &settings, renderStats,
+                                     windowWidth, windowHeight, &snapshot->ui);
+    }
+
+    /**
+     * @brief 声明、编译并执行帧快照的渲染图
+     * @param snapshot 帧快照
+     * @param stats 输出的渲染统计
+     * @details 在拥有GL上下文的线程上调用，不包括交换缓冲区
+     */
+    void renderSnapshot(const FrameSnapshot &snapshot, RenderStats *stats)
+    {
+        snapshot.settings.apply();
+        GeometryArena::getInstance().update();
+        TextureManager::getInstance().update();
+        if (snapshot.settings.voxelWorld)
+        {
+            VoxelWorld::getInstance().update();
+        }
+        if (snapshot.settings.particles)
+        {
+            ParticleSystem::getInstance().update(snapshot.time);
+        }
+
+        RenderGraph &graph = RenderGraph::getInstance();
+        graph.beginFrame();
+        buildFrameGraph(snapshot);
+        graph.compile();
+        graph.execute();
+
+        DynamicResolution::getInstance().update(sceneTimer.getLastMs());
+        stats->collect();
+    }
+
+    /**
+     * @brief 声明本帧的渲染通道
+     * @param snapshot 帧快照
+     * @details 场景按动态分辨率比例渲染到按最大比例分配的临时颜色+深度目标的左下角，
+     * 可选多重采样解析，再把该区域放大到窗口帧缓冲区，最后叠加UI
+     */
+    void buildFrameGraph(const FrameSnapshot &snapshot)
+    {
+        RenderGraph &graph = RenderGraph::getInstance();
+        const int windowWidth = snapshot.framebufferWidth;
+        const int windowHeight = snapshot.framebufferHeight;
+        DynamicResolution &resolution = DynamicResolution::getInstance();
+
+        // 目标按最大比例分配，场景只渲染到左下角的视口，比例变化时不重新分配目标
+        int sceneWidth = 0;
+        int sceneHeight = 0;
+        int targetWidth = 0;
+        int targetHeight = 0;
+        resolution.getRenderSize(windowWidth, windowHeight, &sceneWidth, &sceneHeight);
+        resolution.getTargetSize(windowWidth, windowHeight, &targetWidth, &targetHeight);
+        int samples = clampSamples(resolution.msaaSamples);
+
+        RGHandle backbuffer = graph.importFramebuffer("Backbuffer", 0, windowWidth, windowHeight);
+        RGHandle sceneColor = graph.createResource("SceneColor", {targetWidth, targetHeight, GL_RGBA8, samples});
+        RGHandle sceneDepth = graph.createResource("SceneDepth", {targetWidth, targetHeight, GL_DEPTH24_STENCIL8, samples});
+        graph.markOutput(backbuffer);
+
+        graph.addPass(
+            "Scene",
+            [&](RenderGraph::Builder &builder)
+            {
+                builder.writeColor(sceneColor);
+                builder.writeDepth(sceneDepth);
+                builder.setViewport(sceneWidth, sceneHeight);
+            },
+            [this, &snapshot, sceneWidth, sceneHeight, samples]()
+            {
+                sceneTimer.begin();
+                renderScene(snapshot, sceneWidth * sceneHeight * std::max(1, samples));
+                sceneTimer.end();
+            });
+
+        // 过度绘制模式下热力图替代场景颜色，场景通道因不再被使用而被剔除
+        if (snapshot.settings.showOverdraw)
+        {
+            RGHandle overdrawCount = graph.createResource("OverdrawCount", {targetWidth, targetHeight, GL_RGBA8, 0});
+            RGHandle overdrawDepth = graph.createResource("OverdrawDepth", {targetWidth, targetHeight, GL_DEPTH24_STENCIL8, 0});
+            RGHandle heatmap = graph.createResource("OverdrawHeatmap", {targetWidth, targetHeight, GL_RGBA8, 0});
+
+            graph.addPass(
+                "Overdraw",
+                [&](RenderGraph::Builder &builder)
+                {
+                    builder.writeColor(overdrawCount);
+                    builder.writeDepth(overdrawDepth);
+                    builder.setViewport(sceneWidth, sceneHeight);
+                },
+                [this, &snapshot, sceneWidth, sceneHeight]()
+                {
+                    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    sceneTimer.begin();
+                    if (snapshot.settings.voxelWorld)
+                    {
+                        renderVoxelOverdraw(snapshot);
+                    }
+                    else
+                    {
+                        Scene::getInstance().renderOverdraw(snapshot.view, snapshot.models, snapshot.vertexShader,
+                                                            static_cast<float>(snapshot.time), sceneWidth * sceneHeight);
+                    }
+                    sceneTimer.end();
+                });
+
+            graph.addPass(
+                "Heatmap",
+                [&](RenderGraph::Builder &builder)
+                {
+                    builder.read(overdrawCount);
+                    builder.writeColor(heatmap);
+                    builder.setViewport(sceneWidth, sceneHeight);
+                },
+                [&graph, overdrawCount]()
+                {
+                    Scene::getInstance().renderHeatmap(graph.getTexture(overdrawCount));
+                });
+
+            sceneColor = heatmap;
+            samples = 0;
+        }
+
+        // 多重采样需要先解析到同尺寸的单采样纹理
+        RGHandle presentSource = sceneColor;
+        if (samples > 0)
+        {
+            RGHandle resolved = graph.createResource("SceneResolved", {targetWidth, targetHeight, GL_RGBA8, 0});
+            graph.addPass(
+                "Resolve",
+                [&](RenderGraph::Builder &builder)
+                {
+                    builder.read(sceneColor);
+                    builder.writeColor(resolved);
+                },
+                [&graph, sceneColor, resolved, sceneWidth, sceneHeight]()
+                {
+                    glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.getFramebuffer(sceneColor));
+                    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, graph.getFramebuffer(resolved));
+                    glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, sceneWidth, sceneHeight,
+                                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                });
+            presentSource = resolved;
+        }
+
+        graph.addPass(
+            "Upscale",
+            [&](RenderGraph::Builder &builder)
+            {
+                builder.read(presentSource);
+                builder.writeColor(backbuffer);
+            },
+            [&graph, presentSource, sceneWidth, sceneHeight, windowWidth, windowHeight]()
+            {
+                bool scaled = sceneWidth != windowWidth || sceneHeight != windowHeight;
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.getFramebuffer(presentSource));
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, windowWidth, windowHeight,
+                                  GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            });
+
+        // 泛光叠加在放大后的帧缓冲区上，UI之前
+        if (snapshot.settings.bloom)
+        {
+            Bloom::getInstance().addPasses(graph, presentSource, sceneWidth, sceneHeight, backbuffer, windowWidth,
+                                           windowHeight);
         }
+
+        graph.addPass(
+            "UI",
+            [&](RenderGraph::Builder &builder)
+            {
+                builder.writeColor(backbuffer);
+            },
+            [&snapshot, windowWidth, windowHeight]()
+            {
+                UI::getInstance().drawFrame(snapshot.ui, windowWidth, windowHeight);
+            });
     }
 
+    /**
+     * @brief 渲染场景到当前绑定的帧缓冲区
+     * @param snapshot 帧快照
+     * @param sampleCount 渲染目标的样本总数，用于统计每像素着色片段数
+     */
+    void renderScene(const FrameSnapshot &snapshot, int sampleCount)
+    {
+        // 清除缓冲区
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        float timeValue = static_cast<float>(snapshot.time);
+
+        // 体素和粒子没有逐实例材质，纹理着色器统一使用第一个材质
+        TextureManager::getInstance().bind(0);
+        if (snapshot.settings.voxelWorld)
+        {
+            Shader &shader = Shader::getInstance();
+            shader.useShaderProgram(snapshot.vertexShader, snapshot.fragmentShader);
+            VoxelWorld::getInstance().render(snapshot.view, snapshot.rotation, shader.getCurrentProgram(), timeValue);
+        }
+        else
+        {
+            // 渲染场景中的所有立方体
+            Scene::getInstance().render(snapshot.view, snapshot.models, snapshot.vertexShader,
+                                        snapshot.fragmentShader, timeValue, sampleCount);
+        }
+
+        // 粒子位置直接来自变换反馈缓冲区，一次实例化绘制
+        if (snapshot.settings.particles)
+        {
+            ParticleSystem::getInstance().render(snapshot.view, snapshot.rotation, snapshot.fragmentShader, timeValue);
+        }
+    }
+
+    /**
+     * @brief 以加法混合绘制体素世界，累计每像素通过深度测试的片段数
+     * @param snapshot 帧快照
+     */
+    void renderVoxelOverdraw(const FrameSnapshot &snapshot)
+    {
+        GLuint overdrawProgram = Shader::getInstance().getOverdrawProgram(snapshot.vertexShader);
+        if (overdrawProgram == 0)
+        {
+            return;
+        }
+
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFunc(GL_ONE, GL_ONE);
+        VoxelWorld::getInstance().render(snapshot.view, snapshot.rotation, overdrawProgram,
+                                         static_cast<float>(snapshot.time));
+        glDisable(GL_BLEND);
+    }
+
+    /**
+     * @brief 将请求的多重采样数限制在设备支持范围内
+     * @param samples 请求的采样数
+     * @return int 可用的采样数，0表示不使用多重采样
+     */
+    int clampSamples(int samples) const
+    {
+        if (samples < 2)
+        {
+            return 0;
+        }
+        GLint maxSamples = 0;
+        glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+        return samples > maxSamples ? (maxSamples < 2 ? 0 : maxSamples) : samples;
+    }
+
+public:
     /**
      * @brief 清理应用程序资源
      * @details 清理各个模块的资源并终止GLFW
      */
     void cleanup()
     {
+        RenderGraph::getInstance().cleanup();
+        sceneTimer.cleanup();
+        Scene::getInstance().cleanup();
+        VoxelWorld::getInstance().cleanup();
+        ParticleSystem::getInstance().cleanup();
+        Bloom::getInstance().cleanup();
+        TextureManager::getInstance().cleanup();
         UI::getInstance().cleanup();
         Shader::getInstance().cleanup();
         Cube::getInstance().cleanup();
+        GeometryArena::getInstance().cleanup();
         glfwTerminate();
     }
 
@@ -165,23 +831,263 @@ private:
     GLFWwindow *window = nullptr;
     int currentVertexShader = 0;
     int currentFragmentShader = 0;
+
+    double frameTime = 0.0; // 本帧传给着色器的time值
+    bool mouseDown = false;       // 上一帧左键是否按下，用于检测按下的瞬间
+    int pickedInstanceCount = 0;  // 高亮所对应的实例数
+
+    static constexpr int pickSweepSide = 16; // 批处理结束时拾取延迟测量的光标网格边长
+
+    RenderSettings settings;      // 由UI和输入日志控制的渲染设置，渲染时随快照写入各模块
+    RenderStats renderStats;      // 最近一次收到的渲染统计
+    FrameSnapshot directSnapshot; // 不使用渲染线程时的帧快照
+
+    GpuTimer sceneTimer; // 场景GPU计时器
 };
 
+/**
+ * @brief 打印命令行用法
+ */
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --benchmark [file]       run the shader cost sweep and write CSV/JSON\n"
+              << "  --command-benchmark [file] measure command list record time against thread count\n"
+              << "  --batch                  render a fixed number of frames and exit\n"
+              << "  --vertex <name|index>    vertex shader (normal, wave, breathing)\n"
+              << "  --fragment <name|index>  fragment shader (normal, pulse, rainbow)\n"
+              << "  --rotation <x> <y>       object rotation in degrees\n"
+              << "  --distance <d>           camera distance\n"
+              << "  --resolution <w>x<h>     window size\n"
+              << "  --frames <n>             number of frames to render\n"
+              << "  --objects <n>            number of cubes\n"
+              << "  --time-step <s>          shader time advanced per frame (batch, or stored in a --record log)\n"
+              << "  --output <file>          JSON run summary path\n"
+              << "  --record <file>          record input and UI actions of an interactive session\n"
+              << "  --render-thread          submit and present on a dedicated render thread (interactive)\n"
+              << "  --check-allocations      count (and assert in debug builds) heap allocations after warm-up\n"
+              << "  --gl-trace <file>        dump every intercepted GL call of a few frames (GL_TRACE builds)\n"
+              << "  --serve <socket>         render images for requests on a Unix domain socket\n"
+              << "  --replay <file>          replay a recorded input log in batch mode" << std::endl;
+}
+
+/**
+ * @brief 解析命令行参数
+ * @param argc 参数个数
+ * @param argv 参数列表
+ * @param options 批处理参数，除--benchmark、--command-benchmark、--record、--time-step、--render-thread、--check-allocations、--gl-trace和--serve外的任何选项都会启用批处理模式；
+ * --record只能用于交互运行，与批处理选项同时出现时报错
+ * @param benchmarkOutput 基准测试输出路径，未指定--benchmark时保持为空
+ * @return bool 参数是否有效
+ */
+static bool parseArguments(int argc, char **argv, BatchOptions *options, std::string *benchmarkOutput)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--benchmark")
+        {
+            *benchmarkOutput = (hasValue && argv[i + 1][0] != '-') ? argv[++i] : "benchmark.csv";
+            continue;
+        }
+        if (arg == "--command-benchmark")
+        {
+            options->commandBenchmarkPath = (hasValue && argv[i + 1][0] != '-') ? argv[++i] : "command_benchmark.csv";
+            continue;
+        }
+        if (arg == "--help" || arg == "-h")
+        {
+            return false;
+        }
+        if (arg == "--record" && hasValue)
+        {
+            options->recordPath = argv[++i];
+            continue;
+        }
+        if (arg == "--time-step" && hasValue)
+        {
+            // 交互录制时写入日志作为回放的时间步长，单独出现时不启用批处理模式
+            options->timeStep = std::strtod(argv[++i], nullptr);
+            continue;
+        }
+        if (arg == "--render-thread")
+        {
+            options->renderThread = true;
+            continue;
+        }
+        if (arg == "--check-allocations")
+        {
+            options->checkAllocations = true;
+            continue;
+        }
+        if (arg == "--gl-trace" && hasValue)
+        {
+            options->glTracePath = argv[++i];
+            continue;
+        }
+        if (arg == "--serve" && hasValue)
+        {
+            options->serverSocketPath = argv[++i];
+            continue;
+        }
+
+        options->enabled = true;
+        if (arg == "--batch")
+        {
+            continue;
+        }
+        if (!hasValue)
+        {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+
+        if (arg == "--vertex" || arg == "--fragment")
+        {
+            bool vertex = arg == "--vertex";
+            int index = vertex ? Shader::findVertexShaderIndex(argv[++i]) : Shader::findFragmentShaderIndex(argv[++i]);
+            if (index < 0)
+            {
+                std::cerr << "Unknown shader for " << arg << ": " << argv[i] << std::endl;
+                return false;
+            }
+            (vertex ? options->vertexShader : options->fragmentShader) = index;
+        }
+        else if (arg == "--rotation" && i + 2 < argc)
+        {
+            options->rotationX = std::strtof(argv[++i], nullptr);
+            options->rotationY = std::strtof(argv[++i], nullptr);
+        }
+        else if (arg == "--distance")
+        {
+            options->distance = std::strtof(argv[++i], nullptr);
+        }
+        else if (arg == "--resolution")
+        {
+            std::string value = argv[++i];
+            size_t separator = value.find('x');
+            options->width = separator == std::string::npos ? 0 : std::atoi(value.substr(0, separator).c_str());
+            options->height = separator == std::string::npos ? 0 : std::atoi(value.substr(separator + 1).c_str());
+            if (options->width <= 0 || options->height <= 0)
+            {
+                std::cerr << "Invalid resolution: " << value << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--frames")
+        {
+            options->frames = std::max(1, std::atoi(argv[++i]));
+            options->framesSet = true;
+        }
+        else if (arg == "--objects")
+        {
+            options->objects = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--output")
+        {
+            options->outputPath = argv[++i];
+        }
+        else if (arg == "--replay")
+        {
+            options->replayPath = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    // 批处理只回放日志，不会录制
+    if (options->enabled && !options->recordPath.empty())
+    {
+        std::cerr << "--record records an interactive session and cannot be combined with batch options" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 /**
  * @brief 程序入口点
+ * @param argc 参数个数
+ * @param argv 参数列表，见printUsage
  * @return int 程序退出码
  */
-int main()
+int main(int argc, char **argv)
 {
+    BatchOptions options;
+    std::string benchmarkOutput;
+    if (!parseArguments(argc, argv, &options, &benchmarkOutput))
+    {
+        printUsage(argv[0]);
+        return -1;
+    }
+
     auto &app = Application::getInstance();
 
-    if (!app.init())
+    if (!app.init(options))
     {
         return -1;
     }
 
-    app.run();
+    // 预热期间着色器、缓冲区和容器容量逐渐稳定，之后的帧不应再访问通用堆
+    if (options.checkAllocations)
+    {
+        MemoryTracker::getInstance().enableSteadyStateCheck(MemoryTracker::defaultWarmupFrames);
+    }
+
+    // 回放时帧数和时间步长默认取自日志
+    InputRecorder &recorder = InputRecorder::getInstance();
+    if (!options.replayPath.empty())
+    {
+        if (!recorder.startReplay(options.replayPath))
+        {
+            app.cleanup();
+            return -1;
+        }
+        options.timeStep = recorder.getTimeStep();
+        if (!options.framesSet)
+        {
+            options.frames = static_cast<int>(recorder.getFrameCount());
+        }
+    }
+    else if (!options.recordPath.empty())
+    {
+        recorder.startRecording(options.recordPath, options.timeStep);
+    }
+
+    int exitCode = 0;
+    if (!benchmarkOutput.empty())
+    {
+        exitCode = app.runBenchmark(benchmarkOutput) ? 0 : -1;
+    }
+    else if (!options.commandBenchmarkPath.empty())
+    {
+        exitCode = app.runCommandBenchmark(options.commandBenchmarkPath) ? 0 : -1;
+    }
+    else if (!options.serverSocketPath.empty())
+    {
+        exitCode = app.runServer(options) ? 0 : -1;
+    }
+    else if (options.enabled)
+    {
+        exitCode = app.runBatch(options) ? 0 : -1;
+    }
+    else
+    {
+        app.run(options.renderThread);
+    }
+
+    if (!recorder.stop())
+    {
+        exitCode = -1;
+    }
+
+    // 释放资源前输出内存统计，当前值反映退出时仍驻留的资源
+    MemoryTracker::getInstance().printSummary(std::cout);
     app.cleanup();
 
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,255 @@
+#include "memory_tracker.h"
+#include "frame_arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+namespace
+{
+    // 堆统计使用常量初始化的原子变量，在任何静态构造之前即可使用
+    std::atomic<long long> heapBytes{0};
+    std::atomic<long long> heapPeakBytes{0};
+    std::atomic<long long> heapAllocations{0};
+    std::atomic<long long> heapLiveAllocations{0};
+    std::atomic<long long> heapFrameAllocations{0};
+    std::atomic<long long> heapLastFrameAllocations{0};
+    std::atomic<long long> heapPeakFrameAllocations{0};
+
+    // 头部大小取最大基本对齐，保证返回的指针满足operator new的对齐要求
+    constexpr std::size_t headerSize = alignof(std::max_align_t);
+
+    void updatePeak(std::atomic<long long> &peak, long long value)
+    {
+        long long previous = peak.load(std::memory_order_relaxed);
+        while (value > previous && !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void *trackedAllocate(std::size_t size)
+    {
+        void *base = std::malloc(size + headerSize);
+        if (base == nullptr)
+        {
+            return nullptr;
+        }
+        *static_cast<std::size_t *>(base) = size;
+
+        long long bytes = heapBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed) + size;
+        updatePeak(heapPeakBytes, bytes);
+        heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        heapLiveAllocations.fetch_add(1, std::memory_order_relaxed);
+        heapFrameAllocations.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<char *>(base) + headerSize;
+    }
+
+    void trackedFree(void *pointer)
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+        void *base = static_cast<char *>(pointer) - headerSize;
+        std::size_t size = *static_cast<std::size_t *>(base);
+        heapBytes.fetch_sub(static_cast<long long>(size), std::memory_order_relaxed);
+        heapLiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+        std::free(base);
+    }
+
+    void *allocateOrThrow(std::size_t size)
+    {
+        void *pointer = trackedAllocate(size);
+        while (pointer == nullptr)
+        {
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            handler();
+            pointer = trackedAllocate(size);
+        }
+        return pointer;
+    }
+}
+
+// 替换全局operator new/delete；对齐版本（align_val_t）保持标准库实现，不计入统计
+void *operator new(std::size_t size) { return allocateOrThrow(size); }
+void *operator new[](std::size_t size) { return allocateOrThrow(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return trackedAllocate(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return trackedAllocate(size); }
+void operator delete(void *pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { trackedFree(pointer); }
+
+void MemoryTracker::trackGpu(GpuResourceKind kind, GLuint id, long long bytes, const char *owner)
+{
+    if (id == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(gpuMutex);
+    Key key(static_cast<int>(kind), id);
+    auto it = gpuAllocations.find(key);
+    if (it != gpuAllocations.end())
+    {
+        gpuBytes -= it->second.bytes;
+        it->second = {bytes, owner};
+    }
+    else
+    {
+        gpuAllocations.emplace(key, Allocation{bytes, owner});
+    }
+
+    gpuBytes += bytes;
+    gpuPeakBytes = std::max(gpuPeakBytes, gpuBytes);
+}
+
+void MemoryTracker::untrackGpu(GpuResourceKind kind, GLuint id)
+{
+    std::lock_guard<std::mutex> lock(gpuMutex);
+    auto it = gpuAllocations.find(Key(static_cast<int>(kind), id));
+    if (it != gpuAllocations.end())
+    {
+        gpuBytes -= it->second.bytes;
+        gpuAllocations.erase(it);
+    }
+}
+
+void MemoryTracker::beginFrame()
+{
+    long long frameAllocations = heapFrameAllocations.exchange(0, std::memory_order_relaxed);
+    heapLastFrameAllocations.store(frameAllocations, std::memory_order_relaxed);
+    updatePeak(heapPeakFrameAllocations, frameAllocations);
+
+    if (steadyStateCheck && ++checkedFrames > checkWarmupFrames && frameAllocations > 0)
+    {
+        if (steadyStateViolations++ == 0)
+        {
+            std::cerr << "Heap allocations in a steady-state frame: " << frameAllocations << std::endl;
+        }
+        assert(frameAllocations == 0 && "steady-state frames must not allocate from the general heap");
+    }
+}
+
+void MemoryTracker::enableSteadyStateCheck(int warmupFrames)
+{
+    steadyStateCheck = true;
+    checkWarmupFrames = warmupFrames;
+    checkedFrames = 0;
+    steadyStateViolations = 0;
+}
+
+MemoryStats MemoryTracker::getStats() const
+{
+    MemoryStats stats;
+    getStats(&stats);
+    return stats;
+}
+
+void MemoryTracker::getStats(MemoryStats *stats) const
+{
+    stats->cpuBytes = heapBytes.load(std::memory_order_relaxed);
+    stats->cpuPeakBytes = heapPeakBytes.load(std::memory_order_relaxed);
+    stats->cpuAllocations = heapAllocations.load(std::memory_order_relaxed);
+    stats->cpuLiveAllocations = heapLiveAllocations.load(std::memory_order_relaxed);
+    stats->frameAllocations = heapLastFrameAllocations.load(std::memory_order_relaxed);
+    stats->peakFrameAllocations = heapPeakFrameAllocations.load(std::memory_order_relaxed);
+    stats->steadyStateCheck = steadyStateCheck;
+    stats->steadyStateViolations = steadyStateViolations;
+
+    std::lock_guard<std::mutex> lock(gpuMutex);
+    stats->gpuBytes = gpuBytes;
+    stats->gpuPeakBytes = gpuPeakBytes;
+    std::fill(std::begin(stats->gpuKindBytes), std::end(stats->gpuKindBytes), 0);
+    std::fill(std::begin(stats->gpuKindCount), std::end(stats->gpuKindCount), 0);
+
+    // 按模块名称排序后合并，临时数组来自帧分配器；同名字符串常量在不同编译单元中地址可能不同，按内容比较
+    std::pmr::vector<std::pair<const char *, long long>> owners(&FrameArena::forThread());
+    owners.reserve(gpuAllocations.size());
+    for (const auto &entry : gpuAllocations)
+    {
+        stats->gpuKindBytes[entry.first.first] += entry.second.bytes;
+        stats->gpuKindCount[entry.first.first] += 1;
+        owners.emplace_back(entry.second.owner, entry.second.bytes);
+    }
+    std::sort(owners.begin(), owners.end(), [](const auto &a, const auto &b)
+              { return std::strcmp(a.first, b.first) < 0; });
+
+    stats->gpuOwners.clear();
+    for (const auto &owner : owners)
+    {
+        if (!stats->gpuOwners.empty() && std::strcmp(stats->gpuOwners.back().first, owner.first) == 0)
+        {
+            stats->gpuOwners.back().second += owner.second;
+        }
+        else
+        {
+            stats->gpuOwners.push_back(owner);
+        }
+    }
+}
+
+void MemoryTracker::printSummary(std::ostream &out) const
+{
+    MemoryStats stats = getStats();
+    const double mb = 1024.0 * 1024.0;
+
+    out << std::fixed << std::setprecision(2);
+    out << "Memory summary:" << std::endl;
+    out << "  CPU heap: " << stats.cpuBytes / mb << " MB (peak " << stats.cpuPeakBytes / mb << " MB), "
+        << stats.cpuLiveAllocations << " live / " << stats.cpuAllocations << " total allocations, "
+        << "peak " << stats.peakFrameAllocations << " allocations per frame" << std::endl;
+    if (stats.steadyStateCheck)
+    {
+        out << "  Steady-state frames with heap allocations: " << stats.steadyStateViolations << std::endl;
+    }
+    out << "  GPU: " << stats.gpuBytes / mb << " MB (peak " << stats.gpuPeakBytes / mb << " MB)" << std::endl;
+    for (int kind = 0; kind < static_cast<int>(GpuResourceKind::Count); ++kind)
+    {
+        out << "    " << getKindName(static_cast<GpuResourceKind>(kind)) << ": " << stats.gpuKindCount[kind]
+            << " objects, " << stats.gpuKindBytes[kind] / mb << " MB" << std::endl;
+    }
+    for (const auto &owner : stats.gpuOwners)
+    {
+        out << "    [" << owner.first << "] " << owner.second / mb << " MB" << std::endl;
+    }
+}
+
+const char *MemoryTracker::getKindName(GpuResourceKind kind)
+{
+    switch (kind)
+    {
+    case GpuResourceKind::Buffer:
+        return "Buffers";
+    case GpuResourceKind::Texture:
+        return "Textures";
+    case GpuResourceKind::Renderbuffer:
+        return "Renderbuffers";
+    case GpuResourceKind::Program:
+        return "Programs";
+    default:
+        return "Unknown";
+    }
+}
+
+long long MemoryTracker::programBytes(GLuint program)
+{
+    if (program == 0 || !GLEW_ARB_get_program_binary)
+    {
+        return 0;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    return length;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file memory_tracker.h
+ * @brief 内存统计头文件
+ * @details 定义了GPU资源登记（缓冲区、纹理、渲染缓冲区、着色器程序）和
+ * 通过替换全局operator new/delete实现的CPU堆内存统计
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief GPU资源类型
+ */
+enum class GpuResourceKind
+{
+    Buffer,
+    Texture,
+    Renderbuffer,
+    Program,
+    Count
+};
+
+/**
+ * @struct MemoryStats
+ * @brief 内存统计快照
+ */
+struct MemoryStats
+{
+    long long cpuBytes = 0;              // 当前堆内存字节数
+    long long cpuPeakBytes = 0;          // 堆内存峰值
+    long long cpuAllocations = 0;        // 累计堆分配次数
+    long long cpuLiveAllocations = 0;    // 当前未释放的堆分配数
+    long long frameAllocations = 0;      // 上一帧的堆分配次数
+    long long peakFrameAllocations = 0;  // 单帧堆分配次数峰值
+    bool steadyStateCheck = false;       // 是否启用稳定状态零分配检查
+    long long steadyStateViolations = 0; // 预热结束后仍有堆分配的帧数
+    long long gpuBytes = 0;              // 当前登记的GPU资源字节数
+    long long gpuPeakBytes = 0;          // GPU资源字节数峰值
+    long long gpuKindBytes[static_cast<int>(GpuResourceKind::Count)] = {};  // 按类型的字节数
+    int gpuKindCount[static_cast<int>(GpuResourceKind::Count)] = {};        // 按类型的对象数
+    std::vector<std::pair<const char *, long long>> gpuOwners;              // 按所属模块的字节数（名称为静态字符串）
+};
+
+/**
+ * @class MemoryTracker
+ * @brief 内存统计，使用单例模式实现
+ * @details 各模块在创建/删除GL对象后调用trackGpu/untrackGpu登记；堆内存由memory_tracker.cpp中
+ * 替换的全局operator new/delete统计，每次分配多占用一个对齐头部记录大小。
+ * 每帧开始时调用beginFrame以得到每帧分配次数。
+ * 启用稳定状态检查后，预热结束的每一帧都应不经过通用堆（临时数据使用FrameArena），
+ * 违反时计数，调试构建中直接断言失败
+ */
+class MemoryTracker
+{
+public:
+    /**
+     * @brief 获取MemoryTracker单例实例
+     * @return MemoryTracker& 单例实例的引用
+     */
+    static MemoryTracker &getInstance()
+    {
+        static MemoryTracker instance;
+        return instance;
+    }
+
+    /**
+     * @brief 登记GPU资源
+     * @param kind 资源类型
+     * @param id GL对象名称
+     * @param bytes 估算的显存字节数
+     * @param owner 所属模块名称，需为静态字符串
+     * @details 同一对象重复登记时（例如重新分配存储）覆盖原记录
+     */
+    void trackGpu(GpuResourceKind kind, GLuint id, long long bytes, const char *owner);
+
+    /**
+     * @brief 注销GPU资源
+     * @param kind 资源类型
+     * @param id GL对象名称，未登记或为0时忽略
+     */
+    void untrackGpu(GpuResourceKind kind, GLuint id);
+
+    /**
+     * @brief 开始新的一帧
+     * @details 记录上一帧的堆分配次数并清零帧计数，启用稳定状态检查时检查上一帧
+     */
+    void beginFrame();
+
+    static constexpr int defaultWarmupFrames = 120; // 稳定状态检查默认的预热帧数
+
+    /**
+     * @brief 启用稳定状态零分配检查
+     * @param warmupFrames 预热帧数，之后的每一帧都不应有堆分配
+     */
+    void enableSteadyStateCheck(int warmupFrames);
+
+    /**
+     * @brief 获取统计快照
+     * @return MemoryStats 当前统计
+     */
+    MemoryStats getStats() const;
+
+    /**
+     * @brief 将统计写入已有的快照
+     * @param stats 输出的统计，gpuOwners的容量被复用，稳定状态下不分配内存
+     */
+    void getStats(MemoryStats *stats) const;
+
+    /**
+     * @brief 输出可读的统计摘要
+     * @param out 输出流
+     */
+    void printSummary(std::ostream &out) const;
+
+    /**
+     * @brief 获取资源类型名称
+     * @param kind 资源类型
+     * @return const char* 类型名称
+     */
+    static const char *getKindName(GpuResourceKind kind);
+
+    /**
+     * @brief 估算着色器程序占用的字节数
+     * @param program 着色器程序
+     * @return long long 支持ARB_get_program_binary时为程序二进制长度，否则为0
+     */
+    static long long programBytes(GLuint program);
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    MemoryTracker() = default;
+    ~MemoryTracker() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    MemoryTracker(const MemoryTracker &) = delete;
+    MemoryTracker &operator=(const MemoryTracker &) = delete;
+
+    struct Allocation
+    {
+        long long bytes;   // 字节数
+        const char *owner; // 所属模块
+    };
+
+    using Key = std::pair<int, GLuint>; // (资源类型, GL对象名称)
+
+    mutable std::mutex gpuMutex;              // 保护GPU资源表，渲染线程登记资源时主线程可能正在读取统计
+    std::map<Key, Allocation> gpuAllocations; // 已登记的GPU资源
+    long long gpuBytes = 0;                   // 当前GPU资源字节数
+    long long gpuPeakBytes = 0;               // GPU资源字节数峰值
+
+    bool steadyStateCheck = false;             // 是否启用稳定状态检查
+    long long checkWarmupFrames = 0;           // 预热帧数
+    long long checkedFrames = 0;               // 启用检查后经过的帧数
+    long long steadyStateViolations = 0;       // 预热结束后仍有堆分配的帧数
+};
@@ -0,0 +1,285 @@
+#include "particle_system.h"
+#include "cube.h"
+#include "geometry_arena.h"
+#include "shader.h"
+#include "memory_tracker.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+namespace
+{
+    // 变换反馈更新着色器：重力、地面反弹，寿命耗尽时从喷泉口以随机方向重生
+    const char *updateVertexSource = R"(
+#version 330 core
+layout (location = 0) in vec4 inPositionLife;
+layout (location = 1) in vec4 inVelocitySeed;
+out vec4 outPositionLife;
+out vec4 outVelocitySeed;
+uniform float deltaTime;
+uniform float time;
+uniform float lifeSpan;
+uniform float gravity;
+uniform float floorHeight;
+
+float hash(float n)
+{
+    return fract(sin(n) * 43758.5453);
+}
+
+void main()
+{
+    vec3 position = inPositionLife.xyz;
+    float life = inPositionLife.w - deltaTime / lifeSpan;
+    vec3 velocity = inVelocitySeed.xyz;
+    float seed = inVelocitySeed.w;
+
+    if (life <= 0.0)
+    {
+        float n = seed * 127.1 + fract(time * 0.37) * 311.7;
+        float angle = hash(n) * 6.2831853;
+        float spread = hash(n + 1.0) * 0.6;
+        velocity = vec3(cos(angle) * spread, 3.0 + hash(n + 2.0) * 1.5, sin(angle) * spread);
+        position = vec3(0.0, floorHeight, 0.0);
+        life += 1.0;
+    }
+    else
+    {
+        velocity.y -= gravity * deltaTime;
+        position += velocity * deltaTime;
+        if (position.y < floorHeight)
+        {
+            position.y = floorHeight;
+            velocity.y = -velocity.y * 0.5;
+            velocity.xz *= 0.8;
+        }
+    }
+
+    outPositionLife = vec4(position, life);
+    outVelocitySeed = vec4(velocity, seed);
+}
+)";
+
+    constexpr float lifeSpan = 3.0f;      // 粒子寿命（秒）
+    constexpr float gravity = 4.0f;       // 重力加速度
+    constexpr float floorHeight = -1.0f;  // 地面高度
+    constexpr float particleSize = 0.03f; // 粒子立方体边长
+    constexpr double maxStep = 0.1;       // 单步最大时间步长，避免暂停后粒子穿透地面
+
+    inline float hash(float n)
+    {
+        float value = std::sin(n) * 43758.5453f;
+        return value - std::floor(value);
+    }
+}
+
+void ParticleSystem::init()
+{
+    updateProgram = Shader::getInstance().createFeedbackProgram(updateVertexSource,
+                                                                {"outPositionLife", "outVelocitySeed"}, "Particles");
+    simTimer.init();
+}
+
+void ParticleSystem::cleanup()
+{
+    simTimer.cleanup();
+    Shader::getInstance().deleteShaderProgram(updateProgram);
+    updateProgram = 0;
+    for (int i = 0; i < 2; ++i)
+    {
+        if (buffers[i] != 0)
+        {
+            MemoryTracker::getInstance().untrackGpu(GpuResourceKind::Buffer, buffers[i]);
+        }
+    }
+    glDeleteBuffers(2, buffers);
+    glDeleteVertexArrays(2, updateVAO);
+    glDeleteVertexArrays(2, drawVAO);
+    buffers[0] = buffers[1] = 0;
+    updateVAO[0] = updateVAO[1] = 0;
+    drawVAO[0] = drawVAO[1] = 0;
+    builtCount = 0;
+    cpuParticles.clear();
+}
+
+void ParticleSystem::seedParticles()
+{
+    cpuParticles.resize(particleCount);
+    for (int i = 0; i < particleCount; ++i)
+    {
+        // 初始寿命错开且速度为零，粒子在一个寿命周期内依次从喷泉口发射
+        float seed = std::fmod(i * 0.6180339887f, 1.0f);
+        Particle &particle = cpuParticles[i];
+        particle.positionLife = glm::vec4(0.0f, floorHeight, 0.0f, static_cast<float>(i + 1) / particleCount);
+        particle.velocitySeed = glm::vec4(0.0f, 0.0f, 0.0f, seed);
+    }
+}
+
+void ParticleSystem::rebuild()
+{
+    if (buffers[0] == 0)
+    {
+        glGenBuffers(2, buffers);
+        glGenVertexArrays(2, updateVAO);
+        glGenVertexArrays(2, drawVAO);
+    }
+
+    seedParticles();
+    GLsizeiptr bytes = static_cast<GLsizeiptr>(particleCount * sizeof(Particle));
+    for (int i = 0; i < 2; ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, bytes, cpuParticles.data(), GL_DYNAMIC_COPY);
+        MemoryTracker::getInstance().trackGpu(GpuResourceKind::Buffer, buffers[i], bytes, "Particles");
+
+        // 更新输入：位置寿命和速度种子
+        glBindVertexArray(updateVAO[i]);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)offsetof(Particle, positionLife));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)offsetof(Particle, velocitySeed));
+        glEnableVertexAttribArray(1);
+
+        // 绘制输入：共享几何缓冲区中的立方体顶点和索引，加每实例一次的位置寿命
+        glBindVertexArray(drawVAO[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, GeometryArena::getInstance().getVertexBuffer());
+        GeometryArena::setupAttributes(Cube::format);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GeometryArena::getInstance().getIndexBuffer());
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)offsetof(Particle, positionLife));
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    current = 0;
+    builtCount = particleCount;
+}
+
+void ParticleSystem::simulateCpu(float deltaTime, float time)
+{
+    float timePhase = time * 0.37f - std::floor(time * 0.37f);
+    for (Particle &particle : cpuParticles)
+    {
+        glm::vec4 &positionLife = particle.positionLife;
+        glm::vec4 &velocitySeed = particle.velocitySeed;
+        positionLife.w -= deltaTime / lifeSpan;
+
+        if (positionLife.w <= 0.0f)
+        {
+            float n = velocitySeed.w * 127.1f + timePhase * 311.7f;
+            float angle = hash(n) * 6.2831853f;
+            float spread = hash(n + 1.0f) * 0.6f;
+            velocitySeed.x = std::cos(angle) * spread;
+            velocitySeed.y = 3.0f + hash(n + 2.0f) * 1.5f;
+            velocitySeed.z = std::sin(angle) * spread;
+            positionLife = glm::vec4(0.0f, floorHeight, 0.0f, positionLife.w + 1.0f);
+            continue;
+        }
+
+        velocitySeed.y -= gravity * deltaTime;
+        positionLife.x += velocitySeed.x * deltaTime;
+        positionLife.y += velocitySeed.y * deltaTime;
+        positionLife.z += velocitySeed.z * deltaTime;
+        if (positionLife.y < floorHeight)
+        {
+            positionLife.y = floorHeight;
+            velocitySeed.y = -velocitySeed.y * 0.5f;
+            velocitySeed.x *= 0.8f;
+            velocitySeed.z *= 0.8f;
+        }
+    }
+}
+
+void ParticleSystem::update(double time)
+{
+    if (updateProgram == 0 || particleCount <= 0)
+    {
+        return;
+    }
+    // 切换更新方式时两边的状态不一致，重新生成初始状态
+    if (builtCount != particleCount || builtCpuUpdate != cpuUpdate)
+    {
+        rebuild();
+        builtCpuUpdate = cpuUpdate;
+        lastTime = time;
+    }
+
+    float deltaTime = static_cast<float>(std::clamp(lastTime < 0.0 ? 0.0 : time - lastTime, 0.0, maxStep));
+    lastTime = time;
+
+    if (cpuUpdate)
+    {
+        auto start = std::chrono::steady_clock::now();
+        simulateCpu(deltaTime, static_cast<float>(time));
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[current]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(cpuParticles.size() * sizeof(Particle)),
+                        cpuParticles.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        lastCpuMs = elapsed.count();
+        return;
+    }
+
+    int next = 1 - current;
+    simTimer.begin();
+    glUseProgram(updateProgram);
+    glUniform1f(glGetUniformLocation(updateProgram, "deltaTime"), deltaTime);
+    glUniform1f(glGetUniformLocation(updateProgram, "time"), static_cast<float>(time));
+    glUniform1f(glGetUniformLocation(updateProgram, "lifeSpan"), lifeSpan);
+    glUniform1f(glGetUniformLocation(updateProgram, "gravity"), gravity);
+    glUniform1f(glGetUniformLocation(updateProgram, "floorHeight"), floorHeight);
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(updateVAO[current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[next]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, builtCount);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    simTimer.end();
+
+    current = next;
+}
+
+void ParticleSystem::render(const SceneView &view, const glm::mat4 &rotation, int fragmentShader, float time)
+{
+    GLuint program = Shader::getInstance().getParticleProgram(fragmentShader);
+    if (program == 0 || builtCount == 0)
+    {
+        return;
+    }
+
+    glUseProgram(program);
+    int timeLocation = glGetUniformLocation(program, "time");
+    if (timeLocation != -1)
+    {
+        glUniform1f(timeLocation, time);
+    }
+    glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(rotation));
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view.view));
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(view.projection));
+    glUniform1f(glGetUniformLocation(program, "particleSize"), particleSize);
+
+    // 范围每帧重新读取，整理碎片后基顶点和首索引会变化
+    const GeometryMesh &cube = GeometryArena::getInstance().getMesh(Cube::getInstance().getMesh());
+    glBindVertexArray(drawVAO[current]);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(cube.indexCount), GL_UNSIGNED_INT,
+                                      (void *)(static_cast<size_t>(cube.firstIndex) * sizeof(uint32_t)), builtCount,
+                                      cube.baseVertex);
+    glBindVertexArray(0);
+}
+
+ParticleStats ParticleSystem::getStats() const
+{
+    ParticleStats stats;
+    stats.particleCount = builtCount;
+    stats.cpuUpdate = builtCpuUpdate;
+    stats.gpuSimMs = simTimer.getLastMs();
+    stats.cpuSimMs = lastCpuMs;
+    return stats;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file particle_system.h
+ * @brief 粒子系统头文件
+ * @details 定义了在GPU上用变换反馈更新位置、速度和寿命的立方体粒子，
+ * 更新结果直接作为实例属性用于实例化绘制，也可切换为CPU更新后上传以便对比
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "gpu_timer.h"
+#include "scene.h"
+
+/**
+ * @struct ParticleStats
+ * @brief 粒子系统统计
+ */
+struct ParticleStats
+{
+    int particleCount = 0;   // 粒子数
+    bool cpuUpdate = false;  // 最近一帧是否由CPU更新
+    double gpuSimMs = 0.0;   // 最近一次GPU更新的GPU耗时
+    double cpuSimMs = 0.0;   // 最近一次CPU更新的CPU耗时（含上传）
+};
+
+/**
+ * @class ParticleSystem
+ * @brief 变换反馈粒子系统，使用单例模式实现
+ * @details 两个缓冲区交替作为输入和反馈输出，每帧一次无光栅化的点绘制完成更新，
+ * 之后以输出缓冲区为location=2的实例属性绘制立方体，数据不经过CPU
+ */
+class ParticleSystem
+{
+public:
+    /**
+     * @struct Particle
+     * @brief 粒子数据，与反馈缓冲区布局一致
+     */
+    struct Particle
+    {
+        glm::vec4 positionLife; // xyz为位置，w为剩余寿命比例（1到0）
+        glm::vec4 velocitySeed; // xyz为速度，w为该粒子的随机种子
+    };
+
+    /**
+     * @brief 获取ParticleSystem单例实例
+     * @return ParticleSystem& 单例实例的引用
+     */
+    static ParticleSystem &getInstance()
+    {
+        static ParticleSystem instance;
+        return instance;
+    }
+
+    /**
+     * @brief 创建更新程序和计时器
+     * @details 缓冲区在第一次启用时按particleCount创建
+     */
+    void init();
+
+    /**
+     * @brief 释放所有GL资源
+     */
+    void cleanup();
+
+    /**
+     * @brief 推进一步模拟
+     * @param time 着色器time值，步长由与上一帧的差值得到
+     * @details 在渲染侧每帧调用一次，不能位于其他GL_TIME_ELAPSED查询之间
+     */
+    void update(double time);
+
+    /**
+     * @brief 实例化绘制所有粒子
+     * @param view 相机矩阵
+     * @param rotation 场景整体的旋转矩阵
+     * @param fragmentShader 片段着色器索引
+     * @param time 动画时间
+     */
+    void render(const SceneView &view, const glm::mat4 &rotation, int fragmentShader, float time);
+
+    /**
+     * @brief 获取统计信息
+     * @return ParticleStats 统计信息
+     */
+    ParticleStats getStats() const;
+
+    bool enabled = false;       // 是否模拟并绘制粒子
+    bool cpuUpdate = false;     // 是否改为CPU更新后上传，用于对比
+    int particleCount = 100000; // 粒子数，变化时重新生成初始状态
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    ParticleSystem() = default;
+    ~ParticleSystem() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    ParticleSystem(const ParticleSystem &) = delete;
+    ParticleSystem &operator=(const ParticleSystem &) = delete;
+
+    /**
+     * @brief 按当前粒子数重建缓冲区和顶点数组对象
+     */
+    void rebuild();
+
+    /**
+     * @brief 生成初始状态，寿命均匀错开使粒子连续发射
+     */
+    void seedParticles();
+
+    /**
+     * @brief 在CPU上执行与更新着色器相同的计算
+     * @param deltaTime 时间步长（秒）
+     * @param time 当前时间
+     */
+    void simulateCpu(float deltaTime, float time);
+
+    GLuint updateProgram = 0;   // 变换反馈更新程序
+    GLuint buffers[2] = {0, 0}; // 交替使用的粒子缓冲区
+    GLuint updateVAO[2] = {0, 0}; // 以对应缓冲区为输入的更新顶点数组对象
+    GLuint drawVAO[2] = {0, 0};   // 以对应缓冲区为实例属性的绘制顶点数组对象
+    int current = 0;            // 保存最新状态的缓冲区索引
+    int builtCount = 0;         // 当前缓冲区对应的粒子数
+    bool builtCpuUpdate = false; // 上一帧的更新方式，切换时重新生成初始状态
+    double lastTime = -1.0;     // 上一次更新的时间
+
+    std::vector<Particle> cpuParticles; // CPU更新使用的粒子状态
+    GpuTimer simTimer;                  // GPU更新耗时
+    double lastCpuMs = 0.0;             // 最近一次CPU更新耗时
+};
@@ -0,0 +1,54 @@
+#include "radix_sort.h"
+#include <cstddef>
+
+void radixSort64(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch, int significantBits, int firstBit)
+{
+    const size_t count = keys.size();
+    if (count < 2)
+    {
+        return;
+    }
+    scratch.resize(count);
+
+    uint64_t *source = keys.data();
+    uint64_t *destination = scratch.data();
+
+    for (int shift = firstBit; shift < significantBits; shift += 8)
+    {
+        uint32_t histogram[256] = {};
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++histogram[(source[i] >> shift) & 0xFF];
+        }
+
+        // 所有键在这一趟的数字相同，顺序不变
+        if (histogram[(source[0] >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit)
+        {
+            uint32_t bucket = histogram[digit];
+            histogram[digit] = offset;
+            offset += bucket;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64_t key = source[i];
+            destination[histogram[(key >> shift) & 0xFF]++] = key;
+        }
+
+        uint64_t *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    // 结果落在临时缓冲区时交换回来
+    if (source != keys.data())
+    {
+        keys.swap(scratch);
+    }
+}
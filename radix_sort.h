@@ -0,0 +1,22 @@
+/**
+ * @file radix_sort.h
+ * @brief 基数排序头文件
+ * @details 定义了对64位打包键进行排序的LSD基数排序
+ */
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 对64位键做升序的LSD基数排序
+ * @param keys 待排序的键，排序结果写回该数组
+ * @param scratch 临时缓冲区，会被调整为与keys相同大小，可在帧之间复用以避免分配
+ * @param significantBits 参与排序的低位比特数，高于该位的比特视为0
+ * @param firstBit 从该位开始排序，低于该位的比特不参与排序
+ * @details 每趟处理8位，所有键在某一趟的数字相同时跳过该趟。
+ * 调用方通常把排序键放在高位、把对象索引放在低位，排序后从低位取回索引。
+ * 排序是稳定的，低位索引已按升序排列时把firstBit设为索引位数即可省去这几趟
+ */
+void radixSort64(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch, int significantBits = 64,
+                 int firstBit = 0);
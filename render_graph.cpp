@@ -0,0 +1,553 @@
+#include "render_graph.h"
+#include "memory_tracker.h"
+#include <algorithm>
+#include <iostream>
+
+void RenderGraph::Builder::read(RGHandle handle)
+{
+    if (handle != RGInvalidHandle)
+    {
+        graph.passes[pass].reads.push_back(handle);
+    }
+}
+
+void RenderGraph::Builder::writeColor(RGHandle handle)
+{
+    if (handle != RGInvalidHandle)
+    {
+        graph.passes[pass].color = handle;
+        graph.passes[pass].writes.push_back(handle);
+    }
+}
+
+void RenderGraph::Builder::writeDepth(RGHandle handle)
+{
+    if (handle != RGInvalidHandle)
+    {
+        graph.passes[pass].depth = handle;
+        graph.passes[pass].writes.push_back(handle);
+    }
+}
+
+void RenderGraph::Builder::setSideEffect()
+{
+    graph.passes[pass].sideEffect = true;
+}
+
+void RenderGraph::Builder::setViewport(int width, int height)
+{
+    graph.passes[pass].viewportWidth = width;
+    graph.passes[pass].viewportHeight = height;
+}
+
+void RenderGraph::beginFrame()
+{
+    resources.clear();
+    passCount = 0;
+    order.clear();
+}
+
+RGHandle RenderGraph::createResource(const char *name, const RGResourceDesc &desc)
+{
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resources.push_back(resource);
+    return static_cast<RGHandle>(resources.size() - 1);
+}
+
+RGHandle RenderGraph::importFramebuffer(const char *name, GLuint framebuffer, int width, int height)
+{
+    Resource resource;
+    resource.name = name;
+    resource.desc.width = width;
+    resource.desc.height = height;
+    resource.imported = true;
+    resource.importedFramebuffer = framebuffer;
+    resources.push_back(resource);
+    return static_cast<RGHandle>(resources.size() - 1);
+}
+
+int RenderGraph::beginPass(const char *name, void *callable, void (*invoke)(void *))
+{
+    if (passCount == static_cast<int>(passes.size()))
+    {
+        passes.emplace_back();
+    }
+    Pass &pass = passes[passCount];
+    pass.name = name;
+    pass.callable = callable;
+    pass.invoke = invoke;
+    pass.reads.clear();
+    pass.writes.clear();
+    pass.color = RGInvalidHandle;
+    pass.depth = RGInvalidHandle;
+    pass.sideEffect = false;
+    pass.culled = false;
+    pass.viewportWidth = 0;
+    pass.viewportHeight = 0;
+    return passCount++;
+}
+
+void RenderGraph::markOutput(RGHandle handle)
+{
+    if (handle != RGInvalidHandle)
+    {
+        resources[handle].output = true;
+    }
+}
+
+void RenderGraph::compile()
+{
+    // 排序和别名使用的临时数组都来自帧分配器，帧结束时整体释放
+    FrameArena &arena = FrameArena::forThread();
+
+    // 1. 剔除：从输出资源反向传播。通道写入的附件会保留之前的内容，
+    //    因此存活通道的读和写都使资源成为必需
+    for (auto &resource : resources)
+    {
+        resource.needed = resource.output;
+        resource.firstUse = -1;
+        resource.lastUse = -1;
+        resource.physical = -1;
+    }
+    for (int i = passCount - 1; i >= 0; --i)
+    {
+        Pass &pass = passes[i];
+        bool live = pass.sideEffect;
+        for (RGHandle handle : pass.writes)
+        {
+            live = live || resources[handle].needed;
+        }
+        pass.culled = !live;
+        if (!live)
+        {
+            continue;
+        }
+        for (RGHandle handle : pass.reads)
+        {
+            resources[handle].needed = true;
+        }
+        for (RGHandle handle : pass.writes)
+        {
+            resources[handle].needed = true;
+        }
+    }
+
+    // 2. 排序：对读后写、写后读、写后写依赖做拓扑排序，同等条件下保持声明顺序
+    std::pmr::vector<std::pmr::vector<int>> successors(passCount, &arena);
+    std::pmr::vector<int> inDegree(passCount, 0, &arena);
+    std::pmr::vector<int> lastWriter(resources.size(), -1, &arena);
+    std::pmr::vector<std::pmr::vector<int>> readersSinceWrite(resources.size(), &arena);
+    auto addEdge = [&](int from, int to)
+    {
+        if (from >= 0 && from != to &&
+            std::find(successors[from].begin(), successors[from].end(), to) == successors[from].end())
+        {
+            successors[from].push_back(to);
+            ++inDegree[to];
+        }
+    };
+    for (int i = 0; i < passCount; ++i)
+    {
+        const Pass &pass = passes[i];
+        if (pass.culled)
+            continue;
+        for (RGHandle handle : pass.reads)
+        {
+            addEdge(lastWriter[handle], i);
+            readersSinceWrite[handle].push_back(i);
+        }
+        for (RGHandle handle : pass.writes)
+        {
+            addEdge(lastWriter[handle], i);
+            for (int reader : readersSinceWrite[handle])
+            {
+                addEdge(reader, i);
+            }
+            readersSinceWrite[handle].clear();
+            lastWriter[handle] = i;
+        }
+    }
+
+    order.clear();
+    std::pmr::vector<int> ready(&arena);
+    for (int i = 0; i < passCount; ++i)
+    {
+        if (!passes[i].culled && inDegree[i] == 0)
+            ready.push_back(i);
+    }
+    while (!ready.empty())
+    {
+        auto next = std::min_element(ready.begin(), ready.end());
+        int pass = *next;
+        ready.erase(next);
+        order.push_back(pass);
+        for (int successor : successors[pass])
+        {
+            if (--inDegree[successor] == 0)
+                ready.push_back(successor);
+        }
+    }
+
+    // 3. 生命周期：记录每个资源在执行顺序中的首次和最后一次使用
+    for (int position = 0; position < static_cast<int>(order.size()); ++position)
+    {
+        const Pass &pass = passes[order[position]];
+        auto touch = [&](RGHandle handle)
+        {
+            Resource &resource = resources[handle];
+            if (resource.firstUse < 0)
+                resource.firstUse = position;
+            resource.lastUse = position;
+        };
+        for (RGHandle handle : pass.reads)
+            touch(handle);
+        for (RGHandle handle : pass.writes)
+            touch(handle);
+    }
+
+    // 4. 别名：按首次使用顺序为临时资源分配物理资源
+    for (auto &physical : physicals)
+    {
+        physical.usedThisFrame = false;
+        physical.busyUntil = -1;
+    }
+
+    std::pmr::vector<RGHandle> transient(&arena);
+    for (RGHandle handle = 0; handle < static_cast<RGHandle>(resources.size()); ++handle)
+    {
+        const Resource &resource = resources[handle];
+        if (!resource.imported && resource.firstUse >= 0)
+            transient.push_back(handle);
+    }
+    std::sort(transient.begin(), transient.end(), [&](RGHandle a, RGHandle b)
+              { return resources[a].firstUse < resources[b].firstUse; });
+
+    stats = RGStats();
+    stats.passCount = passCount;
+    stats.culledPassCount = passCount - static_cast<int>(order.size());
+    stats.resourceCount = static_cast<int>(transient.size());
+    for (RGHandle handle : transient)
+    {
+        resources[handle].physical = acquirePhysical(handle);
+        stats.unaliasedBytes += bytesFor(resources[handle].desc);
+    }
+
+    // 5. 统计并释放长时间闲置的物理资源
+    for (int i = 0; i < static_cast<int>(physicals.size()); ++i)
+    {
+        Physical &physical = physicals[i];
+        if (physical.usedThisFrame)
+        {
+            physical.idleFrames = 0;
+            ++stats.physicalCount;
+            stats.peakBytes += bytesFor(physical.desc);
+        }
+        else if ((physical.texture != 0 || physical.renderbuffer != 0) && ++physical.idleFrames > maxIdleFrames)
+        {
+            destroyPhysical(i);
+        }
+    }
+}
+
+int RenderGraph::acquirePhysical(RGHandle handle)
+{
+    const Resource &resource = resources[handle];
+    int reusable = -1;
+    int freeSlot = -1;
+
+    for (int i = 0; i < static_cast<int>(physicals.size()); ++i)
+    {
+        Physical &physical = physicals[i];
+        if (physical.texture == 0 && physical.renderbuffer == 0)
+        {
+            if (freeSlot < 0)
+                freeSlot = i;
+            continue;
+        }
+        if (!(physical.desc == resource.desc))
+            continue;
+
+        if (!physical.usedThisFrame)
+        {
+            // 上一帧留下的同描述资源，作为备选
+            if (reusable < 0)
+                reusable = i;
+        }
+        else if (aliasingEnabled && physical.busyUntil < resource.firstUse)
+        {
+            // 本帧已被生命周期更早结束的资源使用，直接别名
+            reusable = i;
+            break;
+        }
+    }
+
+    if (reusable < 0)
+    {
+        if (freeSlot < 0)
+        {
+            physicals.emplace_back();
+            freeSlot = static_cast<int>(physicals.size() - 1);
+        }
+        Physical &physical = physicals[freeSlot];
+        physical.desc = resource.desc;
+        physical.idleFrames = 0;
+        createPhysical(physical);
+        reusable = freeSlot;
+    }
+
+    Physical &physical = physicals[reusable];
+    physical.usedThisFrame = true;
+    physical.busyUntil = resource.lastUse;
+    return reusable;
+}
+
+void RenderGraph::createPhysical(Physical &physical)
+{
+    const RGResourceDesc &desc = physical.desc;
+    if (desc.samples > 0 || isDepthFormat(desc.format))
+    {
+        glGenRenderbuffers(1, &physical.renderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, physical.renderbuffer);
+        if (desc.samples > 0)
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, desc.samples, desc.format, desc.width, desc.height);
+        else
+            glRenderbufferStorage(GL_RENDERBUFFER, desc.format, desc.width, desc.height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        MemoryTracker::getInstance().trackGpu(GpuResourceKind::Renderbuffer, physical.renderbuffer,
+                                              bytesFor(desc), "RenderGraph");
+    }
+    else
+    {
+        glGenTextures(1, &physical.texture);
+        glBindTexture(GL_TEXTURE_2D, physical.texture);
+        GLenum format = GL_RGBA;
+        GLenum type = GL_UNSIGNED_BYTE;
+        uploadFormatFor(desc.format, &format, &type);
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.format, desc.width, desc.height, 0, format, type, nullptr);
+        MemoryTracker::getInstance().trackGpu(GpuResourceKind::Texture, physical.texture, bytesFor(desc), "RenderGraph");
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
+
+void RenderGraph::destroyPhysical(int index)
+{
+    Physical &physical = physicals[index];
+
+    // 物理资源槽位会以新的GL对象复用，先删除引用它的帧缓冲区
+    for (auto it = framebuffers.begin(); it != framebuffers.end();)
+    {
+        if (it->color == index || it->depth == index)
+        {
+            glDeleteFramebuffers(1, &it->framebuffer);
+            it = framebuffers.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    if (physical.texture != 0)
+    {
+        tracker.untrackGpu(GpuResourceKind::Texture, physical.texture);
+        glDeleteTextures(1, &physical.texture);
+    }
+    if (physical.renderbuffer != 0)
+    {
+        tracker.untrackGpu(GpuResourceKind::Renderbuffer, physical.renderbuffer);
+        glDeleteRenderbuffers(1, &physical.renderbuffer);
+    }
+    physical.texture = 0;
+    physical.renderbuffer = 0;
+    physical.usedThisFrame = false;
+    physical.idleFrames = 0;
+}
+
+void RenderGraph::execute()
+{
+    for (int index : order)
+    {
+        Pass &pass = passes[index];
+        if (pass.color != RGInvalidHandle || pass.depth != RGInvalidHandle)
+        {
+            RGHandle sizeSource = pass.color != RGInvalidHandle ? pass.color : pass.depth;
+            const RGResourceDesc &desc = resources[sizeSource].desc;
+            glBindFramebuffer(GL_FRAMEBUFFER, getFramebuffer(pass.color, pass.depth));
+            if (pass.viewportWidth > 0 && pass.viewportHeight > 0)
+                glViewport(0, 0, pass.viewportWidth, pass.viewportHeight);
+            else
+                glViewport(0, 0, desc.width, desc.height);
+        }
+        if (pass.invoke != nullptr)
+        {
+            pass.invoke(pass.callable);
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderGraph::cleanup()
+{
+    for (int i = 0; i < static_cast<int>(physicals.size()); ++i)
+    {
+        destroyPhysical(i);
+    }
+    for (auto &cached : framebuffers)
+    {
+        glDeleteFramebuffers(1, &cached.framebuffer);
+    }
+    physicals.clear();
+    framebuffers.clear();
+    beginFrame();
+}
+
+GLuint RenderGraph::getTexture(RGHandle handle) const
+{
+    if (handle == RGInvalidHandle)
+        return 0;
+    const Resource &resource = resources[handle];
+    if (resource.imported || resource.physical < 0)
+        return 0;
+    return physicals[resource.physical].texture;
+}
+
+int RenderGraph::physicalIndex(RGHandle handle) const
+{
+    if (handle == RGInvalidHandle)
+        return -1;
+    return resources[handle].physical;
+}
+
+GLuint RenderGraph::getFramebuffer(RGHandle color, RGHandle depth)
+{
+    if (color != RGInvalidHandle && resources[color].imported)
+    {
+        return resources[color].importedFramebuffer;
+    }
+
+    int colorPhysical = physicalIndex(color);
+    int depthPhysical = physicalIndex(depth);
+    for (const auto &cached : framebuffers)
+    {
+        if (cached.color == colorPhysical && cached.depth == depthPhysical)
+            return cached.framebuffer;
+    }
+
+    CachedFramebuffer cached;
+    cached.color = colorPhysical;
+    cached.depth = depthPhysical;
+    glGenFramebuffers(1, &cached.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, cached.framebuffer);
+
+    if (color != RGInvalidHandle)
+    {
+        const Physical &physical = physicals[resources[color].physical];
+        if (physical.texture != 0)
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, physical.texture, 0);
+        else
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, physical.renderbuffer);
+    }
+    else
+    {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+
+    if (depth != RGInvalidHandle)
+    {
+        GLenum attachment = resources[depth].desc.format == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, physicals[depthPhysical].renderbuffer);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "Render graph framebuffer is incomplete: "
+                  << (color != RGInvalidHandle ? resources[color].name : "-") << " / "
+                  << (depth != RGInvalidHandle ? resources[depth].name : "-") << std::endl;
+    }
+
+    framebuffers.push_back(cached);
+    return cached.framebuffer;
+}
+
+std::vector<const char *> RenderGraph::getExecutionOrder() const
+{
+    std::vector<const char *> names;
+    for (int index : order)
+    {
+        names.push_back(passes[index].name);
+    }
+    return names;
+}
+
+void RenderGraph::uploadFormatFor(GLenum internalFormat, GLenum *format, GLenum *type)
+{
+    switch (internalFormat)
+    {
+    case GL_R8:
+        *format = GL_RED;
+        *type = GL_UNSIGNED_BYTE;
+        break;
+    case GL_RG8:
+        *format = GL_RG;
+        *type = GL_UNSIGNED_BYTE;
+        break;
+    case GL_R32F:
+        *format = GL_RED;
+        *type = GL_FLOAT;
+        break;
+    case GL_R32UI:
+        *format = GL_RED_INTEGER;
+        *type = GL_UNSIGNED_INT;
+        break;
+    case GL_RGBA16F:
+    case GL_RGBA32F:
+        *format = GL_RGBA;
+        *type = GL_FLOAT;
+        break;
+    default:
+        *format = GL_RGBA;
+        *type = GL_UNSIGNED_BYTE;
+        break;
+    }
+}
+
+bool RenderGraph::isDepthFormat(GLenum format)
+{
+    return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH_COMPONENT24 ||
+           format == GL_DEPTH_COMPONENT32F || format == GL_DEPTH_COMPONENT16 ||
+           format == GL_DEPTH32F_STENCIL8;
+}
+
+long long RenderGraph::bytesFor(const RGResourceDesc &desc)
+{
+    long long bytesPerPixel = 4;
+    switch (desc.format)
+    {
+    case GL_R8:
+        bytesPerPixel = 1;
+        break;
+    case GL_DEPTH_COMPONENT16:
+    case GL_RG8:
+        bytesPerPixel = 2;
+        break;
+    case GL_RGBA16F:
+    case GL_DEPTH32F_STENCIL8:
+        bytesPerPixel = 8;
+        break;
+    case GL_RGBA32F:
+        bytesPerPixel = 16;
+        break;
+    default:
+        bytesPerPixel = 4;
+        break;
+    }
+    return bytesPerPixel * desc.width * desc.height * std::max(1, desc.samples);
+}
@@ -0,0 +1,339 @@
+/**
+ * @file render_graph.h
+ * @brief 渲染图头文件
+ * @details 定义了按帧声明的渲染图：各个通道声明输入输出资源，渲染图据此计算执行顺序、
+ * 剔除无用通道，并把生命周期不重叠的临时纹理和渲染缓冲区别名到同一块显存上
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "frame_arena.h"
+
+/**
+ * @brief 渲染图资源句柄
+ */
+using RGHandle = int;
+
+/**
+ * @brief 无效的资源句柄
+ */
+constexpr RGHandle RGInvalidHandle = -1;
+
+/**
+ * @struct RGResourceDesc
+ * @brief 临时资源描述
+ * @details 深度格式或多重采样资源使用渲染缓冲区，其余使用可采样的纹理。
+ * GL无法在不同尺寸/格式之间共享内存，因此只有描述完全相同的资源才能别名
+ */
+struct RGResourceDesc
+{
+    int width = 0;            // 宽度（像素）
+    int height = 0;           // 高度（像素）
+    GLenum format = GL_RGBA8; // 内部格式
+    int samples = 0;          // 多重采样数，0表示单采样
+
+    bool operator==(const RGResourceDesc &other) const
+    {
+        return width == other.width && height == other.height &&
+               format == other.format && samples == other.samples;
+    }
+};
+
+/**
+ * @struct RGStats
+ * @brief 渲染图统计信息
+ */
+struct RGStats
+{
+    int passCount = 0;            // 声明的通道数
+    int culledPassCount = 0;      // 被剔除的通道数
+    int resourceCount = 0;        // 使用中的临时资源数
+    int physicalCount = 0;        // 实际分配的物理资源数
+    long long peakBytes = 0;      // 别名后的峰值显存
+    long long unaliasedBytes = 0; // 不别名时的峰值显存
+};
+
+/**
+ * @class RenderGraph
+ * @brief 渲染图，使用单例模式实现
+ * @details 每帧调用beginFrame后重新声明资源和通道，再依次调用compile和execute。
+ * 物理资源和帧缓冲区在帧之间缓存，长时间未使用时释放
+ */
+class RenderGraph
+{
+public:
+    /**
+     * @class Builder
+     * @brief 通道声明器
+     * @details 在addPass的setup回调中声明通道读写的资源
+     */
+    class Builder
+    {
+    public:
+        /**
+         * @brief 声明通道读取（采样或拷贝源）的资源
+         * @param handle 资源句柄
+         */
+        void read(RGHandle handle);
+
+        /**
+         * @brief 声明通道写入的颜色附件
+         * @param handle 资源句柄
+         */
+        void writeColor(RGHandle handle);
+
+        /**
+         * @brief 声明通道写入的深度附件
+         * @param handle 资源句柄
+         */
+        void writeDepth(RGHandle handle);
+
+        /**
+         * @brief 声明通道有图外副作用（例如回读），不会被剔除
+         */
+        void setSideEffect();
+
+        /**
+         * @brief 设置通道的视口
+         * @param width 视口宽度
+         * @param height 视口高度
+         * @details 视口位于附件左下角，默认与附件同尺寸；用于只渲染到较大目标的一部分
+         */
+        void setViewport(int width, int height);
+
+    private:
+        friend class RenderGraph;
+        Builder(RenderGraph &graph, int pass) : graph(graph), pass(pass) {}
+
+        RenderGraph &graph; // 所属渲染图
+        int pass;           // 正在声明的通道索引
+    };
+
+    /**
+     * @brief 获取RenderGraph单例实例
+     * @return RenderGraph& 单例实例的引用
+     */
+    static RenderGraph &getInstance()
+    {
+        static RenderGraph instance;
+        return instance;
+    }
+
+    /**
+     * @brief 开始新一帧的声明
+     * @details 清空上一帧的通道和资源声明，保留物理资源缓存
+     */
+    void beginFrame();
+
+    /**
+     * @brief 声明临时资源
+     * @param name 资源名称，需为静态字符串
+     * @param desc 资源描述
+     * @return RGHandle 资源句柄
+     */
+    RGHandle createResource(const char *name, const RGResourceDesc &desc);
+
+    /**
+     * @brief 导入外部帧缓冲区
+     * @param name 资源名称，需为静态字符串
+     * @param framebuffer 帧缓冲区ID，0表示窗口帧缓冲区
+     * @param width 宽度
+     * @param height 高度
+     * @return RGHandle 资源句柄
+     * @details 导入的资源不参与别名，也不会被释放
+     */
+    RGHandle importFramebuffer(const char *name, GLuint framebuffer, int width, int height);
+
+    /**
+     * @brief 声明通道
+     * @param name 通道名称，需为静态字符串
+     * @param setup 声明读写资源的回调，在addPass内立即调用
+     * @param execute 执行GL命令的回调，调用前已绑定写入的附件并设置视口
+     * @details 执行回调拷贝到调用线程的帧分配器中而不是std::function的堆存储，
+     * 因此只能捕获引用、指针和数值（可平凡析构），并且必须在同一帧内执行
+     */
+    template <typename Setup, typename Execute>
+    void addPass(const char *name, Setup &&setup, Execute &&execute)
+    {
+        using Callable = std::decay_t<Execute>;
+        static_assert(std::is_trivially_destructible<Callable>::value,
+                      "render graph pass callbacks live in the frame arena and are never destroyed");
+        void *storage = FrameArena::forThread().allocate(sizeof(Callable), alignof(Callable));
+        Callable *callable = new (storage) Callable(std::forward<Execute>(execute));
+        Builder builder(*this, beginPass(name, callable, [](void *data) { (*static_cast<Callable *>(data))(); }));
+        setup(builder);
+    }
+
+    /**
+     * @brief 将资源标记为帧的最终输出
+     * @param handle 资源句柄
+     * @details 不直接或间接贡献给输出的通道会被剔除
+     */
+    void markOutput(RGHandle handle);
+
+    /**
+     * @brief 编译渲染图
+     * @details 剔除无用通道、计算执行顺序和资源生命周期，并分配物理资源
+     */
+    void compile();
+
+    /**
+     * @brief 按编译出的顺序执行所有通道
+     */
+    void execute();
+
+    /**
+     * @brief 释放所有缓存的GL资源
+     */
+    void cleanup();
+
+    /**
+     * @brief 获取资源对应的纹理
+     * @param handle 资源句柄
+     * @return GLuint 纹理ID，渲染缓冲区或导入资源返回0
+     */
+    GLuint getTexture(RGHandle handle) const;
+
+    /**
+     * @brief 获取以指定资源为附件的帧缓冲区
+     * @param color 颜色附件句柄
+     * @param depth 深度附件句柄，可为RGInvalidHandle
+     * @return GLuint 帧缓冲区ID
+     */
+    GLuint getFramebuffer(RGHandle color, RGHandle depth = RGInvalidHandle);
+
+    /**
+     * @brief 获取资源描述
+     * @param handle 资源句柄
+     * @return const RGResourceDesc& 资源描述
+     */
+    const RGResourceDesc &getDesc(RGHandle handle) const { return resources[handle].desc; }
+
+    /**
+     * @brief 获取最近一次编译的统计信息
+     * @return const RGStats& 统计信息
+     */
+    const RGStats &getStats() const { return stats; }
+
+    /**
+     * @brief 获取最近一次编译的执行顺序
+     * @return std::vector<const char *> 按执行顺序排列的通道名称
+     */
+    std::vector<const char *> getExecutionOrder() const;
+
+    bool aliasingEnabled = true; // 是否启用临时资源别名
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    RenderGraph() = default;
+    ~RenderGraph() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    RenderGraph(const RenderGraph &) = delete;
+    RenderGraph &operator=(const RenderGraph &) = delete;
+
+    struct Resource
+    {
+        const char *name = "";             // 资源名称
+        RGResourceDesc desc;               // 资源描述
+        bool imported = false;             // 是否为导入资源
+        GLuint importedFramebuffer = 0;    // 导入的帧缓冲区
+        bool needed = false;               // 是否被存活通道使用
+        bool output = false;               // 是否为帧输出
+        int firstUse = -1;                 // 第一次使用的执行位置
+        int lastUse = -1;                  // 最后一次使用的执行位置
+        int physical = -1;                 // 分配到的物理资源索引
+    };
+
+    struct Pass
+    {
+        const char *name = "";             // 通道名称
+        void *callable = nullptr;          // 帧分配器中的执行回调对象
+        void (*invoke)(void *) = nullptr;  // 调用执行回调
+        std::vector<RGHandle> reads;       // 读取的资源
+        std::vector<RGHandle> writes;      // 写入的资源
+        RGHandle color = RGInvalidHandle;  // 颜色附件
+        RGHandle depth = RGInvalidHandle;  // 深度附件
+        bool sideEffect = false;           // 是否有副作用
+        bool culled = false;               // 是否被剔除
+        int viewportWidth = 0;             // 视口宽度，0表示与附件同尺寸
+        int viewportHeight = 0;            // 视口高度
+    };
+
+    struct Physical
+    {
+        RGResourceDesc desc;               // 资源描述
+        GLuint texture = 0;                // 纹理ID
+        GLuint renderbuffer = 0;           // 渲染缓冲区ID
+        int busyUntil = -1;                // 本帧占用到的执行位置
+        bool usedThisFrame = false;        // 本帧是否已分配
+        int idleFrames = 0;                // 连续未使用的帧数
+    };
+
+    // 纹理和渲染缓冲区的名称空间相互独立，同一个名称可能分别指向两者，缓存以物理资源索引为键
+    struct CachedFramebuffer
+    {
+        int color = -1;                    // 颜色附件的物理资源索引
+        int depth = -1;                    // 深度附件的物理资源索引
+        GLuint framebuffer = 0;            // 帧缓冲区ID
+    };
+
+    /**
+     * @brief 判断格式是否为深度格式
+     */
+    static bool isDepthFormat(GLenum format);
+
+    /**
+     * @brief 获取内部格式对应的像素格式和类型，用于分配纹理存储
+     */
+    static void uploadFormatFor(GLenum internalFormat, GLenum *format, GLenum *type);
+
+    /**
+     * @brief 估算资源占用的字节数
+     */
+    static long long bytesFor(const RGResourceDesc &desc);
+
+    /**
+     * @brief 为资源分配物理资源
+     * @param handle 资源句柄
+     * @return int 物理资源索引
+     */
+    int acquirePhysical(RGHandle handle);
+
+    /**
+     * @brief 追加一个通道，复用上一帧同一位置的Pass对象及其读写列表的容量
+     * @return int 通道索引
+     */
+    int beginPass(const char *name, void *callable, void (*invoke)(void *));
+
+    /**
+     * @brief 创建物理资源的GL对象
+     */
+    void createPhysical(Physical &physical);
+
+    /**
+     * @brief 删除物理资源及引用它的帧缓冲区
+     * @param index 物理资源索引
+     */
+    void destroyPhysical(int index);
+
+    /**
+     * @brief 获取资源对应的物理资源索引
+     * @return int 物理资源索引，句柄无效或未分配时返回-1
+     */
+    int physicalIndex(RGHandle handle) const;
+
+    static constexpr int maxIdleFrames = 60; // 物理资源闲置多少帧后释放
+
+    std::vector<Resource> resources;               // 本帧声明的资源
+    std::vector<Pass> passes;                      // 通道对象池，前passCount个为本帧声明的通道
+    int passCount = 0;                             // 本帧声明的通道数
+    std::vector<int> order;                        // 编译出的执行顺序
+    std::vector<Physical> physicals;               // 物理资源池
+    std::vector<CachedFramebuffer> framebuffers;   // 帧缓冲区缓存
+    RGStats stats;                                 // 统计信息
+};
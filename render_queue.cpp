@@ -0,0 +1,334 @@
+#include "render_queue.h"
+#include "shader.h"
+#include "radix_sort.h"
+#include "texture_manager.h"
+#include "memory_tracker.h"
+#include "geometry_arena.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    constexpr int itemShift = 0;
+    constexpr int depthShift = 32;
+    constexpr int meshShift = depthShift + RenderQueue::depthBits;
+    constexpr int programShift = meshShift + RenderQueue::meshBits;
+    constexpr int passShift = programShift + RenderQueue::programBits;
+    static_assert(passShift + 2 == 64, "sort key fields must fill 64 bits");
+
+    constexpr GLsizeiptr drawDataSize = sizeof(glm::mat4); // DrawData块的大小（std140下一个mat4）
+    constexpr size_t minSegmentDraws = 256; // 每段至少包含的绘制数，段太短时分发的开销超过录制本身
+}
+
+void RenderQueue::init()
+{
+    // 绑定范围的起始偏移必须是该值的整数倍，常见为256字节
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment = std::max<GLint>(alignment, 1);
+    drawDataStride = (drawDataSize + alignment - 1) / alignment * alignment;
+    glGenBuffers(1, &uniformBuffer);
+}
+
+void RenderQueue::cleanup()
+{
+    if (uniformBuffer != 0)
+    {
+        MemoryTracker::getInstance().untrackGpu(GpuResourceKind::Buffer, uniformBuffer);
+        glDeleteBuffers(1, &uniformBuffer);
+        uniformBuffer = 0;
+    }
+    bufferCapacity = 0;
+    commandLists.clear();
+    CommandRecorder::getInstance().shutdown();
+}
+
+void RenderQueue::begin(const glm::mat4 &view, const glm::mat4 &projection, float time)
+{
+    frameView = view;
+    frameProjection = projection;
+    frameTime = time;
+    programs.clear();
+    meshes.clear();
+    items.clear();
+    keys.clear();
+    drawDataCount = 0;
+    frameUniformsRecorded = false;
+}
+
+uint32_t RenderQueue::addProgram(GLuint program)
+{
+    for (size_t i = 0; i < programs.size(); ++i)
+    {
+        if (programs[i].program == program)
+        {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    ProgramSlot slot;
+    slot.program = program;
+    slot.viewLocation = glGetUniformLocation(program, "view");
+    slot.projectionLocation = glGetUniformLocation(program, "projection");
+    slot.timeLocation = glGetUniformLocation(program, "time");
+    slot.textured = glGetUniformLocation(program, "diffuseTexture") != -1;
+    programs.push_back(slot);
+    return static_cast<uint32_t>(programs.size() - 1);
+}
+
+uint32_t RenderQueue::addMesh(GLuint vao, GLsizei indexCount, GLuint firstIndex, GLint baseVertex)
+{
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        const MeshSlot &slot = meshes[i];
+        if (slot.vao == vao && slot.indexCount == indexCount && slot.firstIndex == firstIndex &&
+            slot.baseVertex == baseVertex)
+        {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    meshes.push_back({vao, indexCount, firstIndex, baseVertex});
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+uint32_t RenderQueue::addDrawData(const glm::mat4 &model)
+{
+    size_t required = static_cast<size_t>(drawDataCount + 1) * static_cast<size_t>(drawDataStride);
+    if (drawData.size() < required)
+    {
+        drawData.resize(std::max(required, drawData.size() * 2));
+    }
+    std::memcpy(drawData.data() + static_cast<size_t>(drawDataCount) * drawDataStride, glm::value_ptr(model),
+                drawDataSize);
+    return drawDataCount++;
+}
+
+void RenderQueue::push(Pass pass, uint32_t program, uint32_t mesh, float depth, uint32_t drawData, int material)
+{
+    const float maxDepth = static_cast<float>((1 << depthBits) - 1);
+    depth = std::min(std::max(depth, 0.0f), 1.0f);
+    uint64_t key = (static_cast<uint64_t>(pass) << passShift) |
+                   (static_cast<uint64_t>(program & ((1u << programBits) - 1)) << programShift) |
+                   (static_cast<uint64_t>(mesh & ((1u << meshBits) - 1)) << meshShift) |
+                   (static_cast<uint64_t>(depth * maxDepth) << depthShift) |
+                   (static_cast<uint64_t>(items.size()) << itemShift);
+    keys.push_back(key);
+    items.push_back({drawData, material});
+}
+
+void RenderQueue::finish(RenderQueueStats *stats)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    radixSort64(keys, sortScratch);
+
+    // 整块重新指定数据存储，驱动可以为仍在使用旧内容的绘制保留旧存储而不必等待
+    GLsizeiptr bytes = static_cast<GLsizeiptr>(drawDataCount) * drawDataStride;
+    if (bytes > 0)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+        if (bytes > bufferCapacity)
+        {
+            bufferCapacity = std::max(bytes, bufferCapacity * 2);
+            MemoryTracker::getInstance().trackGpu(GpuResourceKind::Buffer, uniformBuffer, bufferCapacity,
+                                                  "RenderQueue");
+        }
+        glBufferData(GL_UNIFORM_BUFFER, bufferCapacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, bytes, drawData.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    stats->buildMs += elapsed.count();
+    stats->uniformBytes += bytes;
+    stats->queued = true;
+}
+
+void RenderQueue::submit(Pass pass, int threads, RenderQueueStats *stats)
+{
+    // 键按通道排在最高位，二分查找该通道的连续区间
+    const uint64_t first = static_cast<uint64_t>(pass) << passShift;
+    const uint64_t last = static_cast<uint64_t>(pass + 1) << passShift;
+    auto begin = std::lower_bound(keys.begin(), keys.end(), first);
+    auto end = std::lower_bound(begin, keys.end(), last);
+    if (begin == end)
+    {
+        return;
+    }
+    if (threads > 0)
+    {
+        submitRecorded(&*begin, &*begin + (end - begin), threads, stats);
+        return;
+    }
+
+    const TextureManager &textures = TextureManager::getInstance();
+    const uint32_t materialCount = static_cast<uint32_t>(textures.getMaterialCount());
+    uint32_t currentProgram = UINT32_MAX;
+    GLuint currentVertexArray = 0;
+    int currentMaterial = -1;
+    for (auto it = begin; it != end; ++it)
+    {
+        const uint64_t key = *it;
+        const uint32_t programSlot = static_cast<uint32_t>(key >> programShift) & ((1u << programBits) - 1);
+        const uint32_t meshSlot = static_cast<uint32_t>(key >> meshShift) & ((1u << meshBits) - 1);
+        const DrawItem &item = items[static_cast<uint32_t>(key >> itemShift)];
+        const ProgramSlot &program = programs[programSlot];
+
+        // 每个程序的相机和时间uniform只在切换到该程序时设置一次
+        if (programSlot != currentProgram)
+        {
+            currentProgram = programSlot;
+            currentMaterial = -1;
+            glUseProgram(program.program);
+            ++stats->programBinds;
+            if (program.viewLocation != -1)
+            {
+                glUniformMatrix4fv(program.viewLocation, 1, GL_FALSE, glm::value_ptr(frameView));
+                ++stats->uniformCalls;
+            }
+            if (program.projectionLocation != -1)
+            {
+                glUniformMatrix4fv(program.projectionLocation, 1, GL_FALSE, glm::value_ptr(frameProjection));
+                ++stats->uniformCalls;
+            }
+            if (program.timeLocation != -1)
+            {
+                glUniform1f(program.timeLocation, frameTime);
+                ++stats->uniformCalls;
+            }
+        }
+        const MeshSlot &mesh = meshes[meshSlot];
+        if (mesh.vao != currentVertexArray)
+        {
+            currentVertexArray = mesh.vao;
+            glBindVertexArray(mesh.vao);
+            ++stats->vaoBinds;
+        }
+        if (program.textured && item.material % static_cast<int>(materialCount) != currentMaterial)
+        {
+            currentMaterial = item.material % static_cast<int>(materialCount);
+            textures.bind(currentMaterial);
+            ++stats->textureBinds;
+        }
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, Shader::drawDataBinding, uniformBuffer,
+                          static_cast<GLintptr>(item.drawData) * drawDataStride, drawDataSize);
+        ++stats->bufferRangeBinds;
+        GeometryArena::drawRange(mesh.indexCount, mesh.firstIndex, mesh.baseVertex);
+        ++stats->draws;
+    }
+    glBindVertexArray(0);
+}
+
+void RenderQueue::submitRecorded(const uint64_t *begin, const uint64_t *end, int threads, RenderQueueStats *stats)
+{
+    auto start = std::chrono::steady_clock::now();
+    CommandRecorder &recorder = CommandRecorder::getInstance();
+    recorder.setThreadCount(threads);
+
+    const size_t count = static_cast<size_t>(end - begin);
+    const int segments = static_cast<int>(std::max<size_t>(1, std::min<size_t>(threads, count / minSegmentDraws)));
+    if (commandLists.size() < static_cast<size_t>(segments) + 1)
+    {
+        commandLists.resize(static_cast<size_t>(segments) + 1);
+    }
+
+    // 相机和时间uniform保存在程序对象中，每帧在第一个通道之前为所有程序设置一次，各段只需绑定程序
+    CommandList &prologue = commandLists[0];
+    prologue.clear();
+    if (!frameUniformsRecorded)
+    {
+        frameUniformsRecorded = true;
+        for (const ProgramSlot &program : programs)
+        {
+            prologue.bindProgram(program.program);
+            if (program.viewLocation != -1)
+            {
+                prologue.setUniformMat4(program.viewLocation, frameView);
+            }
+            if (program.projectionLocation != -1)
+            {
+                prologue.setUniformMat4(program.projectionLocation, frameProjection);
+            }
+            if (program.timeLocation != -1)
+            {
+                prologue.setUniform1f(program.timeLocation, frameTime);
+            }
+        }
+    }
+
+    RecordJob job = {this, begin, count, segments};
+    recorder.run(segments, &RenderQueue::recordSegment, &job);
+    auto recorded = std::chrono::steady_clock::now();
+
+    for (int i = 0; i <= segments; ++i)
+    {
+        const CommandList &list = commandLists[i];
+        list.replay();
+        stats->programBinds += list.getCount(CommandOp::BindProgram);
+        stats->vaoBinds += list.getCount(CommandOp::BindVertexArray);
+        stats->textureBinds += list.getCount(CommandOp::BindTexture);
+        stats->bufferRangeBinds += list.getCount(CommandOp::BindUniformRange);
+        stats->uniformCalls += list.getCount(CommandOp::SetUniformMat4) + list.getCount(CommandOp::SetUniform1f);
+        stats->draws += list.getCount(CommandOp::DrawElements);
+        stats->commands += static_cast<long long>(list.size());
+        stats->commandBytes += static_cast<long long>(list.getBytes());
+    }
+    glBindVertexArray(0);
+
+    auto finished = std::chrono::steady_clock::now();
+    stats->recordThreads = recorder.getThreadCount();
+    stats->commandLists += segments + (prologue.size() > 0 ? 1 : 0);
+    stats->recordMs += std::chrono::duration<double, std::milli>(recorded - start).count();
+    stats->replayMs += std::chrono::duration<double, std::milli>(finished - recorded).count();
+}
+
+void RenderQueue::recordSegment(void *context, int index)
+{
+    const RecordJob &job = *static_cast<const RecordJob *>(context);
+    size_t first = job.count * static_cast<size_t>(index) / static_cast<size_t>(job.segments);
+    size_t last = job.count * static_cast<size_t>(index + 1) / static_cast<size_t>(job.segments);
+    CommandList &list = job.queue->commandLists[static_cast<size_t>(index) + 1];
+    list.clear();
+    job.queue->recordRange(job.keys + first, job.keys + last, &list);
+}
+
+void RenderQueue::recordRange(const uint64_t *begin, const uint64_t *end, CommandList *list) const
+{
+    const TextureManager &textures = TextureManager::getInstance();
+    const uint32_t materialCount = static_cast<uint32_t>(textures.getMaterialCount());
+    uint32_t currentProgram = UINT32_MAX;
+    GLuint currentVertexArray = 0;
+    int currentMaterial = -1;
+    for (const uint64_t *it = begin; it != end; ++it)
+    {
+        const uint64_t key = *it;
+        const uint32_t programSlot = static_cast<uint32_t>(key >> programShift) & ((1u << programBits) - 1);
+        const uint32_t meshSlot = static_cast<uint32_t>(key >> meshShift) & ((1u << meshBits) - 1);
+        const DrawItem &item = items[static_cast<uint32_t>(key >> itemShift)];
+        const ProgramSlot &program = programs[programSlot];
+
+        if (programSlot != currentProgram)
+        {
+            currentProgram = programSlot;
+            currentMaterial = -1;
+            list->bindProgram(program.program);
+        }
+        const MeshSlot &mesh = meshes[meshSlot];
+        if (mesh.vao != currentVertexArray)
+        {
+            currentVertexArray = mesh.vao;
+            list->bindVertexArray(mesh.vao);
+        }
+        if (program.textured && item.material % static_cast<int>(materialCount) != currentMaterial)
+        {
+            currentMaterial = item.material % static_cast<int>(materialCount);
+            list->bindTexture(0, textures.getTexture(currentMaterial));
+        }
+
+        list->bindUniformRange(Shader::drawDataBinding, uniformBuffer,
+                               static_cast<uint32_t>(item.drawData * drawDataStride), drawDataSize);
+        list->drawElements(mesh.firstIndex, static_cast<uint32_t>(mesh.indexCount), mesh.baseVertex);
+    }
+}
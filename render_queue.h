@@ -0,0 +1,238 @@
+/**
+ * @file render_queue.h
+ * @brief 渲染队列头文件
+ * @details 定义了按64位打包键排序的绘制队列：每次绘制由（通道、程序、网格、深度）键和
+ * 共享uniform缓冲区中的偏移描述，排序后按程序和VAO分段提交，统计每帧的状态切换。
+ * 提交时可以把排好序的绘制分段交给多个线程录制成命令列表，再在GL线程上按顺序回放
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "command_list.h"
+
+/**
+ * @struct RenderQueueStats
+ * @brief 一帧场景绘制的状态切换统计
+ * @details 直接提交和渲染队列两种路径都填写这份统计，便于对比
+ */
+struct RenderQueueStats
+{
+    bool queued = false;       // 最近一帧是否经由渲染队列提交
+    int draws = 0;             // 绘制调用数
+    int programBinds = 0;      // glUseProgram次数
+    int vaoBinds = 0;          // glBindVertexArray次数
+    int uniformCalls = 0;      // glUniform*次数
+    int bufferRangeBinds = 0;  // glBindBufferRange次数
+    int textureBinds = 0;      // 材质纹理绑定次数
+    double buildMs = 0.0;      // 填充队列、排序和上传uniform缓冲区的CPU耗时
+    long long uniformBytes = 0; // 本帧上传的逐绘制uniform字节数
+    int recordThreads = 0;     // 录制命令列表的线程数，0表示直接提交
+    int commandLists = 0;      // 本帧回放的命令列表数
+    long long commands = 0;    // 本帧回放的命令数
+    long long commandBytes = 0; // 命令列表占用的字节数
+    double recordMs = 0.0;     // 并行录制命令列表的墙钟耗时
+    double replayMs = 0.0;     // GL线程回放命令列表的CPU耗时
+};
+
+/**
+ * @class RenderQueue
+ * @brief 排序渲染队列
+ * @details 排序键从高到低为：通道(2位)、程序槽(8位)、网格槽(6位)、量化深度(16位)、
+ * 绘制项索引(32位)。基数排序后同一通道内的绘制按程序、再按VAO聚集，每个程序只绑定一次，
+ * 每个程序的相机和时间uniform也只设置一次。逐绘制的model矩阵预先写入一个uniform缓冲区，
+ * 绘制时只需glBindBufferRange切换偏移
+ */
+class RenderQueue
+{
+public:
+    /**
+     * @enum Pass
+     * @brief 绘制通道，按数值顺序提交
+     */
+    enum Pass : uint32_t
+    {
+        PassDepth = 0,    // 深度预通道
+        PassOpaque = 1,   // 不透明着色通道
+        PassOverdraw = 2  // 过度绘制计数通道
+    };
+
+    static constexpr int programBits = 8; // 程序槽位数
+    static constexpr int meshBits = 6;    // 网格槽位数
+    static constexpr int depthBits = 16;  // 量化深度位数
+
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    // 缓冲区对象属于GL上下文，禁止拷贝
+    RenderQueue(const RenderQueue &) = delete;
+    RenderQueue &operator=(const RenderQueue &) = delete;
+
+    /**
+     * @brief 创建uniform缓冲区并读取偏移对齐要求
+     * @details 需要在GL上下文创建之后调用
+     */
+    void init();
+
+    /**
+     * @brief 删除uniform缓冲区
+     */
+    void cleanup();
+
+    /**
+     * @brief 清空队列，开始记录新的一帧
+     * @param view 视图矩阵
+     * @param projection 投影矩阵
+     * @param time 动画时间
+     */
+    void begin(const glm::mat4 &view, const glm::mat4 &projection, float time);
+
+    /**
+     * @brief 登记本帧使用的程序
+     * @param program DrawData变体着色器程序
+     * @return uint32_t 写入排序键的程序槽
+     */
+    uint32_t addProgram(GLuint program);
+
+    /**
+     * @brief 登记本帧使用的网格
+     * @param vao 顶点数组对象，已绑定共享索引缓冲区
+     * @param indexCount 索引数
+     * @param firstIndex 第一个索引的序号
+     * @param baseVertex 基顶点
+     * @return uint32_t 写入排序键的网格槽
+     * @details 用glDrawElementsBaseVertex绘制；共用一个VAO的网格相邻时不重复绑定
+     */
+    uint32_t addMesh(GLuint vao, GLsizei indexCount, GLuint firstIndex, GLint baseVertex);
+
+    /**
+     * @brief 写入一份逐绘制数据
+     * @param model 模型矩阵
+     * @return uint32_t 数据在uniform缓冲区中的序号，同一实例的多个通道可以共享
+     */
+    uint32_t addDrawData(const glm::mat4 &model);
+
+    /**
+     * @brief 添加一次绘制
+     * @param pass 绘制通道
+     * @param program addProgram返回的程序槽
+     * @param mesh addMesh返回的网格槽
+     * @param depth 归一化视空间深度（0为近平面），不需要按深度排序时传0
+     * @param drawData addDrawData返回的序号
+     * @param material 材质索引，程序使用diffuseTexture时按它绑定纹理
+     */
+    void push(Pass pass, uint32_t program, uint32_t mesh, float depth, uint32_t drawData, int material);
+
+    /**
+     * @brief 对所有绘制排序并上传逐绘制数据
+     * @param stats 累加上传字节数的统计
+     */
+    void finish(RenderQueueStats *stats);
+
+    /**
+     * @brief 提交一个通道的所有绘制
+     * @param pass 绘制通道
+     * @param threads 录制命令列表的线程数，0表示在GL线程上边遍历边调用GL
+     * @param stats 累加状态切换次数的统计
+     * @details 要求已调用finish，提交后解绑VAO，当前程序保持为最后一个程序。
+     * threads大于0时通道内的绘制按顺序切成若干段，每段由一个线程录制成命令列表，
+     * 每段开头重新绑定程序、VAO和纹理，之后GL线程按段的顺序回放，绘制顺序与直接提交相同
+     */
+    void submit(Pass pass, int threads, RenderQueueStats *stats);
+
+    /**
+     * @brief 获取队列中的绘制数
+     * @return size_t 所有通道的绘制数之和
+     */
+    size_t size() const { return keys.size(); }
+
+private:
+    /**
+     * @struct ProgramSlot
+     * @brief 登记的程序和其每帧uniform的位置
+     */
+    struct ProgramSlot
+    {
+        GLuint program;          // 着色器程序
+        GLint viewLocation;       // view uniform位置
+        GLint projectionLocation; // projection uniform位置
+        GLint timeLocation;       // time uniform位置
+        bool textured;            // 是否采样材质纹理
+    };
+
+    /**
+     * @struct MeshSlot
+     * @brief 登记的网格
+     */
+    struct MeshSlot
+    {
+        GLuint vao;          // 顶点数组对象
+        GLsizei indexCount;  // 索引数
+        GLuint firstIndex;   // 第一个索引的序号
+        GLint baseVertex;    // 基顶点
+    };
+
+    /**
+     * @struct RecordJob
+     * @brief 一次并行录制的参数，作为任务上下文传给录制线程
+     */
+    struct RecordJob
+    {
+        RenderQueue *queue;   // 所属队列
+        const uint64_t *keys; // 本通道第一个排序键
+        size_t count;         // 本通道的绘制数
+        int segments;         // 分段数
+    };
+
+    /**
+     * @brief 录制一段绘制，供CommandRecorder调用
+     * @param context 指向RecordJob
+     * @param index 段序号，写入commandLists[index + 1]
+     */
+    static void recordSegment(void *context, int index);
+
+    /**
+     * @brief 把一段排序键翻译成命令
+     * @param begin 第一个键
+     * @param end 最后一个键之后
+     * @param list 输出的命令列表
+     * @details 只读取队列内容，可以在多个线程上同时调用
+     */
+    void recordRange(const uint64_t *begin, const uint64_t *end, CommandList *list) const;
+
+    /**
+     * @brief 录制并回放一个通道的绘制
+     */
+    void submitRecorded(const uint64_t *begin, const uint64_t *end, int threads, RenderQueueStats *stats);
+
+    /**
+     * @struct DrawItem
+     * @brief 排序键低32位指向的绘制项
+     */
+    struct DrawItem
+    {
+        uint32_t drawData; // 逐绘制数据序号
+        int material;      // 材质索引
+    };
+
+    GLuint uniformBuffer = 0;          // 逐绘制uniform缓冲区
+    GLsizeiptr bufferCapacity = 0;     // uniform缓冲区当前容量
+    GLsizeiptr drawDataStride = 256;   // 相邻两份逐绘制数据的间距（满足偏移对齐）
+
+    glm::mat4 frameView = glm::mat4(1.0f);       // 本帧视图矩阵
+    glm::mat4 frameProjection = glm::mat4(1.0f); // 本帧投影矩阵
+    float frameTime = 0.0f;                      // 本帧动画时间
+
+    std::vector<ProgramSlot> programs; // 本帧登记的程序
+    std::vector<MeshSlot> meshes;      // 本帧登记的网格
+    std::vector<DrawItem> items;       // 绘制项
+    std::vector<uint64_t> keys;        // 排序键
+    std::vector<uint64_t> sortScratch; // 基数排序临时缓冲区
+    std::vector<uint8_t> drawData;     // 按drawDataStride排列的逐绘制数据，容量在帧之间复用
+    uint32_t drawDataCount = 0;        // 本帧写入的逐绘制数据份数
+    bool frameUniformsRecorded = false; // 本帧是否已为所有程序录制相机和时间uniform
+
+    std::vector<CommandList> commandLists; // 第0个为设置每帧uniform的前导列表，其余每段一个，容量在帧之间复用
+};
@@ -0,0 +1,590 @@
+#include "render_server.h"
+#include "camera.h"
+#include "frame_arena.h"
+#include "gl_trace.h"
+#include "memory_tracker.h"
+#include "render_graph.h"
+#include "scene.h"
+#include "shader.h"
+#include "texture_manager.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    /**
+     * @brief 取已排序数组的分位数
+     */
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+}
+
+bool RenderServer::run(GLFWwindow *window, const std::string &socketPath)
+{
+    this->window = window;
+    if (!openSocket(socketPath))
+    {
+        return false;
+    }
+
+    std::cout << "[server] listening on " << socketPath << std::endl;
+    startTime = std::chrono::steady_clock::now();
+    stopping = false;
+
+    while (!glfwWindowShouldClose(window))
+    {
+        // 有请求排队时只检查一次套接字，把已经到达的请求并入本批
+        pollSockets(pending.empty() ? idlePollMs : 0);
+        if (!pending.empty())
+        {
+            renderBatch();
+        }
+        else if (stopping && std::none_of(clients.begin(), clients.end(),
+                                          [](const Client &client) { return client.getQueuedOutput() > 0; }))
+        {
+            // quit之后等剩余回复发完再退出
+            break;
+        }
+        glfwPollEvents();
+    }
+
+    printSummary(std::cout);
+    shutdown();
+    return true;
+}
+
+bool RenderServer::openSocket(const std::string &path)
+{
+    sockaddr_un address = {};
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Invalid socket path: " << path << std::endl;
+        return false;
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+    {
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // 上次异常退出留下的套接字文件会使bind失败
+    unlink(path.c_str());
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(listenFd, 16) < 0)
+    {
+        std::cerr << "Failed to listen on " << path << ": " << std::strerror(errno) << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+    socketPath = path;
+    return true;
+}
+
+void RenderServer::pollSockets(int timeoutMs)
+{
+    std::vector<pollfd> fds;
+    fds.reserve(clients.size() + 1);
+    fds.push_back({listenFd, POLLIN, 0});
+    for (const Client &client : clients)
+    {
+        // 输出队列过长时不再读取新请求，等客户端取走回复
+        short events = client.getQueuedOutput() < maxQueuedOutputBytes ? POLLIN : 0;
+        if (client.getQueuedOutput() > 0)
+        {
+            events |= POLLOUT;
+        }
+        fds.push_back({client.fd, events, 0});
+    }
+
+    if (poll(fds.data(), fds.size(), timeoutMs) <= 0)
+    {
+        return;
+    }
+
+    // 先处理已有客户端，新连接追加在末尾，不影响下标对应关系
+    for (size_t i = 1; i < fds.size(); ++i)
+    {
+        Client &client = clients[i - 1];
+        if (fds[i].revents & POLLOUT)
+        {
+            flushClient(client);
+        }
+        if (client.fd < 0 || (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+        {
+            continue;
+        }
+
+        char buffer[4096];
+        ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            closeClient(client.id);
+            continue;
+        }
+
+        client.input.append(buffer, static_cast<size_t>(received));
+        size_t lineEnd = 0;
+        while (client.fd >= 0 && (lineEnd = client.input.find('\n')) != std::string::npos)
+        {
+            std::string line = client.input.substr(0, lineEnd);
+            client.input.erase(0, lineEnd + 1);
+            handleLine(client, line);
+        }
+        if (client.fd >= 0 && client.input.size() > maxLineBytes)
+        {
+            std::cerr << "[server] dropping client " << client.id << ": line exceeds " << maxLineBytes << " bytes"
+                      << std::endl;
+            closeClient(client.id);
+        }
+    }
+    // 遍历期间断开的客户端只标记，在这里统一移除
+    clients.erase(std::remove_if(clients.begin(), clients.end(), [](const Client &client) { return client.fd < 0; }),
+                  clients.end());
+
+    if (fds[0].revents & POLLIN)
+    {
+        int fd = -1;
+        while ((fd = accept(listenFd, nullptr, nullptr)) >= 0)
+        {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            Client client;
+            client.id = nextClientId++;
+            client.fd = fd;
+            clients.push_back(std::move(client));
+        }
+    }
+}
+
+void RenderServer::handleLine(Client &client, const std::string &line)
+{
+    std::istringstream input(line);
+    std::string command;
+    input >> command;
+
+    if (command == "quit")
+    {
+        stopping = true;
+        return;
+    }
+    if (command == "stats")
+    {
+        RenderServerStats current = getStats();
+        std::ostringstream out;
+        out << "stats {\"requests\": " << current.requests << ", \"completed\": " << current.completed
+            << ", \"rejected\": " << current.rejected << ", \"batches\": " << current.batches
+            << ", \"images_per_second\": " << current.imagesPerSecond
+            << ", \"latency_ms\": {\"mean\": " << current.latencyMsMean << ", \"p50\": " << current.latencyMsP50
+            << ", \"p95\": " << current.latencyMsP95 << ", \"p99\": " << current.latencyMsP99
+            << ", \"max\": " << current.latencyMsMax << "}}\n";
+        std::string reply = out.str();
+        sendTo(client.id, reply.data(), reply.size());
+        return;
+    }
+    if (command != "render")
+    {
+        std::string reply = "error - unknown command\n";
+        sendTo(client.id, reply.data(), reply.size());
+        return;
+    }
+
+    Request request;
+    request.client = client.id;
+    request.received = std::chrono::steady_clock::now();
+    std::string vertex;
+    std::string fragment;
+    std::string resolution;
+    input >> request.id >> vertex >> fragment >> request.rotationX >> request.rotationY >> request.distance >>
+        request.time >> resolution;
+
+    const char *error = nullptr;
+    request.vertexShader = Shader::findVertexShaderIndex(vertex);
+    request.fragmentShader = Shader::findFragmentShaderIndex(fragment);
+    bool sized = std::sscanf(resolution.c_str(), "%dx%d", &request.width, &request.height) == 2;
+    if (input.fail() || !sized)
+    {
+        error = "expected: render <id> <vertex> <fragment> <rotX> <rotY> <distance> <time> <w>x<h>";
+    }
+    else if (request.vertexShader < 0 || request.fragmentShader < 0)
+    {
+        error = "unknown shader";
+    }
+    else if (Shader::getInstance().getProgram(request.vertexShader, request.fragmentShader) == 0)
+    {
+        error = "shader program unavailable";
+    }
+    else if (request.width <= 0 || request.height <= 0 || request.width > maxImageSize || request.height > maxImageSize)
+    {
+        error = "resolution out of range";
+    }
+
+    if (error != nullptr)
+    {
+        ++stats.rejected;
+        std::string reply = "error " + (request.id.empty() ? std::string("-") : request.id) + " " + error + "\n";
+        sendTo(client.id, reply.data(), reply.size());
+        return;
+    }
+
+    ++stats.requests;
+    pending.push_back(request);
+}
+
+void RenderServer::renderBatch()
+{
+    // 按到达顺序取出一批，批内按分辨率和程序排序，相同目标尺寸和程序的请求相邻
+    size_t count = std::min(pending.size(), static_cast<size_t>(maxBatchRequests));
+    batch.assign(pending.begin(), pending.begin() + count);
+    pending.erase(pending.begin(), pending.begin() + count);
+    std::stable_sort(batch.begin(), batch.end(), [](const Request &a, const Request &b)
+                     {
+                         if (a.width != b.width || a.height != b.height)
+                         {
+                             return a.width != b.width ? a.width < b.width : a.height < b.height;
+                         }
+                         return a.vertexShader != b.vertexShader ? a.vertexShader < b.vertexShader
+                                                                 : a.fragmentShader < b.fragmentShader;
+                     });
+
+    // 材质纹理在批次之间继续流式上传
+    TextureManager::getInstance().update();
+
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        if (i > 0)
+        {
+            const Request &previous = batch[i - 1];
+            stats.resolutionSwitches += previous.width != batch[i].width || previous.height != batch[i].height;
+            stats.programSwitches += previous.vertexShader != batch[i].vertexShader ||
+                                     previous.fragmentShader != batch[i].fragmentShader;
+        }
+        renderRequest(batch[i]);
+    }
+
+    // 按提交顺序取回剩余的结果
+    for (int i = 0; i < readbackSlots; ++i)
+    {
+        ReadbackSlot &slot = slots[(nextSlot + i) % readbackSlots];
+        if (slot.fence != nullptr)
+        {
+            completeSlot(slot);
+        }
+    }
+
+    ++stats.batches;
+    GlTrace::getInstance().endFrame();
+}
+
+void RenderServer::renderRequest(const Request &request)
+{
+    // 槽仍在使用时先取回其中较早的请求，此时GPU已经在处理之后的请求
+    ReadbackSlot &slot = slots[nextSlot];
+    nextSlot = (nextSlot + 1) % readbackSlots;
+    if (slot.fence != nullptr)
+    {
+        completeSlot(slot);
+    }
+
+    const size_t bytes = static_cast<size_t>(request.width) * request.height * 4;
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    if (slot.buffer == 0)
+    {
+        glGenBuffers(1, &slot.buffer);
+    }
+    if (slot.capacity < bytes)
+    {
+        if (slot.capacity > 0)
+        {
+            tracker.untrackGpu(GpuResourceKind::Buffer, slot.buffer);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.capacity = bytes;
+        tracker.trackGpu(GpuResourceKind::Buffer, slot.buffer, static_cast<long long>(bytes), "RenderServer");
+    }
+
+    Camera &camera = Camera::getInstance();
+    camera.setRotation(request.rotationX, request.rotationY);
+    camera.setCameraDistance(request.distance);
+    camera.setViewportSize(request.width, request.height);
+
+    // 同一分辨率的请求复用渲染图缓存的渲染目标
+    RenderGraph &graph = RenderGraph::getInstance();
+    graph.beginFrame();
+    RGHandle color = graph.createResource("ServerColor", {request.width, request.height, GL_RGBA8, 0});
+    RGHandle depth = graph.createResource("ServerDepth", {request.width, request.height, GL_DEPTH24_STENCIL8, 0});
+    graph.addPass(
+        "ServerScene",
+        [&](RenderGraph::Builder &builder)
+        {
+            builder.writeColor(color);
+            builder.writeDepth(depth);
+            builder.setSideEffect();
+        },
+        [&request, &slot]()
+        {
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            Scene::getInstance().render(request.vertexShader, request.fragmentShader, request.time,
+                                        request.width * request.height);
+
+            // 读入像素缓冲区，glReadPixels立即返回，完成时栅栏发出信号
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            glReadPixels(0, 0, request.width, request.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        });
+    graph.compile();
+    graph.execute();
+    slot.request = request;
+
+    FrameArena::forThread().reset();
+}
+
+void RenderServer::completeSlot(ReadbackSlot &slot)
+{
+    auto waitStart = std::chrono::steady_clock::now();
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (status == GL_TIMEOUT_EXPIRED)
+    {
+        status = glClientWaitSync(slot.fence, 0, 1000000);
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - waitStart;
+    stats.readbackWaitMs += waited.count();
+
+    const Request &request = slot.request;
+    if (status == GL_WAIT_FAILED || findClient(request.client) == nullptr)
+    {
+        return;
+    }
+
+    const size_t bytes = static_cast<size_t>(request.width) * request.height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT);
+    if (pixels != nullptr)
+    {
+        // 套接字可写时直接从映射的缓冲区发送，发不完的部分复制到输出队列
+        std::string header = "image " + request.id + " " + std::to_string(request.width) + " " +
+                             std::to_string(request.height) + " " + std::to_string(bytes) + "\n";
+        if (sendTo(request.client, header.data(), header.size()) && sendTo(request.client, pixels, bytes))
+        {
+            stats.readbackBytes += static_cast<long long>(bytes);
+            // 图像可能还在输出队列中，发送完毕时再记录延迟
+            Client *client = findClient(request.client);
+            if (client != nullptr && client->getQueuedOutput() > 0)
+            {
+                client->images.emplace_back(client->queuedBytes, request.received);
+            }
+            else
+            {
+                std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - request.received;
+                latencies.push_back(latency.count());
+                ++stats.completed;
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+bool RenderServer::sendTo(uint64_t clientId, const void *data, size_t bytes)
+{
+    Client *client = findClient(clientId);
+    if (client == nullptr)
+    {
+        return false;
+    }
+
+    // 队列为空时先直接发送，只把剩余部分放入队列
+    const char *cursor = static_cast<const char *>(data);
+    client->queuedBytes += bytes;
+    while (client->getQueuedOutput() == 0 && bytes > 0)
+    {
+        ssize_t sent = send(client->fd, cursor, bytes, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if (sent <= 0)
+        {
+            closeClient(clientId);
+            return false;
+        }
+        cursor += sent;
+        bytes -= static_cast<size_t>(sent);
+        client->sentBytes += static_cast<uint64_t>(sent);
+    }
+    client->output.append(cursor, bytes);
+    return true;
+}
+
+void RenderServer::flushClient(Client &client)
+{
+    while (client.getQueuedOutput() > 0)
+    {
+        ssize_t sent = send(client.fd, client.output.data() + client.outputOffset, client.getQueuedOutput(),
+                            MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if (sent <= 0)
+        {
+            closeClient(client.id);
+            return;
+        }
+        client.outputOffset += static_cast<size_t>(sent);
+        client.sentBytes += static_cast<uint64_t>(sent);
+    }
+
+    // 已发送的部分超过一半时才移动剩余数据，避免每次发送都搬移整个队列
+    if (client.outputOffset == client.output.size())
+    {
+        client.output.clear();
+        client.outputOffset = 0;
+    }
+    else if (client.outputOffset > client.output.size() / 2)
+    {
+        client.output.erase(0, client.outputOffset);
+        client.outputOffset = 0;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    while (!client.images.empty() && client.images.front().first <= client.sentBytes)
+    {
+        std::chrono::duration<double, std::milli> latency = now - client.images.front().second;
+        latencies.push_back(latency.count());
+        ++stats.completed;
+        client.images.pop_front();
+    }
+}
+
+RenderServer::Client *RenderServer::findClient(uint64_t clientId)
+{
+    for (Client &client : clients)
+    {
+        if (client.id == clientId && client.fd >= 0)
+        {
+            return &client;
+        }
+    }
+    return nullptr;
+}
+
+void RenderServer::closeClient(uint64_t clientId)
+{
+    Client *client = findClient(clientId);
+    if (client != nullptr)
+    {
+        close(client->fd);
+        client->fd = -1;
+    }
+}
+
+void RenderServer::shutdown()
+{
+    for (Client &client : clients)
+    {
+        if (client.fd >= 0)
+        {
+            close(client.fd);
+        }
+    }
+    clients.clear();
+    pending.clear();
+
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        listenFd = -1;
+        unlink(socketPath.c_str());
+    }
+
+    for (ReadbackSlot &slot : slots)
+    {
+        if (slot.fence != nullptr)
+        {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (slot.buffer != 0)
+        {
+            MemoryTracker::getInstance().untrackGpu(GpuResourceKind::Buffer, slot.buffer);
+            glDeleteBuffers(1, &slot.buffer);
+            slot.buffer = 0;
+            slot.capacity = 0;
+        }
+    }
+}
+
+RenderServerStats RenderServer::getStats() const
+{
+    RenderServerStats current = stats;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    current.elapsedSeconds = elapsed.count();
+    current.imagesPerSecond = current.elapsedSeconds > 0.0 ? current.completed / current.elapsedSeconds : 0.0;
+
+    std::vector<double> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double ms : sorted)
+    {
+        sum += ms;
+    }
+    current.latencyMsMean = sorted.empty() ? 0.0 : sum / sorted.size();
+    current.latencyMsP50 = percentile(sorted, 50.0);
+    current.latencyMsP95 = percentile(sorted, 95.0);
+    current.latencyMsP99 = percentile(sorted, 99.0);
+    current.latencyMsMax = sorted.empty() ? 0.0 : sorted.back();
+    return current;
+}
+
+void RenderServer::printSummary(std::ostream &out) const
+{
+    RenderServerStats current = getStats();
+    out << "[server] requests=" << current.requests << " completed=" << current.completed
+        << " rejected=" << current.rejected << " batches=" << current.batches
+        << " mean_batch=" << (current.batches > 0 ? static_cast<double>(current.requests) / current.batches : 0.0)
+        << "\n[server] throughput=" << current.imagesPerSecond << " images/s over " << current.elapsedSeconds << "s"
+        << " readback=" << current.readbackBytes / (1024 * 1024) << "MB"
+        << " readback_wait=" << current.readbackWaitMs << "ms"
+        << "\n[server] latency mean=" << current.latencyMsMean << "ms p50=" << current.latencyMsP50
+        << "ms p95=" << current.latencyMsP95 << "ms p99=" << current.latencyMsP99 << "ms max=" << current.latencyMsMax
+        << "ms\n[server] program_switches=" << current.programSwitches
+        << " resolution_switches=" << current.resolutionSwitches << std::endl;
+}
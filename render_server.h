@@ -0,0 +1,226 @@
+/**
+ * @file render_server.h
+ * @brief 本地渲染服务头文件
+ * @details 定义了通过Unix域套接字接收渲染请求的服务模式：GL上下文、已编译的着色器程序和缓冲区常驻，
+ * 待处理的请求按分辨率和着色器程序分批渲染到离屏目标，经像素缓冲区环异步读回后返回图像
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct RenderServerStats
+ * @brief 渲染服务的吞吐量和延迟统计
+ */
+struct RenderServerStats
+{
+    long long requests = 0;          // 收到的有效请求数
+    long long completed = 0;         // 已返回图像的请求数
+    long long rejected = 0;          // 参数无效而返回错误的请求数
+    long long batches = 0;           // 批次数
+    long long programSwitches = 0;   // 批内相邻请求切换着色器程序的次数
+    long long resolutionSwitches = 0; // 批内相邻请求切换分辨率的次数
+    double elapsedSeconds = 0.0;     // 从开始监听到现在的时间（秒）
+    double imagesPerSecond = 0.0;    // 吞吐量
+    double latencyMsMean = 0.0;      // 从收到请求到图像发送完毕的平均延迟（毫秒）
+    double latencyMsP50 = 0.0;       // 延迟中位数（毫秒）
+    double latencyMsP95 = 0.0;       // 延迟p95（毫秒）
+    double latencyMsP99 = 0.0;       // 延迟p99（毫秒）
+    double latencyMsMax = 0.0;       // 最大延迟（毫秒）
+    double readbackWaitMs = 0.0;     // 等待读回栅栏的累计时间（毫秒）
+    long long readbackBytes = 0;     // 读回的累计字节数
+};
+
+/**
+ * @class RenderServer
+ * @brief 本地渲染服务，使用单例模式实现
+ * @details 协议为文本行，每行一条命令：
+ * "render <id> <vertex> <fragment> <rotX> <rotY> <distance> <time> <w>x<h>" 请求一张图像，
+ * 成功时返回 "image <id> <w> <h> <bytes>\n" 和紧随其后的RGBA8像素（自下而上逐行），
+ * 失败时返回 "error <id> <message>\n"；"stats" 返回一行JSON统计；"quit" 在处理完剩余请求后停止服务。
+ * 同一批请求按分辨率和程序排序后依次渲染，读回环中的像素缓冲区轮流使用，
+ * 映射第i个请求的结果时GPU仍在渲染之后的请求。
+ * 客户端套接字为非阻塞，回复先追加到各客户端的输出队列，可写时再发送，
+ * 不读取回复的客户端不会阻塞服务；输出队列过长时暂停读取该客户端的新请求
+ */
+class RenderServer
+{
+public:
+    /**
+     * @brief 获取RenderServer单例实例
+     * @return RenderServer& 单例实例的引用
+     */
+    static RenderServer &getInstance()
+    {
+        static RenderServer instance;
+        return instance;
+    }
+
+    /**
+     * @brief 监听套接字并处理请求，直到收到quit或窗口关闭
+     * @param window GLFW窗口指针，服务期间处理其事件
+     * @param socketPath Unix域套接字路径，已存在的同名文件会被删除
+     * @return bool 是否成功监听并正常退出
+     * @details 需要在所有模块初始化之后调用，退出时输出统计
+     */
+    bool run(GLFWwindow *window, const std::string &socketPath);
+
+    /**
+     * @brief 计算当前统计
+     * @return RenderServerStats 吞吐量和延迟分位数
+     */
+    RenderServerStats getStats() const;
+
+    /**
+     * @brief 输出统计摘要
+     * @param out 输出流
+     */
+    void printSummary(std::ostream &out) const;
+
+    static constexpr int readbackSlots = 4;        // 读回环中的像素缓冲区数
+    static constexpr int maxBatchRequests = 64;    // 每批最多处理的请求数
+    static constexpr int maxImageSize = 4096;      // 图像宽高上限
+    static constexpr int idlePollMs = 100;         // 没有待处理请求时等待套接字的时间（毫秒）
+    static constexpr size_t maxLineBytes = 4096;   // 一行命令的长度上限，超过仍没有换行的客户端被断开
+    static constexpr size_t maxQueuedOutputBytes = 64u << 20; // 输出队列超过此长度时暂停读取该客户端
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    RenderServer() = default;
+    ~RenderServer() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    RenderServer(const RenderServer &) = delete;
+    RenderServer &operator=(const RenderServer &) = delete;
+
+    /**
+     * @struct Request
+     * @brief 一个待渲染的请求
+     */
+    struct Request
+    {
+        uint64_t client = 0;       // 发出请求的客户端编号
+        std::string id;            // 客户端给出的请求标识，原样返回
+        int vertexShader = 0;      // 顶点着色器索引
+        int fragmentShader = 0;    // 片段着色器索引
+        float rotationX = 0.0f;    // 绕X轴旋转角度（度）
+        float rotationY = 0.0f;    // 绕Y轴旋转角度（度）
+        float distance = 5.0f;     // 相机距离
+        float time = 0.0f;         // 着色器time值
+        int width = 0;             // 图像宽度
+        int height = 0;            // 图像高度
+        std::chrono::steady_clock::time_point received; // 收到请求的时间
+    };
+
+    /**
+     * @struct Client
+     * @brief 一个已连接的客户端
+     */
+    struct Client
+    {
+        uint64_t id = 0;          // 客户端编号，不随文件描述符复用
+        int fd = -1;              // 套接字，已断开时为-1
+        std::string input;        // 尚未组成完整行的输入
+        std::string output;       // 尚未发送的回复
+        size_t outputOffset = 0;  // output中已发送的字节数
+        uint64_t queuedBytes = 0; // 累计追加到输出队列的字节数
+        uint64_t sentBytes = 0;   // 累计发送的字节数
+        std::deque<std::pair<uint64_t, std::chrono::steady_clock::time_point>> images; // 队列中图像的结束位置和请求到达时间
+
+        size_t getQueuedOutput() const { return output.size() - outputOffset; }
+    };
+
+    /**
+     * @struct ReadbackSlot
+     * @brief 读回环中的一个槽
+     */
+    struct ReadbackSlot
+    {
+        GLuint buffer = 0;       // 像素缓冲区
+        size_t capacity = 0;     // 缓冲区容量（字节）
+        GLsync fence = nullptr;  // 读回命令之后插入的栅栏，为空表示空闲
+        Request request;         // 正在读回的请求
+    };
+
+    /**
+     * @brief 创建并监听套接字
+     */
+    bool openSocket(const std::string &socketPath);
+
+    /**
+     * @brief 等待套接字事件，接受新连接并读取请求
+     * @param timeoutMs 等待时间（毫秒），0表示只检查一次
+     */
+    void pollSockets(int timeoutMs);
+
+    /**
+     * @brief 处理一行命令
+     */
+    void handleLine(Client &client, const std::string &line);
+
+    /**
+     * @brief 取出一批待处理请求，按分辨率和程序排序后渲染并读回
+     */
+    void renderBatch();
+
+    /**
+     * @brief 渲染一个请求并把像素读入读回环的下一个槽
+     */
+    void renderRequest(const Request &request);
+
+    /**
+     * @brief 等待槽的栅栏，映射像素缓冲区并把图像发给客户端
+     */
+    void completeSlot(ReadbackSlot &slot);
+
+    /**
+     * @brief 把数据追加到客户端的输出队列并尝试发送
+     * @return bool 客户端是否仍然连接
+     */
+    bool sendTo(uint64_t clientId, const void *data, size_t bytes);
+
+    /**
+     * @brief 在不阻塞的前提下发送客户端输出队列中的数据
+     * @details 发送完一张图像时记录该请求的延迟，发送失败时关闭该客户端
+     */
+    void flushClient(Client &client);
+
+    /**
+     * @brief 查找客户端
+     * @return Client* 已断开时返回nullptr
+     */
+    Client *findClient(uint64_t clientId);
+
+    /**
+     * @brief 关闭客户端连接
+     * @details 只关闭套接字并标记，客户端在pollSockets末尾移除，遍历中的引用保持有效
+     */
+    void closeClient(uint64_t clientId);
+
+    /**
+     * @brief 关闭所有连接，删除套接字文件和像素缓冲区
+     */
+    void shutdown();
+
+    GLFWwindow *window = nullptr;        // 服务期间使用的窗口
+    std::string socketPath;              // 套接字路径
+    int listenFd = -1;                   // 监听套接字
+    bool stopping = false;               // 是否已收到quit
+    uint64_t nextClientId = 1;           // 下一个客户端编号
+    std::vector<Client> clients;         // 已连接的客户端
+    std::vector<Request> pending;        // 待处理的请求，按到达顺序
+    std::vector<Request> batch;          // 当前批次，容量在批次之间复用
+    ReadbackSlot slots[readbackSlots];   // 读回环
+    int nextSlot = 0;                    // 下一个使用的槽
+
+    RenderServerStats stats;             // 累计统计，分位数在getStats中计算
+    std::vector<double> latencies;       // 每个已完成请求的延迟（毫秒）
+    std::chrono::steady_clock::time_point startTime; // 开始监听的时间
+};
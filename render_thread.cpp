@@ -0,0 +1,141 @@
+#include "render_thread.h"
+#include "frame_arena.h"
+#include "gl_trace.h"
+#include <algorithm>
+#include <chrono>
+
+void RenderThread::start(GLFWwindow *window, RenderFunction render)
+{
+    if (running.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    this->window = window;
+    renderFunction = std::move(render);
+    publishedFrames.store(0, std::memory_order_relaxed);
+    fetchedFrames.store(0, std::memory_order_relaxed);
+    droppedFrames.store(0, std::memory_order_relaxed);
+
+    // GL上下文同一时刻只能在一个线程上为当前上下文
+    glfwMakeContextCurrent(nullptr);
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&RenderThread::threadMain, this);
+}
+
+void RenderThread::stop()
+{
+    if (!running.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running.store(false, std::memory_order_release);
+    }
+    wakeRender.notify_one();
+    thread.join();
+
+    glfwMakeContextCurrent(window);
+}
+
+FrameSnapshot &RenderThread::beginSnapshot()
+{
+    // 上一帧快照尚未被取走时等待，避免主线程无节制地领先渲染线程
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wakeMain.wait_for(lock, std::chrono::milliseconds(waitTimeoutMs),
+                      [this]()
+                      {
+                          return fetchedFrames.load(std::memory_order_acquire) >=
+                                 publishedFrames.load(std::memory_order_relaxed);
+                      });
+    return snapshots.writeBuffer();
+}
+
+void RenderThread::publishSnapshot()
+{
+    if (snapshots.publish())
+    {
+        droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        publishedFrames.fetch_add(1, std::memory_order_release);
+    }
+    wakeRender.notify_one();
+}
+
+bool RenderThread::fetchStats(RenderStats *stats)
+{
+    if (!this->stats.fetch())
+    {
+        return false;
+    }
+    *stats = this->stats.readBuffer();
+    return true;
+}
+
+void RenderThread::threadMain()
+{
+    glfwMakeContextCurrent(window);
+
+    RenderStats frameStats;
+    frameStats.renderThread = true;
+    double latencyWindowMax = 0.0;
+    auto windowStart = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeRender.wait(lock,
+                            [this]()
+                            {
+                                return !running.load(std::memory_order_acquire) ||
+                                       fetchedFrames.load(std::memory_order_relaxed) <
+                                           publishedFrames.load(std::memory_order_acquire);
+                            });
+            if (!running.load(std::memory_order_acquire))
+            {
+                break;
+            }
+            // 取走期间可能已发布多帧，被覆盖的帧已由publishSnapshot计入丢弃数
+            fetchedFrames.store(publishedFrames.load(std::memory_order_acquire), std::memory_order_release);
+        }
+        wakeMain.notify_one();
+
+        if (!snapshots.fetch())
+        {
+            continue;
+        }
+        const FrameSnapshot &snapshot = snapshots.readBuffer();
+
+        renderFunction(snapshot, &frameStats);
+        glfwSwapBuffers(window);
+        GlTrace::getInstance().endFrame();
+        // 渲染线程有自己的帧分配器，渲染图和统计的临时数据在交换之后失效
+        FrameArena::forThread().reset();
+
+        // 输入到呈现延迟：从主线程采样输入到交换缓冲区返回
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::milli> latency = now - snapshot.inputTime;
+        frameStats.latencyMs = frameStats.presentedFrames == 0 ? latency.count()
+                                                               : frameStats.latencyMs * 0.9 + latency.count() * 0.1;
+        latencyWindowMax = std::max(latencyWindowMax, latency.count());
+        if (now - windowStart >= std::chrono::seconds(1))
+        {
+            frameStats.latencyMaxMs = latencyWindowMax;
+            latencyWindowMax = 0.0;
+            windowStart = now;
+        }
+        ++frameStats.presentedFrames;
+        frameStats.droppedFrames = droppedFrames.load(std::memory_order_relaxed);
+        frameStats.renderThread = true;
+
+        stats.writeBuffer() = frameStats;
+        stats.publish();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
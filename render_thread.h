@@ -0,0 +1,113 @@
+/**
+ * @file render_thread.h
+ * @brief 渲染线程头文件
+ * @details 定义了拥有GL上下文的专用渲染线程。主线程处理输入和UI并构建帧快照，
+ * 通过无锁三缓冲交给渲染线程提交和呈现，渲染统计经另一组三缓冲回传
+ */
+
+#pragma once
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "frame_snapshot.h"
+#include "triple_buffer.h"
+
+/**
+ * @class RenderThread
+ * @brief 专用渲染线程，使用单例模式实现
+ * @details 快照和统计都通过TripleBuffer传递，双方不共享任何加锁的数据。
+ * 互斥量和条件变量只用于唤醒：渲染线程在没有新快照时休眠，主线程最多领先渲染线程一帧，
+ * 等待超时（例如窗口最小化使交换缓冲区阻塞）时继续发布，未被渲染的旧快照计为丢弃帧
+ */
+class RenderThread
+{
+public:
+    /**
+     * @brief 渲染一帧的回调
+     * @details 在渲染线程上调用，负责提交快照中的渲染命令并填写渲染统计（不含呈现）
+     */
+    using RenderFunction = std::function<void(const FrameSnapshot &, RenderStats *)>;
+
+    /**
+     * @brief 获取RenderThread单例实例
+     * @return RenderThread& 单例实例的引用
+     */
+    static RenderThread &getInstance()
+    {
+        static RenderThread instance;
+        return instance;
+    }
+
+    /**
+     * @brief 启动渲染线程
+     * @param window GLFW窗口指针，其GL上下文转移到渲染线程
+     * @param render 渲染一帧的回调
+     * @details 需在主线程上调用，调用后主线程不再拥有GL上下文
+     */
+    void start(GLFWwindow *window, RenderFunction render);
+
+    /**
+     * @brief 停止渲染线程并等待其退出
+     * @details 渲染线程释放GL上下文后，主线程重新获得上下文，以便清理资源
+     */
+    void stop();
+
+    /**
+     * @brief 渲染线程是否在运行
+     */
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 开始构建下一帧快照
+     * @return FrameSnapshot& 主线程可写入的快照
+     * @details 渲染线程尚未取走上一帧快照时等待，最多等待waitTimeoutMs
+     */
+    FrameSnapshot &beginSnapshot();
+
+    /**
+     * @brief 发布beginSnapshot返回的快照
+     */
+    void publishSnapshot();
+
+    /**
+     * @brief 取得渲染线程最新回传的统计
+     * @param stats 输出的统计，没有新统计时保持不变
+     * @return bool 是否有新统计
+     */
+    bool fetchStats(RenderStats *stats);
+
+    static constexpr int waitTimeoutMs = 50; // 主线程等待渲染线程取走快照的最长时间
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    RenderThread() = default;
+    ~RenderThread() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    RenderThread(const RenderThread &) = delete;
+    RenderThread &operator=(const RenderThread &) = delete;
+
+    /**
+     * @brief 渲染线程主循环
+     */
+    void threadMain();
+
+    GLFWwindow *window = nullptr; // 渲染的窗口
+    RenderFunction renderFunction; // 渲染一帧的回调
+    std::thread thread;            // 渲染线程
+
+    TripleBuffer<FrameSnapshot> snapshots; // 主线程到渲染线程的帧快照
+    TripleBuffer<RenderStats> stats;       // 渲染线程到主线程的统计
+
+    std::mutex wakeMutex;              // 仅用于条件变量等待
+    std::condition_variable wakeRender; // 有新快照或停止时唤醒渲染线程
+    std::condition_variable wakeMain;   // 渲染线程取走快照时唤醒主线程
+
+    std::atomic<bool> running{false};             // 渲染线程是否在运行
+    std::atomic<uint64_t> publishedFrames{0};     // 主线程已发布的快照数
+    std::atomic<uint64_t> fetchedFrames{0};       // 渲染线程已取走的快照数
+    std::atomic<long long> droppedFrames{0};      // 被覆盖而未渲染的快照数
+};
@@ -0,0 +1,849 @@
+#include "scene.h"
+#include "camera.h"
+#include "cube.h"
+#include "shader.h"
+#include "radix_sort.h"
+#include "texture_manager.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // 热力图使用的全屏三角形着色器，按像素坐标读取计数，计数纹理可以大于视口
+    const char *heatmapVertexSource = R"(
+#version 330 core
+void main()
+{
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    // 0层为黑色，之后依次为蓝、青、绿、黄、红，超过6层为白色
+    const char *heatmapFragmentSource = R"(
+#version 330 core
+out vec4 FragColor;
+uniform sampler2D overdrawCount;
+void main()
+{
+    float count = floor(texelFetch(overdrawCount, ivec2(gl_FragCoord.xy), 0).r * 255.0 + 0.5);
+    vec3 ramp[7] = vec3[7](vec3(0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 1.0),
+                           vec3(0.0, 1.0, 0.0), vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0),
+                           vec3(1.0));
+    FragColor = vec4(ramp[int(min(count, 6.0))], 1.0);
+}
+)";
+
+    // 拾取高亮使用的线框着色器，只读取位置属性
+    const char *highlightVertexSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)";
+
+    const char *highlightFragmentSource = R"(
+#version 330 core
+out vec4 FragColor;
+void main()
+{
+    FragColor = vec4(1.0, 0.9, 0.2, 1.0);
+}
+)";
+
+    constexpr int depthKeyBits = 16; // 量化深度的位数
+
+    // 高亮线框相对实例的放大倍数，略大于立方体使线框不与表面重合
+    constexpr float highlightScale = 1.1f;
+
+    // 代理包围盒相对每个实例的半边长：立方体半边长0.5，breathing最多放大1.2倍，
+    // wave在y方向最多偏移0.2，取0.8覆盖所有顶点动画
+    constexpr float proxyHalfExtent = 0.8f;
+}
+
+void Scene::init()
+{
+    heatmapProgram = Shader::getInstance().createProgramFromSource(heatmapVertexSource, heatmapFragmentSource, "Scene");
+    glGenVertexArrays(1, &fullscreenVAO);
+    fragmentQuery.init();
+    drawQueue.init();
+
+    // 单位立方体的8个角（位0、1、2分别选择x、y、z的正负），相差一位的两个角构成一条棱
+    highlightProgram = Shader::getInstance().createProgramFromSource(highlightVertexSource, highlightFragmentSource, "Scene");
+    float corners[8 * 8] = {};
+    std::vector<uint32_t> edges;
+    edges.reserve(24);
+    for (uint32_t corner = 0; corner < 8; ++corner)
+    {
+        float *vertex = corners + corner * 8;
+        vertex[0] = (corner & 1) ? 0.5f : -0.5f;
+        vertex[1] = (corner & 2) ? 0.5f : -0.5f;
+        vertex[2] = (corner & 4) ? 0.5f : -0.5f;
+        for (uint32_t bit = 1; bit < 8; bit <<= 1)
+        {
+            if ((corner & bit) == 0)
+            {
+                edges.push_back(corner);
+                edges.push_back(corner | bit);
+            }
+        }
+    }
+    outlineMesh = GeometryArena::getInstance().createMesh(Cube::format, corners, 8,
+                                                          edges.data(), static_cast<uint32_t>(edges.size()));
+
+    if (instances.empty())
+    {
+        setInstanceCount(1);
+    }
+}
+
+void Scene::cleanup()
+{
+    fragmentQuery.cleanup();
+    drawQueue.cleanup();
+    if (!occlusionQueries.empty())
+    {
+        glDeleteQueries(static_cast<GLsizei>(occlusionQueries.size()), occlusionQueries.data());
+        occlusionQueries.clear();
+    }
+    occlusionGroups.clear();
+    groupedInstanceCount = 0;
+    Shader::getInstance().deleteShaderProgram(heatmapProgram);
+    heatmapProgram = 0;
+    Shader::getInstance().deleteShaderProgram(highlightProgram);
+    highlightProgram = 0;
+    GeometryArena::getInstance().destroyMesh(outlineMesh);
+    outlineMesh = GeometryArena::invalidMesh;
+    if (fullscreenVAO != 0)
+    {
+        glDeleteVertexArrays(1, &fullscreenVAO);
+        fullscreenVAO = 0;
+    }
+}
+
+void Scene::setInstanceCount(int count)
+{
+    count = std::max(1, count);
+    instances.clear();
+    instances.reserve(count);
+
+    const GridLayout layout = getGridLayout(count);
+    const int side = layout.side;
+    for (int i = 0; i < count; ++i)
+    {
+        int x = i % side;
+        int y = (i / side) % side;
+        int z = i / (side * side);
+        Instance instance;
+        instance.position = glm::vec3(layout.origin + x * layout.spacing, layout.origin + y * layout.spacing,
+                                      layout.origin + z * layout.spacing);
+        instance.scale = layout.scale;
+        instances.push_back(instance);
+    }
+}
+
+Scene::GridLayout Scene::getGridLayout(int count)
+{
+    // 实例排列在边长约2.4的立方体网格中，单个实例保持原来的大小
+    GridLayout layout;
+    layout.side = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(std::max(1, count)))));
+    layout.spacing = layout.side > 1 ? 2.4f / layout.side : 0.0f;
+    layout.scale = layout.side > 1 ? layout.spacing * 0.8f : 1.0f;
+    layout.origin = -0.5f * layout.spacing * (layout.side - 1);
+    return layout;
+}
+
+void Scene::buildOcclusionGroups(int count)
+{
+    if (!occlusionQueries.empty())
+    {
+        glDeleteQueries(static_cast<GLsizei>(occlusionQueries.size()), occlusionQueries.data());
+        occlusionQueries.clear();
+    }
+    occlusionGroups.clear();
+    groupMembers.clear();
+    groupedInstanceCount = count;
+
+    // 按网格坐标把实例归入边长为occlusionGroupSide的块，先计数再按块写入成员
+    const GridLayout layout = getGridLayout(count);
+    const int side = layout.side;
+    const int groupsPerSide = (side + occlusionGroupSide - 1) / occlusionGroupSide;
+    const int cellCount = groupsPerSide * groupsPerSide * groupsPerSide;
+    std::vector<int> cellOf(count);
+    std::vector<uint32_t> cellCounts(cellCount, 0);
+    for (int i = 0; i < count; ++i)
+    {
+        int x = (i % side) / occlusionGroupSide;
+        int y = ((i / side) % side) / occlusionGroupSide;
+        int z = (i / (side * side)) / occlusionGroupSide;
+        cellOf[i] = x + (y + z * groupsPerSide) * groupsPerSide;
+        ++cellCounts[cellOf[i]];
+    }
+
+    // 只保留非空块，组内成员按实例索引排列
+    std::vector<int> groupOfCell(cellCount, -1);
+    uint32_t offset = 0;
+    for (int cell = 0; cell < cellCount; ++cell)
+    {
+        if (cellCounts[cell] == 0)
+        {
+            continue;
+        }
+        groupOfCell[cell] = static_cast<int>(occlusionGroups.size());
+        occlusionGroups.push_back({glm::vec3(0.0f), glm::vec3(0.0f), offset, 0});
+        offset += cellCounts[cell];
+    }
+
+    groupMembers.resize(count);
+    std::vector<glm::vec3> minCorner(occlusionGroups.size(), glm::vec3(1e30f));
+    std::vector<glm::vec3> maxCorner(occlusionGroups.size(), glm::vec3(-1e30f));
+    const float halfExtent = layout.scale * proxyHalfExtent;
+    for (int i = 0; i < count; ++i)
+    {
+        OcclusionGroup &group = occlusionGroups[groupOfCell[cellOf[i]]];
+        groupMembers[group.first + group.count++] = static_cast<uint32_t>(i);
+
+        const size_t g = static_cast<size_t>(groupOfCell[cellOf[i]]);
+        glm::vec3 position(layout.origin + (i % side) * layout.spacing,
+                           layout.origin + ((i / side) % side) * layout.spacing,
+                           layout.origin + (i / (side * side)) * layout.spacing);
+        minCorner[g] = glm::min(minCorner[g], position - glm::vec3(halfExtent));
+        maxCorner[g] = glm::max(maxCorner[g], position + glm::vec3(halfExtent));
+    }
+    for (size_t g = 0; g < occlusionGroups.size(); ++g)
+    {
+        occlusionGroups[g].center = 0.5f * (minCorner[g] + maxCorner[g]);
+        occlusionGroups[g].size = maxCorner[g] - minCorner[g];
+    }
+
+    const size_t groupCount = occlusionGroups.size();
+    occlusionQueries.resize(groupCount * occlusionQuerySlots);
+    glGenQueries(static_cast<GLsizei>(occlusionQueries.size()), occlusionQueries.data());
+    queryIssued.assign(occlusionQueries.size(), 0);
+    groupVisible.assign(groupCount, 1);
+    groupForced.assign(groupCount, 0);
+    proxyModels.resize(groupCount);
+    groupOrder.resize(groupCount);
+    querySlot = 0;
+}
+
+void Scene::prepareOcclusion(const SceneView &view, const std::vector<glm::mat4> &models)
+{
+    const int count = static_cast<int>(models.size());
+    if (count != groupedInstanceCount)
+    {
+        buildOcclusionGroups(count);
+    }
+    const size_t groupCount = occlusionGroups.size();
+
+    // 读取已完成的查询，每组取最近一次可用的结果；未完成的查询保留上一次的可见性，不等待
+    for (size_t g = 0; g < groupCount; ++g)
+    {
+        for (int age = 0; age < occlusionQuerySlots; ++age)
+        {
+            int slot = (querySlot + occlusionQuerySlots - age) % occlusionQuerySlots;
+            size_t index = slot * groupCount + g;
+            if (!queryIssued[index])
+            {
+                continue;
+            }
+            GLuint available = 0;
+            glGetQueryObjectuiv(occlusionQueries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                GLuint anySamples = 0;
+                glGetQueryObjectuiv(occlusionQueries[index], GL_QUERY_RESULT, &anySamples);
+                groupVisible[g] = anySamples != 0;
+                queryIssued[index] = 0;
+                break;
+            }
+        }
+    }
+    querySlot = (querySlot + 1) % occlusionQuerySlots;
+
+    // 所有实例共享场景旋转：由第一个实例的模型矩阵去掉其平移和缩放得到旋转矩阵
+    const GridLayout layout = getGridLayout(count);
+    glm::mat4 rotation = glm::translate(glm::scale(models[0], glm::vec3(1.0f / layout.scale)), glm::vec3(-layout.origin));
+    glm::vec3 cameraLocal = glm::vec3(glm::inverse(rotation) * glm::inverse(view.view)[3]);
+
+    const float depthRange = Camera::farPlane - Camera::nearPlane;
+    const float maxKey = static_cast<float>((1 << depthKeyBits) - 1);
+    sortKeys.resize(groupCount);
+    int occluded = 0;
+    for (size_t g = 0; g < groupCount; ++g)
+    {
+        const OcclusionGroup &group = occlusionGroups[g];
+        proxyModels[g] = glm::scale(glm::translate(rotation, group.center), group.size);
+
+        // 相机在包围盒（加近平面余量）内时代理的正面会被裁掉，查询结果不可靠
+        glm::vec3 offset = glm::abs(cameraLocal - group.center);
+        glm::vec3 limit = 0.5f * group.size + glm::vec3(Camera::nearPlane);
+        groupForced[g] = offset.x <= limit.x && offset.y <= limit.y && offset.z <= limit.z;
+        if (!groupForced[g] && !groupVisible[g])
+        {
+            ++occluded;
+        }
+
+        glm::vec4 center = view.view * proxyModels[g][3];
+        float depth = (-center.z - Camera::nearPlane) / depthRange;
+        depth = std::min(std::max(depth, 0.0f), 1.0f);
+        sortKeys[g] = (static_cast<uint64_t>(depth * maxKey) << 32) | static_cast<uint64_t>(g);
+    }
+    occludedGroupFraction = groupCount > 0 ? static_cast<double>(occluded) / groupCount : 0.0;
+
+    // 组按从前到后排序，使前面的组先写入深度，遮挡后面组的代理
+    radixSort64(sortKeys, sortScratch, 32 + depthKeyBits, 32);
+    for (size_t g = 0; g < groupCount; ++g)
+    {
+        groupOrder[g] = static_cast<uint32_t>(sortKeys[g] & 0xFFFFFFFFu);
+    }
+}
+
+bool Scene::beginProxyState()
+{
+    GLuint proxyProgram = Shader::getInstance().getDepthOnlyProgram(0);
+    if (proxyProgram == 0)
+    {
+        return false;
+    }
+
+    glUseProgram(proxyProgram);
+    glUniformMatrix4fv(glGetUniformLocation(proxyProgram, "view"), 1, GL_FALSE, glm::value_ptr(frameView.view));
+    glUniformMatrix4fv(glGetUniformLocation(proxyProgram, "projection"), 1, GL_FALSE, glm::value_ptr(frameView.projection));
+    proxyModelLocation = glGetUniformLocation(proxyProgram, "model");
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    return true;
+}
+
+void Scene::drawProxy(uint32_t group)
+{
+    GLuint query = getOcclusionQuery(group);
+    glUniformMatrix4fv(proxyModelLocation, 1, GL_FALSE, glm::value_ptr(proxyModels[group]));
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+    Cube::getInstance().draw();
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+    queryIssued[querySlot * occlusionGroups.size() + group] = 1;
+    ++lastDrawCalls;
+}
+
+void Scene::issueProxyQueries()
+{
+    if (!occlusionActive || occlusionMode != OcclusionMode::Temporal || occlusionQueriesIssued)
+    {
+        return;
+    }
+
+    GLboolean colorMask[4];
+    GLboolean depthMask = GL_TRUE;
+    glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    if (!beginProxyState())
+    {
+        return;
+    }
+
+    Cube &cube = Cube::getInstance();
+    cube.bind();
+    for (uint32_t group : groupOrder)
+    {
+        if (!groupForced[group])
+        {
+            drawProxy(group);
+        }
+    }
+    cube.unbind();
+
+    glColorMask(colorMask[0], colorMask[1], colorMask[2], colorMask[3]);
+    glDepthMask(depthMask);
+    occlusionQueriesIssued = true;
+}
+
+glm::mat4 Scene::getInstanceModel(int index, const glm::mat4 &rotation) const
+{
+    const Instance &instance = instances[index];
+    glm::mat4 model = glm::translate(rotation, instance.position);
+    return glm::scale(model, glm::vec3(instance.scale));
+}
+
+void Scene::computeModels(const glm::mat4 &rotation, std::vector<glm::mat4> *models) const
+{
+    const int count = getInstanceCount();
+    models->resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        (*models)[i] = getInstanceModel(i, rotation);
+    }
+}
+
+void Scene::prepareDraws(const SceneView &view, const std::vector<glm::mat4> &models)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    frameView = view;
+    frameModels = &models;
+    lastDrawCalls = 0;
+    queueStats = RenderQueueStats();
+    const int count = static_cast<int>(models.size());
+
+    // 遮挡剔除按组排序和绘制，不再逐实例排序
+    occlusionActive = occlusionMode != OcclusionMode::Off && count > 0 &&
+                      Shader::getInstance().getDepthOnlyProgram(0) != 0;
+    occlusionQueriesIssued = false;
+    if (occlusionActive)
+    {
+        prepareOcclusion(view, models);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        lastSortMs = elapsed.count();
+        return;
+    }
+    occludedGroupFraction = 0.0;
+
+    drawOrder.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        drawOrder[i] = static_cast<uint32_t>(i);
+    }
+
+    if (sortFrontToBack && count > 1)
+    {
+        // 视空间深度量化为16位整数作为高位键，实例索引作为低位
+        const glm::mat4 &viewMatrix = view.view;
+        const float depthRange = Camera::farPlane - Camera::nearPlane;
+        const float maxKey = static_cast<float>((1 << depthKeyBits) - 1);
+        sortKeys.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            glm::vec4 center = viewMatrix * models[i][3];
+            float depth = (-center.z - Camera::nearPlane) / depthRange;
+            depth = std::min(std::max(depth, 0.0f), 1.0f);
+            uint64_t key = static_cast<uint64_t>(depth * maxKey);
+            sortKeys[i] = (key << 32) | static_cast<uint64_t>(i);
+        }
+
+        // 键按实例索引顺序填写，低32位已有序，只需排序深度位
+        radixSort64(sortKeys, sortScratch, 32 + depthKeyBits, 32);
+
+        for (int i = 0; i < count; ++i)
+        {
+            drawOrder[i] = static_cast<uint32_t>(sortKeys[i] & 0xFFFFFFFFu);
+        }
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    lastSortMs = elapsed.count();
+}
+
+int Scene::getInstanceCombination(uint32_t index)
+{
+    // 乘法散列打乱相邻实例，使直接提交时几乎每次绘制都切换程序
+    constexpr uint32_t combinations = Shader::vertexShaderCount * Shader::fragmentShaderCount;
+    return static_cast<int>(((index * 2654435761u) >> 16) % combinations);
+}
+
+void Scene::drawInstances(RenderQueue::Pass pass, GLuint program, float time)
+{
+    // 混合程序模式下按通道为每种着色器组合准备程序，否则所有实例使用同一个程序
+    constexpr int combinations = Shader::vertexShaderCount * Shader::fragmentShaderCount;
+    GLuint programTable[combinations];
+    const Shader &shader = Shader::getInstance();
+    for (int c = 0; c < combinations; ++c)
+    {
+        GLuint instanceProgram = program;
+        if (mixedPrograms)
+        {
+            int vertexShader = c / Shader::fragmentShaderCount;
+            int fragmentShader = c % Shader::fragmentShaderCount;
+            instanceProgram = pass == RenderQueue::PassDepth      ? shader.getDepthOnlyProgram(vertexShader)
+                              : pass == RenderQueue::PassOverdraw ? shader.getOverdrawProgram(vertexShader)
+                                                                  : shader.getProgram(vertexShader, fragmentShader);
+        }
+        programTable[c] = instanceProgram != 0 ? instanceProgram : program;
+    }
+
+    // 程序在第一次绘制前才绑定；每个程序的相机和时间uniform在本次调用中只设置一次
+    const TextureManager &textures = TextureManager::getInstance();
+    const uint32_t materialCount = static_cast<uint32_t>(textures.getMaterialCount());
+    GLuint initializedPrograms[combinations];
+    int initializedCount = 0;
+    GLuint boundProgram = 0;
+    GLint modelLocation = -1;
+    bool textured = false;
+    uint32_t boundMaterial = UINT32_MAX;
+    auto useProgram = [&](GLuint instanceProgram)
+    {
+        glUseProgram(instanceProgram);
+        ++queueStats.programBinds;
+        boundProgram = instanceProgram;
+        modelLocation = glGetUniformLocation(instanceProgram, "model");
+        textured = glGetUniformLocation(instanceProgram, "diffuseTexture") != -1;
+        boundMaterial = UINT32_MAX;
+        if (std::find(initializedPrograms, initializedPrograms + initializedCount, instanceProgram) !=
+            initializedPrograms + initializedCount)
+        {
+            return;
+        }
+        initializedPrograms[initializedCount++] = instanceProgram;
+
+        // 设置时间uniform变量
+        int timeLocation = glGetUniformLocation(instanceProgram, "time");
+        if (timeLocation != -1)
+        {
+            glUniform1f(timeLocation, time);
+            ++queueStats.uniformCalls;
+        }
+
+        // 设置相机uniform变量
+        glUniformMatrix4fv(glGetUniformLocation(instanceProgram, "view"), 1, GL_FALSE, glm::value_ptr(frameView.view));
+        glUniformMatrix4fv(glGetUniformLocation(instanceProgram, "projection"), 1, GL_FALSE,
+                           glm::value_ptr(frameView.projection));
+        queueStats.uniformCalls += 2;
+    };
+
+    // 逐实例设置模型矩阵并绘制，立方体VAO只绑定一次
+    const std::vector<glm::mat4> &models = *frameModels;
+    Cube &cube = Cube::getInstance();
+
+    // 带材质纹理的程序按实例序号轮流分配材质，只在材质变化时重新绑定
+    auto drawInstance = [&](uint32_t index)
+    {
+        GLuint instanceProgram = mixedPrograms ? programTable[getInstanceCombination(index)] : program;
+        if (instanceProgram != boundProgram)
+        {
+            useProgram(instanceProgram);
+        }
+        if (textured && index % materialCount != boundMaterial)
+        {
+            boundMaterial = index % materialCount;
+            textures.bind(static_cast<int>(boundMaterial));
+            ++queueStats.textureBinds;
+        }
+        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(models[index]));
+        ++queueStats.uniformCalls;
+        cube.draw();
+        ++queueStats.draws;
+    };
+
+    cube.bind();
+    ++queueStats.vaoBinds;
+    if (!occlusionActive)
+    {
+        for (uint32_t index : drawOrder)
+        {
+            drawInstance(index);
+        }
+        lastDrawCalls += static_cast<int>(drawOrder.size());
+        cube.unbind();
+        return;
+    }
+
+    // Conditional模式在本帧第一个绘制通道中逐组先画代理再条件绘制，后续通道复用同一批查询
+    bool conditional = occlusionMode == OcclusionMode::Conditional;
+    bool issueQueries = conditional && !occlusionQueriesIssued;
+    GLboolean colorMask[4];
+    GLboolean depthMask = GL_TRUE;
+    if (issueQueries)
+    {
+        glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    }
+
+    for (uint32_t group : groupOrder)
+    {
+        bool forced = groupForced[group] != 0;
+        if (!conditional && !forced && !groupVisible[group])
+        {
+            continue;
+        }
+
+        bool useQuery = conditional && !forced;
+        if (useQuery && issueQueries)
+        {
+            if (!beginProxyState())
+            {
+                useQuery = false;
+            }
+            else
+            {
+                drawProxy(group);
+                glColorMask(colorMask[0], colorMask[1], colorMask[2], colorMask[3]);
+                glDepthMask(depthMask);
+                boundProgram = 0; // 下一个实例重新绑定着色程序
+            }
+        }
+
+        // QUERY_NO_WAIT：结果未就绪时GPU照常绘制，不会停顿
+        if (useQuery)
+        {
+            glBeginConditionalRender(getOcclusionQuery(group), GL_QUERY_NO_WAIT);
+        }
+        const OcclusionGroup &range = occlusionGroups[group];
+        for (uint32_t k = range.first; k < range.first + range.count; ++k)
+        {
+            drawInstance(groupMembers[k]);
+        }
+        if (useQuery)
+        {
+            glEndConditionalRender();
+        }
+        lastDrawCalls += static_cast<int>(range.count);
+    }
+    cube.unbind();
+
+    if (issueQueries)
+    {
+        occlusionQueriesIssued = true;
+    }
+}
+
+bool Scene::buildQueue(RenderQueue::Pass pass, int vertexShader, int fragmentShader, float time)
+{
+    // 登记本帧可能用到的DrawData程序，缺少任何一个时整帧退回直接提交
+    constexpr int combinations = Shader::vertexShaderCount * Shader::fragmentShaderCount;
+    const Shader &shader = Shader::getInstance();
+    drawQueue.begin(frameView.view, frameView.projection, time);
+    uint32_t shadeSlots[combinations];
+    uint32_t depthSlots[combinations];
+    for (int c = 0; c < combinations; ++c)
+    {
+        int v = mixedPrograms ? c / Shader::fragmentShaderCount : vertexShader;
+        int f = mixedPrograms ? c % Shader::fragmentShaderCount : fragmentShader;
+        GLuint shadeProgram = pass == RenderQueue::PassOverdraw ? shader.getOverdrawProgram(v, true)
+                                                                : shader.getProgram(v, f, true);
+        GLuint depthProgram = shader.getDepthOnlyProgram(v, true);
+        if (shadeProgram == 0 || (depthPrepass && depthProgram == 0))
+        {
+            return false;
+        }
+        shadeSlots[c] = drawQueue.addProgram(shadeProgram);
+        depthSlots[c] = depthPrepass ? drawQueue.addProgram(depthProgram) : 0;
+    }
+    const Cube &cube = Cube::getInstance();
+    const GeometryMesh &range = GeometryArena::getInstance().getMesh(cube.getMesh());
+    const uint32_t mesh = drawQueue.addMesh(cube.getVertexArray(), static_cast<GLsizei>(range.indexCount),
+                                            range.firstIndex, range.baseVertex);
+
+    // 同一实例的预通道和着色通道共享一份model数据
+    const std::vector<glm::mat4> &models = *frameModels;
+    const float depthRange = Camera::farPlane - Camera::nearPlane;
+    for (uint32_t index : drawOrder)
+    {
+        float depth = 0.0f;
+        if (sortFrontToBack)
+        {
+            glm::vec4 center = frameView.view * models[index][3];
+            depth = (-center.z - Camera::nearPlane) / depthRange;
+        }
+        int combination = mixedPrograms ? getInstanceCombination(index) : 0;
+        uint32_t drawData = drawQueue.addDrawData(models[index]);
+        if (depthPrepass)
+        {
+            drawQueue.push(RenderQueue::PassDepth, depthSlots[combination], mesh, depth, drawData, 0);
+        }
+        drawQueue.push(pass, shadeSlots[combination], mesh, depth, drawData, static_cast<int>(index));
+    }
+    drawQueue.finish(&queueStats);
+    return true;
+}
+
+void Scene::drawDepthPrepass(int vertexShader, float time, bool queued)
+{
+    GLuint depthProgram = Shader::getInstance().getDepthOnlyProgram(vertexShader);
+    if (depthProgram == 0)
+    {
+        return;
+    }
+
+    // 只写深度，着色通道随后只对深度相等的片段着色
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    if (queued)
+    {
+        int before = queueStats.draws;
+        drawQueue.submit(RenderQueue::PassDepth, commandThreads, &queueStats);
+        lastDrawCalls += queueStats.draws - before;
+    }
+    else
+    {
+        drawInstances(RenderQueue::PassDepth, depthProgram, time);
+    }
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+}
+
+void Scene::restoreDepthState()
+{
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+}
+
+void Scene::render(int vertexShader, int fragmentShader, float time, int pixelCount)
+{
+    const Camera &camera = Camera::getInstance();
+    SceneView view;
+    view.view = camera.getViewMatrix();
+    view.projection = camera.getProjectionMatrix();
+    computeModels(camera.getRotationMatrix(), &models);
+    render(view, models, vertexShader, fragmentShader, time, pixelCount);
+}
+
+void Scene::render(const SceneView &view, const std::vector<glm::mat4> &models,
+                   int vertexShader, int fragmentShader, float time, int pixelCount)
+{
+    prepareDraws(view, models);
+
+    // 遮挡剔除按组逐个提交，不经过渲染队列
+    bool queued = useRenderQueue && !occlusionActive &&
+                  buildQueue(RenderQueue::PassOpaque, vertexShader, fragmentShader, time);
+    if (depthPrepass)
+    {
+        drawDepthPrepass(vertexShader, time, queued);
+    }
+
+    // 使用当前着色器程序
+    Shader::getInstance().useShaderProgram(vertexShader, fragmentShader);
+
+    // 同一时刻只能有一个样本计数类查询处于活动状态，着色通道中穿插遮挡查询时不统计着色片段
+    bool interleaved = occlusionActive && occlusionMode == OcclusionMode::Conditional && !occlusionQueriesIssued;
+    if (!interleaved)
+    {
+        fragmentQuery.begin();
+    }
+    if (queued)
+    {
+        int before = queueStats.draws;
+        drawQueue.submit(RenderQueue::PassOpaque, commandThreads, &queueStats);
+        lastDrawCalls += queueStats.draws - before;
+    }
+    else
+    {
+        drawInstances(RenderQueue::PassOpaque, Shader::getInstance().getCurrentProgram(), time);
+    }
+    if (!interleaved)
+    {
+        fragmentQuery.end();
+    }
+    issueProxyQueries();
+
+    restoreDepthState();
+    drawHighlight();
+    updateFragmentStats(pixelCount);
+}
+
+void Scene::renderOverdraw(const SceneView &view, const std::vector<glm::mat4> &models,
+                           int vertexShader, float time, int pixelCount)
+{
+    GLuint overdrawProgram = Shader::getInstance().getOverdrawProgram(vertexShader);
+    if (overdrawProgram == 0)
+    {
+        return;
+    }
+
+    prepareDraws(view, models);
+
+    bool queued = useRenderQueue && !occlusionActive &&
+                  buildQueue(RenderQueue::PassOverdraw, vertexShader, 0, time);
+    if (depthPrepass)
+    {
+        drawDepthPrepass(vertexShader, time, queued);
+    }
+
+    // 加法混合累计每个像素通过深度测试的片段数
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    bool interleaved = occlusionActive && occlusionMode == OcclusionMode::Conditional && !occlusionQueriesIssued;
+    if (!interleaved)
+    {
+        fragmentQuery.begin();
+    }
+    if (queued)
+    {
+        int before = queueStats.draws;
+        drawQueue.submit(RenderQueue::PassOverdraw, commandThreads, &queueStats);
+        lastDrawCalls += queueStats.draws - before;
+    }
+    else
+    {
+        drawInstances(RenderQueue::PassOverdraw, overdrawProgram, time);
+    }
+    if (!interleaved)
+    {
+        fragmentQuery.end();
+    }
+    glDisable(GL_BLEND);
+    issueProxyQueries();
+
+    restoreDepthState();
+    updateFragmentStats(pixelCount);
+}
+
+void Scene::renderHeatmap(GLuint countTexture)
+{
+    if (heatmapProgram == 0)
+    {
+        return;
+    }
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+
+    glUseProgram(heatmapProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, countTexture);
+    glUniform1i(glGetUniformLocation(heatmapProgram, "overdrawCount"), 0);
+    glBindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+}
+
+void Scene::drawHighlight()
+{
+    if (highlightProgram == 0 || outlineMesh == GeometryArena::invalidMesh || frameModels == nullptr ||
+        highlightInstance < 0 || highlightInstance >= static_cast<int>(frameModels->size()))
+    {
+        return;
+    }
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+
+    glm::mat4 model = glm::scale((*frameModels)[highlightInstance], glm::vec3(highlightScale));
+    glUseProgram(highlightProgram);
+    glUniformMatrix4fv(glGetUniformLocation(highlightProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix4fv(glGetUniformLocation(highlightProgram, "view"), 1, GL_FALSE, glm::value_ptr(frameView.view));
+    glUniformMatrix4fv(glGetUniformLocation(highlightProgram, "projection"), 1, GL_FALSE, glm::value_ptr(frameView.projection));
+
+    GeometryArena &arena = GeometryArena::getInstance();
+    const GeometryMesh &mesh = arena.getMesh(outlineMesh);
+    arena.bind(Cube::format);
+    GeometryArena::drawRange(static_cast<GLsizei>(mesh.indexCount), mesh.firstIndex, mesh.baseVertex, GL_LINES);
+    glBindVertexArray(0);
+    ++lastDrawCalls;
+
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+}
+
+void Scene::updateFragmentStats(int pixelCount)
+{
+    if (pixelCount > 0 && fragmentQuery.getResultCount() > 0)
+    {
+        shadedFragmentsPerPixel = static_cast<double>(fragmentQuery.getLastValue()) / pixelCount;
+    }
+}
@@ -0,0 +1,379 @@
+/**
+ * @file scene.h
+ * @brief 场景管理头文件
+ * @details 定义了由多个立方体实例组成的场景，负责绘制排序、深度预通道和过度绘制可视化
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "geometry_arena.h"
+#include "gpu_query.h"
+#include "render_queue.h"
+
+/**
+ * @struct SceneView
+ * @brief 渲染一帧场景使用的相机矩阵
+ * @details 渲染线程模式下由主线程从相机计算后随帧快照传递，渲染侧不再读取Camera单例
+ */
+struct SceneView
+{
+    glm::mat4 view = glm::mat4(1.0f);       // 视图矩阵
+    glm::mat4 projection = glm::mat4(1.0f); // 投影矩阵
+};
+
+/**
+ * @class Scene
+ * @brief 场景管理类，使用单例模式实现
+ * @details 场景由排列在网格中的立方体实例组成，实例数为1时与原来的单个立方体一致。
+ * 不透明物体可以按视空间深度从前到后排序（量化深度键+基数排序），可选先绘制只写深度的
+ * 预通道，使着色通道只对可见片段执行片段着色器。
+ * 实例较多时可按网格分组做遮挡剔除：每组绘制一个包围盒代理并发出遮挡查询，
+ * 被前面的组完全挡住的组不再执行顶点和片段着色。
+ * 混合程序模式下每个实例使用不同的顶点和片段着色器组合，可改由排序渲染队列提交以减少状态切换，
+ * 渲染队列还可以由多个线程并行录制命令列表后在GL线程上回放。
+ * 鼠标拾取到的实例在着色通道之后用线框包围盒高亮
+ */
+class Scene
+{
+public:
+    /**
+     * @struct Instance
+     * @brief 立方体实例
+     */
+    struct Instance
+    {
+        glm::vec3 position; // 实例中心位置
+        float scale;        // 实例缩放
+    };
+
+    /**
+     * @enum OcclusionMode
+     * @brief 遮挡剔除模式
+     */
+    enum class OcclusionMode
+    {
+        Off,         // 不剔除
+        Conditional, // 按从前到后的顺序逐组绘制代理并立即用条件渲染绘制该组，由GPU跳过被遮挡的组
+        Temporal     // 使用上一帧的查询结果在CPU端跳过被遮挡的组，本帧结束时为所有组重新查询
+    };
+
+    /**
+     * @brief 获取Scene单例实例
+     * @return Scene& 单例实例的引用
+     */
+    static Scene &getInstance()
+    {
+        static Scene instance;
+        return instance;
+    }
+
+    /**
+     * @brief 初始化场景
+     * @details 创建过度绘制热力图程序和样本计数查询，需在Shader和Cube初始化之后调用
+     */
+    void init();
+
+    /**
+     * @brief 清理场景资源
+     */
+    void cleanup();
+
+    /**
+     * @brief 设置实例数量
+     * @param count 实例数量，实例按立方体网格排列在原点附近
+     */
+    void setInstanceCount(int count);
+
+    /**
+     * @brief 获取实例数量
+     * @return int 实例数量
+     */
+    int getInstanceCount() const { return static_cast<int>(instances.size()); }
+
+    /**
+     * @brief 获取所有实例
+     * @return const std::vector<Instance>& 实例数组
+     */
+    const std::vector<Instance> &getInstances() const { return instances; }
+
+    /**
+     * @brief 计算实例的模型矩阵
+     * @param index 实例索引
+     * @param rotation 场景整体的旋转矩阵
+     * @return glm::mat4 模型矩阵
+     */
+    glm::mat4 getInstanceModel(int index, const glm::mat4 &rotation) const;
+
+    /**
+     * @brief 计算所有实例的模型矩阵
+     * @param rotation 场景整体的旋转矩阵
+     * @param models 输出的模型矩阵，容量在帧之间复用
+     */
+    void computeModels(const glm::mat4 &rotation, std::vector<glm::mat4> *models) const;
+
+    /**
+     * @brief 按相机单例的当前状态渲染场景
+     * @param vertexShader 顶点着色器索引
+     * @param fragmentShader 片段着色器索引
+     * @param time 动画时间
+     * @param pixelCount 渲染目标的像素数（多重采样时乘以采样数），用于计算每像素着色片段数
+     * @details 要求已绑定带深度附件的渲染目标并清除
+     */
+    void render(int vertexShader, int fragmentShader, float time, int pixelCount);
+
+    /**
+     * @brief 按给定的相机矩阵和模型矩阵渲染场景
+     * @param view 相机矩阵
+     * @param models 实例的模型矩阵，需在渲染期间保持有效
+     * @param vertexShader 顶点着色器索引
+     * @param fragmentShader 片段着色器索引
+     * @param time 动画时间
+     * @param pixelCount 渲染目标的像素数
+     * @details 只访问GL和本类的渲染状态，可在渲染线程上调用
+     */
+    void render(const SceneView &view, const std::vector<glm::mat4> &models,
+                int vertexShader, int fragmentShader, float time, int pixelCount);
+
+    /**
+     * @brief 渲染过度绘制计数
+     * @param view 相机矩阵
+     * @param models 实例的模型矩阵
+     * @param vertexShader 顶点着色器索引
+     * @param time 动画时间
+     * @param pixelCount 渲染目标的像素数
+     * @details 使用与render相同的绘制顺序和预通道设置，每个通过深度测试的片段
+     * 向颜色附件的红色通道加法混合1/255
+     */
+    void renderOverdraw(const SceneView &view, const std::vector<glm::mat4> &models,
+                        int vertexShader, float time, int pixelCount);
+
+    /**
+     * @brief 将过度绘制计数纹理映射为热力图
+     * @param countTexture renderOverdraw输出的计数纹理
+     * @details 绘制全屏三角形到当前绑定的帧缓冲区
+     */
+    void renderHeatmap(GLuint countTexture);
+
+    bool sortFrontToBack = true; // 是否按视空间深度从前到后排序
+    bool depthPrepass = false;   // 是否先绘制只写深度的预通道
+    bool showOverdraw = false;   // 是否显示过度绘制热力图
+    OcclusionMode occlusionMode = OcclusionMode::Off; // 遮挡剔除模式
+    bool mixedPrograms = false;  // 是否让每个实例使用各自的着色器组合
+    bool useRenderQueue = false; // 是否经由排序渲染队列提交（遮挡剔除时不使用）
+    int commandThreads = 0;      // 渲染队列录制命令列表的线程数，0表示直接提交
+    int highlightInstance = -1;  // 高亮的实例，-1表示不高亮
+
+    /**
+     * @brief 获取最近一帧的排序耗时
+     * @return double 计算深度键和基数排序的CPU耗时（毫秒）
+     */
+    double getLastSortMs() const { return lastSortMs; }
+
+    /**
+     * @brief 获取最近一帧的绘制调用数
+     * @return int 预通道与着色通道的绘制调用之和
+     */
+    int getLastDrawCalls() const { return lastDrawCalls; }
+
+    /**
+     * @brief 获取每像素着色片段数
+     * @return double 着色通道中通过深度测试的样本数除以像素数
+     */
+    double getShadedFragmentsPerPixel() const { return shadedFragmentsPerPixel; }
+
+    /**
+     * @brief 获取遮挡剔除的分组数
+     * @return int 最近一帧参与遮挡剔除的组数，未启用时为0
+     */
+    int getOcclusionGroupCount() const { return occlusionMode == OcclusionMode::Off ? 0 : static_cast<int>(occlusionGroups.size()); }
+
+    /**
+     * @brief 获取被遮挡而跳过的组所占比例
+     * @return double 最近取得的查询结果中被判定为不可见的组数除以总组数
+     */
+    double getOccludedGroupFraction() const { return occludedGroupFraction; }
+
+    /**
+     * @brief 获取最近一帧的状态切换统计
+     * @return const RenderQueueStats& 预通道与着色通道的统计之和
+     */
+    const RenderQueueStats &getRenderQueueStats() const { return queueStats; }
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    Scene() : fragmentQuery(GL_SAMPLES_PASSED) {}
+    ~Scene() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    Scene(const Scene &) = delete;
+    Scene &operator=(const Scene &) = delete;
+
+    /**
+     * @struct GridLayout
+     * @brief 实例网格的排列参数
+     */
+    struct GridLayout
+    {
+        int side;      // 每条边的实例数
+        float spacing; // 相邻实例中心的间距
+        float scale;   // 实例缩放
+        float origin;  // 第一个实例中心在各轴上的坐标
+    };
+
+    /**
+     * @struct OcclusionGroup
+     * @brief 遮挡剔除的实例组
+     * @details 包围盒在场景旋转之前的局部坐标系中表示，所有实例共享同一个旋转
+     */
+    struct OcclusionGroup
+    {
+        glm::vec3 center; // 包围盒中心
+        glm::vec3 size;   // 包围盒边长（已包含顶点动画的余量）
+        uint32_t first;   // 组成员在groupMembers中的起始位置
+        uint32_t count;   // 组成员数
+    };
+
+    /**
+     * @brief 计算给定实例数的网格排列
+     * @param count 实例数
+     * @return GridLayout 排列参数
+     */
+    static GridLayout getGridLayout(int count);
+
+    /**
+     * @brief 按网格把实例划分为遮挡剔除组
+     * @param count 实例数
+     * @details 只依赖实例数，因此可以在渲染侧由模型矩阵的数量重建，不读取主线程的实例数组
+     */
+    void buildOcclusionGroups(int count);
+
+    /**
+     * @brief 读取已完成的遮挡查询，计算代理包围盒并按深度排序各组
+     * @param view 相机矩阵
+     * @param models 实例的模型矩阵
+     */
+    void prepareOcclusion(const SceneView &view, const std::vector<glm::mat4> &models);
+
+    /**
+     * @brief 绘制一个组的代理包围盒并发出遮挡查询
+     * @param group 组索引
+     * @details 要求已绑定代理程序和立方体VAO，并关闭颜色和深度写入
+     */
+    void drawProxy(uint32_t group);
+
+    /**
+     * @brief 为所有组绘制代理并发出遮挡查询
+     * @details 仅在Temporal模式下生效，在着色通道之后对完整的深度缓冲区测试，结果供后续帧使用
+     */
+    void issueProxyQueries();
+
+    /**
+     * @brief 切换到代理程序并关闭颜色和深度写入
+     * @return bool 代理程序是否可用
+     */
+    bool beginProxyState();
+
+    /**
+     * @brief 获取本帧某组使用的查询对象
+     */
+    GLuint getOcclusionQuery(uint32_t group) const { return occlusionQueries[querySlot * occlusionGroups.size() + group]; }
+
+    /**
+     * @brief 记录本帧的相机和模型矩阵并计算绘制顺序
+     * @param view 相机矩阵
+     * @param models 实例的模型矩阵
+     */
+    void prepareDraws(const SceneView &view, const std::vector<glm::mat4> &models);
+
+    /**
+     * @brief 获取实例在混合程序模式下使用的着色器组合
+     * @param index 实例索引
+     * @return int 组合编号，顶点着色器为编号除以片段着色器数，片段着色器为余数
+     * @details 组合由索引散列得到，相邻实例通常使用不同的程序
+     */
+    static int getInstanceCombination(uint32_t index);
+
+    /**
+     * @brief 按绘制顺序用指定程序绘制所有实例
+     * @param pass 绘制通道，混合程序模式下据此为每个实例选择程序
+     * @param program 着色器程序，混合程序模式下只决定第一个实例之前绑定的程序
+     * @param time 动画时间
+     */
+    void drawInstances(RenderQueue::Pass pass, GLuint program, float time);
+
+    /**
+     * @brief 把本帧的绘制写入渲染队列并排序
+     * @param pass 着色绘制使用的通道（PassOpaque或PassOverdraw）
+     * @param vertexShader 顶点着色器索引
+     * @param fragmentShader 片段着色器索引
+     * @param time 动画时间
+     * @return bool 所需的DrawData程序都存在且已写入队列，否则应退回直接提交
+     */
+    bool buildQueue(RenderQueue::Pass pass, int vertexShader, int fragmentShader, float time);
+
+    /**
+     * @brief 绘制深度预通道并切换为等深度着色
+     * @param vertexShader 顶点着色器索引
+     * @param time 动画时间
+     * @param queued 是否从渲染队列提交
+     */
+    void drawDepthPrepass(int vertexShader, float time, bool queued);
+
+    /**
+     * @brief 恢复默认的深度测试状态
+     */
+    void restoreDepthState();
+
+    /**
+     * @brief 绘制高亮实例的线框包围盒
+     * @details 关闭深度测试，被遮挡时线框仍然可见
+     */
+    void drawHighlight();
+
+    /**
+     * @brief 读取样本计数查询并更新每像素着色片段数
+     * @param pixelCount 渲染目标像素数
+     */
+    void updateFragmentStats(int pixelCount);
+
+    std::vector<Instance> instances;   // 场景实例
+    std::vector<glm::mat4> models;     // 按相机单例渲染时计算的模型矩阵
+    SceneView frameView;               // 本帧的相机矩阵
+    const std::vector<glm::mat4> *frameModels = nullptr; // 本帧的模型矩阵
+    std::vector<uint32_t> drawOrder;   // 本帧的绘制顺序
+    std::vector<uint64_t> sortKeys;    // 排序键（高位为量化深度，低位为实例索引）
+    std::vector<uint64_t> sortScratch; // 基数排序临时缓冲区
+    RenderQueue drawQueue;             // 排序渲染队列
+    RenderQueueStats queueStats;       // 本帧的状态切换统计
+
+    GpuQuery fragmentQuery;      // 着色通道的样本计数查询
+    GLuint heatmapProgram = 0;   // 热力图着色器程序
+    GLuint fullscreenVAO = 0;    // 全屏三角形使用的空VAO
+    GLuint highlightProgram = 0; // 高亮线框着色器程序
+    uint32_t outlineMesh = GeometryArena::invalidMesh; // 单位立方体12条棱的线段网格
+
+    double lastSortMs = 0.0;              // 最近一帧排序耗时
+    int lastDrawCalls = 0;                // 最近一帧绘制调用数
+    double shadedFragmentsPerPixel = 0.0; // 每像素着色片段数
+
+    static constexpr int occlusionGroupSide = 4; // 每组在每条边上包含的实例数
+    static constexpr int occlusionQuerySlots = 3; // 每组轮流使用的查询对象数，避免读取未完成的结果时阻塞
+
+    std::vector<OcclusionGroup> occlusionGroups; // 遮挡剔除组
+    std::vector<uint32_t> groupMembers;          // 按组排列的实例索引
+    std::vector<uint32_t> groupOrder;            // 本帧按深度排序的组索引
+    std::vector<glm::mat4> proxyModels;          // 本帧各组代理包围盒的模型矩阵
+    std::vector<uint8_t> groupVisible;           // 各组最近一次查询结果是否可见
+    std::vector<uint8_t> groupForced;            // 相机位于包围盒内的组，代理会被近平面裁掉，总是绘制
+    std::vector<uint8_t> queryIssued;            // 各查询对象是否已发出且结果未读取
+    std::vector<GLuint> occlusionQueries;        // 遮挡查询对象（occlusionQuerySlots组）
+    int groupedInstanceCount = 0;                // 分组时的实例数
+    int querySlot = 0;                           // 本帧使用的查询对象组
+    GLint proxyModelLocation = -1;               // 代理程序model uniform的位置
+    bool occlusionActive = false;                // 本帧是否执行遮挡剔除
+    bool occlusionQueriesIssued = false;         // 本帧是否已发出遮挡查询
+    double occludedGroupFraction = 0.0;          // 被判定为不可见的组所占比例
+};
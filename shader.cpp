@@ -1,13 +1,64 @@
 #include "shader.h"
+#include "memory_tracker.h"
+#include "embedded_assets.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+#include <algorithm>
 #include <glm/gtc/type_ptr.hpp>
 #include <GL/glew.h>
 #include <SimpleIni.h>
 
+namespace
+{
+    // 深度预通道使用的空片段着色器
+    const char *depthOnlyFragmentSource = R"(
+#version 330 core
+void main()
+{
+}
+)";
+
+    // 过度绘制统计使用的片段着色器，每个片段累加1/255
+    const char *overdrawFragmentSource = R"(
+#version 330 core
+out vec4 FragColor;
+void main()
+{
+    FragColor = vec4(1.0 / 255.0, 0.0, 0.0, 0.0);
+}
+)";
+
+    // 粒子实例化绘制使用的顶点着色器，每个实例的位置和剩余寿命来自变换反馈缓冲区
+    const char *particleVertexSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec4 aOffset;
+layout (location = 3) in vec2 aTexCoord;
+out vec3 vertexColor;
+out vec2 texCoord;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform float particleSize;
+void main()
+{
+    // 寿命最后20%逐渐缩小，重生时不会突然出现
+    float size = particleSize * clamp(aOffset.w * 5.0, 0.0, 1.0);
+    gl_Position = projection * view * model * vec4(aOffset.xyz + aPos * size, 1.0);
+    vertexColor = aColor;
+    texCoord = aTexCoord;
+}
+)";
+}
+
 void Shader::init()
 {
+    // 每个源文件会被多个程序组合使用，init期间只加载一次
+    cacheSources = true;
+
     // 从 INI 文件加载 shader 路径
     if (!loadShaderPathsFromIni("shader_config.ini"))
     {
@@ -20,6 +71,7 @@ void Shader::init()
         fragmentShaderPaths["normal"] = "shaders/fragment/normal.frag";
         fragmentShaderPaths["pulse"] = "shaders/fragment/pulse.frag";
         fragmentShaderPaths["rainbow"] = "shaders/fragment/rainbow.frag";
+        fragmentShaderPaths["textured"] = "shaders/fragment/textured.frag";
     }
 
     // 初始化 shader 程序
@@ -32,22 +84,95 @@ void Shader::init()
             if (shaderPrograms[name] == 0)
             {
                 std::cerr << "Failed to create shader program: " << name << std::endl;
+                cacheSources = false;
+                sourceCache.clear();
                 return;
             }
         }
     }
 
+    // 为每个顶点着色器创建深度预通道和过度绘制程序
+    for (const auto &vShader : vertexShaderPaths)
+    {
+        std::string vertexCode = loadShaderSource(vShader.second);
+        depthOnlyPrograms[vShader.first] = createProgramFromSource(vertexCode, depthOnlyFragmentSource);
+        overdrawPrograms[vShader.first] = createProgramFromSource(vertexCode, overdrawFragmentSource);
+
+        // 渲染队列使用的DrawData变体，自定义着色器没有model声明时不创建，渲染队列随之退回逐次设置uniform
+        std::string blockCode = makeDrawBlockSource(vertexCode);
+        if (blockCode.empty())
+        {
+            continue;
+        }
+        drawBlockDepthOnlyPrograms[vShader.first] = createDrawBlockProgram(blockCode, depthOnlyFragmentSource);
+        drawBlockOverdrawPrograms[vShader.first] = createDrawBlockProgram(blockCode, overdrawFragmentSource);
+        for (const auto &fShader : fragmentShaderPaths)
+        {
+            drawBlockPrograms[vShader.first + "_" + fShader.first] =
+                createDrawBlockProgram(blockCode, loadShaderSource(fShader.second));
+        }
+    }
+
+    // 为每个片段着色器创建粒子实例化绘制程序
+    for (const auto &fShader : fragmentShaderPaths)
+    {
+        particlePrograms[fShader.first] = createProgramFromSource(particleVertexSource,
+                                                                  loadShaderSource(fShader.second));
+    }
+
+    // 建立按索引查找的程序表，每帧切换程序时不再拼接名称和查找哈希表
+    for (int v = 0; v < vertexShaderCount; ++v)
+    {
+        for (int f = 0; f < fragmentShaderCount; ++f)
+        {
+            auto it = shaderPrograms.find(getProgramName(v, f));
+            programTable[v][f] = it != shaderPrograms.end() ? it->second : 0;
+            auto block = drawBlockPrograms.find(getProgramName(v, f));
+            drawBlockTable[v][f] = block != drawBlockPrograms.end() ? block->second : 0;
+        }
+    }
+
     // 设置默认 shader 程序
     currentProgram = shaderPrograms["normal_normal"];
+    currentProgramName = "normal_normal";
+
+    // 之后通过createShaderProgram创建的程序重新加载文件，编辑后的着色器可以生效
+    cacheSources = false;
+    sourceCache.clear();
 }
 
 void Shader::cleanup()
 {
     for (auto &program : shaderPrograms)
     {
-        glDeleteProgram(program.second);
+        deleteShaderProgram(program.second);
     }
     shaderPrograms.clear();
+    for (auto &program : depthOnlyPrograms)
+    {
+        deleteShaderProgram(program.second);
+    }
+    depthOnlyPrograms.clear();
+    for (auto &program : overdrawPrograms)
+    {
+        deleteShaderProgram(program.second);
+    }
+    overdrawPrograms.clear();
+    for (auto &program : particlePrograms)
+    {
+        deleteShaderProgram(program.second);
+    }
+    particlePrograms.clear();
+    for (auto *programs : {&drawBlockPrograms, &drawBlockDepthOnlyPrograms, &drawBlockOverdrawPrograms})
+    {
+        for (auto &program : *programs)
+        {
+            deleteShaderProgram(program.second);
+        }
+        programs->clear();
+    }
+    std::fill(&programTable[0][0], &programTable[0][0] + vertexShaderCount * fragmentShaderCount, 0u);
+    std::fill(&drawBlockTable[0][0], &drawBlockTable[0][0] + vertexShaderCount * fragmentShaderCount, 0u);
     currentProgram = 0;
 }
 
@@ -125,6 +250,10 @@ void Shader::setCurrentProgram(const std::string &name)
     if (it != shaderPrograms.end())
     {
         currentProgram = it->second;
+        if (currentProgramName != name)
+        {
+            currentProgramName = name;
+        }
         use();
     }
     else
@@ -135,47 +264,121 @@ void Shader::setCurrentProgram(const std::string &name)
 
 void Shader::useShaderProgram(int vertexShaderIndex, int fragmentShaderIndex)
 {
-    // 将索引转换为字符串键
-    std::string vertexKey;
-    std::string fragmentKey;
+    GLuint program = getProgram(vertexShaderIndex, fragmentShaderIndex);
+    if (program == 0)
+    {
+        // 程序表中没有时按名称查找，输出与setCurrentProgram一致的错误信息
+        setCurrentProgram(getProgramName(vertexShaderIndex, fragmentShaderIndex));
+        return;
+    }
+
+    // 名称来自静态表，赋值复用currentProgramName的容量
+    currentProgram = program;
+    const std::string &name = getProgramName(vertexShaderIndex, fragmentShaderIndex);
+    if (currentProgramName != name)
+    {
+        currentProgramName = name;
+    }
+    use();
+}
+
+GLuint Shader::getProgram(int vertexShaderIndex, int fragmentShaderIndex, bool drawBlock) const
+{
+    // 超出范围的索引与getVertexShaderName/getFragmentShaderName一致，回退到normal
+    int v = vertexShaderIndex >= 0 && vertexShaderIndex < vertexShaderCount ? vertexShaderIndex : 0;
+    int f = fragmentShaderIndex >= 0 && fragmentShaderIndex < fragmentShaderCount ? fragmentShaderIndex : 0;
+    return drawBlock ? drawBlockTable[v][f] : programTable[v][f];
+}
 
-    switch (vertexShaderIndex)
+const std::string &Shader::getProgramName(int vertexShaderIndex, int fragmentShaderIndex)
+{
+    static const auto names = []
+    {
+        std::vector<std::string> table;
+        for (int v = 0; v < vertexShaderCount; ++v)
+        {
+            for (int f = 0; f < fragmentShaderCount; ++f)
+            {
+                table.push_back(std::string(getVertexShaderName(v)) + "_" + getFragmentShaderName(f));
+            }
+        }
+        return table;
+    }();
+    int v = vertexShaderIndex >= 0 && vertexShaderIndex < vertexShaderCount ? vertexShaderIndex : 0;
+    int f = fragmentShaderIndex >= 0 && fragmentShaderIndex < fragmentShaderCount ? fragmentShaderIndex : 0;
+    return names[v * fragmentShaderCount + f];
+}
+
+GLuint Shader::getDepthOnlyProgram(int vertexShaderIndex, bool drawBlock) const
+{
+    const auto &programs = drawBlock ? drawBlockDepthOnlyPrograms : depthOnlyPrograms;
+    auto it = programs.find(getVertexShaderName(vertexShaderIndex));
+    return it != programs.end() ? it->second : 0;
+}
+
+GLuint Shader::getOverdrawProgram(int vertexShaderIndex, bool drawBlock) const
+{
+    const auto &programs = drawBlock ? drawBlockOverdrawPrograms : overdrawPrograms;
+    auto it = programs.find(getVertexShaderName(vertexShaderIndex));
+    return it != programs.end() ? it->second : 0;
+}
+
+GLuint Shader::getParticleProgram(int fragmentShaderIndex) const
+{
+    auto it = particlePrograms.find(getFragmentShaderName(fragmentShaderIndex));
+    return it != particlePrograms.end() ? it->second : 0;
+}
+
+const char *Shader::getVertexShaderName(int index)
+{
+    switch (index)
     {
-    case 0:
-        vertexKey = "normal";
-        break;
     case 1:
-        vertexKey = "wave";
-        break;
+        return "wave";
     case 2:
-        vertexKey = "breathing";
-        break;
+        return "breathing";
     default:
-        vertexKey = "normal";
-        break;
+        return "normal";
     }
+}
 
-    switch (fragmentShaderIndex)
+const char *Shader::getFragmentShaderName(int index)
+{
+    switch (index)
     {
-    case 0:
-        fragmentKey = "normal";
-        break;
     case 1:
-        fragmentKey = "pulse";
-        break;
+        return "pulse";
     case 2:
-        fragmentKey = "rainbow";
-        break;
+        return "rainbow";
+    case 3:
+        return "textured";
     default:
-        fragmentKey = "normal";
-        break;
+        return "normal";
     }
+}
 
-    // 组合成shader程序名称
-    std::string programName = vertexKey + "_" + fragmentKey;
+int Shader::findVertexShaderIndex(const std::string &name)
+{
+    for (int i = 0; i < vertexShaderCount; ++i)
+    {
+        if (name == getVertexShaderName(i) || name == std::to_string(i))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
 
-    // 设置当前shader程序
-    setCurrentProgram(programName);
+int Shader::findFragmentShaderIndex(const std::string &name)
+{
+    for (int i = 0; i < fragmentShaderCount; ++i)
+    {
+        if (name == getFragmentShaderName(i) || name == std::to_string(i))
+        {
+            return i;
+        }
+    }
+    return -1;
 }
 
 GLuint Shader::createShader(const std::string &vertexPath, const std::string &fragmentPath)
@@ -183,16 +386,29 @@ GLuint Shader::createShader(const std::string &vertexPath, const std::string &fr
     std::string vertexCode = loadShaderSource(vertexPath);
     std::string fragmentCode = loadShaderSource(fragmentPath);
 
+    return createProgramFromSource(vertexCode, fragmentCode);
+}
+
+GLuint Shader::createProgramFromSource(const std::string &vertexCode, const std::string &fragmentCode,
+                                      const char *owner)
+{
     GLuint vertexShader = compileShader(vertexCode, GL_VERTEX_SHADER);
     GLuint fragmentShader = compileShader(fragmentCode, GL_FRAGMENT_SHADER);
 
+    auto start = std::chrono::steady_clock::now();
+
     GLuint program = glCreateProgram();
     glAttachShader(program, vertexShader);
     glAttachShader(program, fragmentShader);
     glLinkProgram(program);
 
+    // 读取链接状态会等待驱动完成链接，因此计时包含在内
     GLint success;
     glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    linkTimeMs += elapsed.count();
+    ++linkCount;
     if (!success)
     {
         char infoLog[512];
@@ -206,13 +422,105 @@ GLuint Shader::createShader(const std::string &vertexPath, const std::string &fr
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
 
+    MemoryTracker::getInstance().trackGpu(GpuResourceKind::Program, program,
+                                          MemoryTracker::programBytes(program), owner);
+    return program;
+}
+
+GLuint Shader::createFeedbackProgram(const std::string &vertexCode, const std::vector<const char *> &varyings,
+                                     const char *owner)
+{
+    GLuint vertexShader = compileShader(vertexCode, GL_VERTEX_SHADER);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // 输出变量必须在链接前声明，交错写入同一个缓冲区
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glTransformFeedbackVaryings(program, static_cast<GLsizei>(varyings.size()), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    linkTimeMs += elapsed.count();
+    ++linkCount;
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+                  << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glDeleteShader(vertexShader);
+
+    MemoryTracker::getInstance().trackGpu(GpuResourceKind::Program, program,
+                                          MemoryTracker::programBytes(program), owner);
     return program;
 }
 
+std::string Shader::makeDrawBlockSource(const std::string &vertexCode)
+{
+    // uniform块的成员在GLSL中直接按名称访问，着色器主体不需要修改
+    const std::string declaration = "uniform mat4 model;";
+    size_t position = vertexCode.find(declaration);
+    if (position == std::string::npos)
+    {
+        return std::string();
+    }
+    std::string blockCode = vertexCode;
+    blockCode.replace(position, declaration.size(), "layout (std140) uniform DrawData\n{\n    mat4 model;\n};");
+    return blockCode;
+}
+
+GLuint Shader::createDrawBlockProgram(const std::string &vertexCode, const std::string &fragmentCode)
+{
+    GLuint program = createProgramFromSource(vertexCode, fragmentCode, "RenderQueue");
+    if (program == 0)
+    {
+        return 0;
+    }
+    GLuint blockIndex = glGetUniformBlockIndex(program, "DrawData");
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(program, blockIndex, drawDataBinding);
+    }
+    return program;
+}
+
+void Shader::deleteShaderProgram(GLuint program)
+{
+    if (program != 0)
+    {
+        MemoryTracker::getInstance().untrackGpu(GpuResourceKind::Program, program);
+        glDeleteProgram(program);
+    }
+}
+
 bool Shader::loadShaderPathsFromIni(const std::string &filename)
 {
+    auto start = std::chrono::steady_clock::now();
+
+    // 运行目录下的INI优先，不存在时使用内嵌版本
     CSimpleIniA ini;
     SI_Error rc = ini.LoadFile(filename.c_str());
+    const EmbeddedAsset *embedded = EmbeddedAssets::find(filename);
+    if (rc >= 0)
+    {
+        ++sourceFileReads;
+    }
+    else if (embedded != nullptr)
+    {
+        rc = ini.LoadData(embedded->data.data(), embedded->data.size());
+        ++embeddedSourceCount;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    sourceLoadTimeMs += elapsed.count();
     if (rc < 0)
     {
         std::cerr << "Failed to load INI file: " << filename << std::endl;
@@ -232,10 +540,12 @@ bool Shader::loadShaderPathsFromIni(const std::string &filename)
     }
 
     // 加载片段 shader 路径
-    const char *fragmentShaders[] = {"normal", "pulse", "rainbow"};
-    for (int i = 0; i < 3; ++i)
+    // 旧的INI文件没有textured项时使用同名文件
+    const char *fragmentShaders[] = {"normal", "pulse", "rainbow", "textured"};
+    for (int i = 0; i < fragmentShaderCount; ++i)
     {
-        std::string path = fragmentDir + "/" + ini.GetValue("FragmentShaders", fragmentShaders[i], "");
+        std::string fallback = std::string(fragmentShaders[i]) + ".frag";
+        std::string path = fragmentDir + "/" + ini.GetValue("FragmentShaders", fragmentShaders[i], fallback.c_str());
         fragmentShaderPaths[fragmentShaders[i]] = path;
     }
 
@@ -244,6 +554,8 @@ bool Shader::loadShaderPathsFromIni(const std::string &filename)
 
 GLuint Shader::compileShader(const std::string &source, GLenum type)
 {
+    auto start = std::chrono::steady_clock::now();
+
     GLuint shader = glCreateShader(type);
     const char *src = source.c_str();
     glShaderSource(shader, 1, &src, NULL);
@@ -251,6 +563,9 @@ GLuint Shader::compileShader(const std::string &source, GLenum type)
 
     GLint success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    compileTimeMs += elapsed.count();
     if (!success)
     {
         char infoLog[512];
@@ -266,22 +581,47 @@ GLuint Shader::compileShader(const std::string &source, GLenum type)
 
 std::string Shader::loadShaderSource(const std::string &path)
 {
-    std::string code;
-    std::ifstream shaderFile;
-    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    if (cacheSources)
+    {
+        auto cached = sourceCache.find(path);
+        if (cached != sourceCache.end())
+        {
+            return cached->second;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
 
-    try
+    // 运行目录下的文件优先，便于不重新构建就修改内嵌的着色器
+    std::string code;
+    const EmbeddedAsset *embedded = EmbeddedAssets::find(path);
+    std::ifstream shaderFile(path);
+    if (shaderFile)
     {
-        shaderFile.open(path);
         std::stringstream shaderStream;
         shaderStream << shaderFile.rdbuf();
-        shaderFile.close();
         code = shaderStream.str();
+        ++sourceFileReads;
+        if (embedded != nullptr && hashAssetBytes(code) != embedded->dataHash)
+        {
+            std::cout << "Shader file overrides embedded source: " << path << std::endl;
+        }
     }
-    catch (std::ifstream::failure &e)
+    else if (embedded != nullptr)
+    {
+        code.assign(embedded->data);
+        ++embeddedSourceCount;
+    }
+    else
     {
         std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
     }
 
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    sourceLoadTimeMs += elapsed.count();
+    if (cacheSources)
+    {
+        sourceCache[path] = code;
+    }
     return code;
-}
\ No newline at end of file
+}
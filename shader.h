@@ -90,6 +90,13 @@ public:
      */
     GLuint getCurrentProgram() const { return currentProgram; }
 
+    /**
+     * @brief 获取当前使用的着色器程序名称
+     * @return const std::string& 当前着色器程序名称，例如 "normal_normal"
+     * @details 名称在切换程序时缓存，调用方无需遍历程序映射
+     */
+    const std::string &getCurrentProgramName() const { return currentProgramName; }
+
     /**
      * @brief 获取所有着色器程序的映射
      * @return const std::unordered_map<std::string, GLuint>& 着色器程序映射
@@ -109,6 +116,117 @@ public:
      */
     void useShaderProgram(int vertexShaderIndex, int fragmentShaderIndex);
 
+    static constexpr int vertexShaderCount = 3;   // 顶点着色器数量
+    static constexpr int fragmentShaderCount = 4; // 片段着色器数量（最后一个为纹理材质）
+    static constexpr GLuint drawDataBinding = 0;  // DrawData uniform块使用的绑定点
+
+    /**
+     * @brief 获取顶点和片段着色器组合的程序
+     * @param vertexShaderIndex 顶点着色器索引
+     * @param fragmentShaderIndex 片段着色器索引
+     * @param drawBlock 为true时返回model来自DrawData uniform块的变体
+     * @return GLuint 着色器程序，不存在时返回0
+     * @details DrawData变体供渲染队列使用，每次绘制用glBindBufferRange切换model，不再调用glUniform
+     */
+    GLuint getProgram(int vertexShaderIndex, int fragmentShaderIndex, bool drawBlock = false) const;
+
+    /**
+     * @brief 获取只写深度的着色器程序
+     * @param vertexShaderIndex 顶点着色器索引
+     * @param drawBlock 为true时返回model来自DrawData uniform块的变体
+     * @return GLuint 由该顶点着色器和空片段着色器组成的程序，用于深度预通道
+     */
+    GLuint getDepthOnlyProgram(int vertexShaderIndex, bool drawBlock = false) const;
+
+    /**
+     * @brief 获取统计过度绘制的着色器程序
+     * @param vertexShaderIndex 顶点着色器索引
+     * @param drawBlock 为true时返回model来自DrawData uniform块的变体
+     * @return GLuint 由该顶点着色器和计数片段着色器组成的程序，配合加法混合使用
+     */
+    GLuint getOverdrawProgram(int vertexShaderIndex, bool drawBlock = false) const;
+
+    /**
+     * @brief 获取实例化绘制粒子的着色器程序
+     * @param fragmentShaderIndex 片段着色器索引
+     * @return GLuint 由内置粒子顶点着色器和该片段着色器组成的程序，实例位置来自location=2
+     */
+    GLuint getParticleProgram(int fragmentShaderIndex) const;
+
+    /**
+     * @brief 获取顶点和片段着色器组合的程序名称
+     * @param vertexShaderIndex 顶点着色器索引
+     * @param fragmentShaderIndex 片段着色器索引
+     * @return const std::string& 程序名称，例如 "wave_pulse"，引用静态表，不构造临时字符串
+     */
+    static const std::string &getProgramName(int vertexShaderIndex, int fragmentShaderIndex);
+
+    /**
+     * @brief 获取顶点着色器名称
+     * @param index 顶点着色器索引，超出范围时返回"normal"
+     * @return const char* 顶点着色器名称
+     */
+    static const char *getVertexShaderName(int index);
+
+    /**
+     * @brief 获取片段着色器名称
+     * @param index 片段着色器索引，超出范围时返回"normal"
+     * @return const char* 片段着色器名称
+     */
+    static const char *getFragmentShaderName(int index);
+
+    /**
+     * @brief 按名称查找顶点着色器索引
+     * @param name 顶点着色器名称或索引字符串，例如 "wave" 或 "1"
+     * @return int 顶点着色器索引，未找到时返回-1
+     */
+    static int findVertexShaderIndex(const std::string &name);
+
+    /**
+     * @brief 按名称查找片段着色器索引
+     * @param name 片段着色器名称或索引字符串，例如 "pulse" 或 "1"
+     * @return int 片段着色器索引，未找到时返回-1
+     */
+    static int findFragmentShaderIndex(const std::string &name);
+
+    /**
+     * @brief 获取累计的着色器编译耗时
+     * @return double 所有compileShader调用的CPU耗时之和（毫秒）
+     * @details 编译耗时包含读取编译状态时驱动的同步等待
+     */
+    double getCompileTimeMs() const { return compileTimeMs; }
+
+    /**
+     * @brief 获取累计的程序链接耗时
+     * @return double 所有程序链接的CPU耗时之和（毫秒）
+     */
+    double getLinkTimeMs() const { return linkTimeMs; }
+
+    /**
+     * @brief 获取已链接的程序数
+     * @return int 成功或失败的链接次数
+     */
+    int getLinkCount() const { return linkCount; }
+
+    /**
+     * @brief 获取累计的着色器源代码和INI加载耗时
+     * @return double 读取文件或取得内嵌资源的CPU耗时之和（毫秒）
+     * @details 比较普通构建和EMBED_ASSETS构建的这一项即可得到内嵌资源节省的启动时间
+     */
+    double getSourceLoadTimeMs() const { return sourceLoadTimeMs; }
+
+    /**
+     * @brief 获取从文件读取的源代码和INI数
+     * @return int 读取文件的次数，同一文件在init期间只读取一次
+     */
+    int getSourceFileReads() const { return sourceFileReads; }
+
+    /**
+     * @brief 获取使用内嵌版本的源代码和INI数
+     * @return int 运行目录下没有对应文件、使用内嵌资源的次数
+     */
+    int getEmbeddedSourceCount() const { return embeddedSourceCount; }
+
     /**
      * @brief 创建新的着色器程序
      * @param vertexPath 顶点着色器文件路径
@@ -117,9 +235,32 @@ public:
      */
     GLuint createShaderProgram(const std::string &vertexPath, const std::string &fragmentPath);
 
+    /**
+     * @brief 从源代码字符串创建着色器程序
+     * @param vertexSource 顶点着色器源代码
+     * @param fragmentSource 片段着色器源代码
+     * @param owner 内存统计中的所属模块名称，需为静态字符串
+     * @return GLuint 创建的着色器程序ID，失败时返回0
+     * @details 供UI合成、后处理等内置程序使用，程序不加入shaderPrograms映射
+     */
+    GLuint createProgramFromSource(const std::string &vertexSource, const std::string &fragmentSource,
+                                   const char *owner = "Shader");
+
+    /**
+     * @brief 创建只有顶点着色器的变换反馈程序
+     * @param vertexSource 顶点着色器源代码
+     * @param varyings 按顺序交错写入反馈缓冲区的输出变量名
+     * @param owner 内存统计中的所属模块名称，需为静态字符串
+     * @return GLuint 创建的着色器程序ID，失败时返回0
+     * @details 绘制时需启用GL_RASTERIZER_DISCARD
+     */
+    GLuint createFeedbackProgram(const std::string &vertexSource, const std::vector<const char *> &varyings,
+                                 const char *owner = "Shader");
+
     /**
      * @brief 删除着色器程序
-     * @param program 要删除的着色器程序ID
+     * @param program 要删除的着色器程序ID，为0时忽略
+     * @details 同时从内存统计中注销，createProgramFromSource创建的程序应通过此函数删除
      */
     void deleteShaderProgram(GLuint program);
 
@@ -150,16 +291,30 @@ private:
      * @brief 加载着色器源代码
      * @param path 着色器文件路径
      * @return std::string 着色器源代码
+     * @details 文件存在时读取文件，否则使用内嵌版本；init期间每个路径只加载一次
      */
     std::string loadShaderSource(const std::string &path);
 
     /**
      * @brief 从INI文件加载着色器路径
-     * @param filename INI文件名
+     * @param filename INI文件名，文件不存在时使用内嵌版本
      * @return bool 是否加载成功
      */
     bool loadShaderPathsFromIni(const std::string &filename);
 
+    /**
+     * @brief 把顶点着色器的model uniform改写为DrawData uniform块
+     * @param vertexCode 顶点着色器源代码
+     * @return std::string 改写后的源代码，找不到model声明时返回空字符串
+     */
+    static std::string makeDrawBlockSource(const std::string &vertexCode);
+
+    /**
+     * @brief 创建程序并把DrawData块绑定到drawDataBinding
+     * @return GLuint 着色器程序ID，失败时返回0
+     */
+    GLuint createDrawBlockProgram(const std::string &vertexCode, const std::string &fragmentCode);
+
     /**
      * @brief 检查着色器编译错误
      * @param shader 着色器ID
@@ -168,8 +323,28 @@ private:
     void checkShaderErrors(GLuint shader, const std::string &type);
 
     GLuint currentProgram = 0;                              // 当前使用的着色器程序ID
+    std::string currentProgramName = "normal_normal";      // 当前着色器程序名称
     std::unordered_map<std::string, GLuint> shaderPrograms; // 着色器程序映射
+    std::unordered_map<std::string, GLuint> depthOnlyPrograms; // 按顶点着色器名称索引的深度程序
+    std::unordered_map<std::string, GLuint> overdrawPrograms;  // 按顶点着色器名称索引的过度绘制程序
+    std::unordered_map<std::string, GLuint> particlePrograms;  // 按片段着色器名称索引的粒子绘制程序
+    std::unordered_map<std::string, GLuint> drawBlockPrograms;          // DrawData变体，按程序名称索引
+    std::unordered_map<std::string, GLuint> drawBlockDepthOnlyPrograms; // DrawData深度程序，按顶点着色器名称索引
+    std::unordered_map<std::string, GLuint> drawBlockOverdrawPrograms;  // DrawData过度绘制程序，按顶点着色器名称索引
+
+    GLuint programTable[vertexShaderCount][fragmentShaderCount] = {};   // 按索引查找的程序，init末尾由映射填充
+    GLuint drawBlockTable[vertexShaderCount][fragmentShaderCount] = {}; // 按索引查找的DrawData变体
 
     std::unordered_map<std::string, std::string> vertexShaderPaths;   // 顶点着色器路径映射
     std::unordered_map<std::string, std::string> fragmentShaderPaths; // 片段着色器路径映射
+
+    double compileTimeMs = 0.0; // 累计编译耗时
+    double linkTimeMs = 0.0;    // 累计链接耗时
+    int linkCount = 0;          // 链接次数
+
+    std::unordered_map<std::string, std::string> sourceCache; // init期间按路径缓存的源代码
+    bool cacheSources = false;      // 是否缓存源代码，只在init期间启用
+    double sourceLoadTimeMs = 0.0;  // 累计源代码和INI加载耗时
+    int sourceFileReads = 0;        // 从文件读取的次数
+    int embeddedSourceCount = 0;    // 使用内嵌资源的次数
 };
\ No newline at end of file
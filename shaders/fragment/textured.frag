@@ -0,0 +1,41 @@
+/**
+ * @file textured.frag
+ * @brief 纹理材质片段着色器
+ * @details 对材质纹理采样并用面颜色轻微着色，纹理由TextureManager流式上传
+ *
+ * 功能特点：
+ * 1. 采样绑定在纹理单元0上的材质纹理
+ * 2. 使用三线性过滤，纹理上传过程中先显示低分辨率的mip
+ * 3. 保留面颜色以区分立方体的各个面
+ *
+ * 使用方法：
+ * 1. 与任何顶点着色器配合使用，顶点着色器需输出texCoord
+ * 2. Scene按实例的材质绑定纹理
+ *
+ * 参数说明：
+ * - vertexColor: 从顶点着色器传入的面颜色
+ * - texCoord: 从顶点着色器传入的纹理坐标
+ * - diffuseTexture: 材质纹理
+ *
+ * 自定义修改：
+ * 1. 调整面颜色的影响：修改mix函数的0.3系数
+ * 2. 添加纹理平铺：对texCoord乘以平铺次数
+ */
+
+#version 330 core
+// 从顶点着色器接收的颜色
+in vec3 vertexColor;
+// 从顶点着色器接收的纹理坐标
+in vec2 texCoord;
+// 输出的片段颜色
+out vec4 FragColor;
+
+// 材质纹理
+uniform sampler2D diffuseTexture;
+
+void main()
+{
+    vec3 albedo = texture(diffuseTexture, texCoord).rgb;
+    // 用面颜色轻微着色，保留立方体各面的区分
+    FragColor = vec4(albedo * mix(vec3(1.0), vertexColor, 0.3), 1.0);
+}
@@ -32,9 +32,13 @@
 layout (location = 0) in vec3 aPos;
 // 顶点颜色输入，location=1表示这是第二个顶点属性
 layout (location = 1) in vec3 aColor;
+// 纹理坐标输入，location=3（location=2留给粒子实例位置）
+layout (location = 3) in vec2 aTexCoord;
 
 // 输出到片段着色器的颜色
 out vec3 vertexColor;
+// 输出到片段着色器的纹理坐标
+out vec2 texCoord;
 
 // 变换矩阵
 uniform mat4 model;
@@ -47,6 +51,8 @@ void main()
 {
     // 首先传递颜色，在进行任何变换之前
     vertexColor = aColor;
+    // 传递纹理坐标，供textured.frag采样
+    texCoord = aTexCoord;
     
     // 创建呼吸效果
     // sin(time * 2.0)生成-1到1的波动
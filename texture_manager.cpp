@@ -0,0 +1,633 @@
+#include "texture_manager.h"
+#include "memory_tracker.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    constexpr int proceduralPatternCount = 8; // 程序化图案数
+    constexpr int decodeThreadCount = 2;      // 解码线程数
+
+    double secondsNow()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 整数哈希，程序化图案的噪声来源
+    uint32_t hash2(uint32_t x, uint32_t y, uint32_t seed)
+    {
+        uint32_t h = x * 374761393u + y * 668265263u + seed * 2246822519u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        return h ^ (h >> 16);
+    }
+
+    // 双线性插值的值噪声，返回0~1
+    float valueNoise(float x, float y, uint32_t seed)
+    {
+        int x0 = static_cast<int>(std::floor(x));
+        int y0 = static_cast<int>(std::floor(y));
+        float fx = x - x0;
+        float fy = y - y0;
+        auto corner = [seed](int cx, int cy)
+        {
+            return (hash2(static_cast<uint32_t>(cx), static_cast<uint32_t>(cy), seed) & 0xFFFF) / 65535.0f;
+        };
+        float top = corner(x0, y0) + (corner(x0 + 1, y0) - corner(x0, y0)) * fx;
+        float bottom = corner(x0, y0 + 1) + (corner(x0 + 1, y0 + 1) - corner(x0, y0 + 1)) * fx;
+        return top + (bottom - top) * fy;
+    }
+
+    // 跳过PPM头中的空白和注释
+    void skipPpmSpace(std::istream &stream)
+    {
+        while (stream)
+        {
+            int c = stream.peek();
+            if (c == '#')
+            {
+                std::string comment;
+                std::getline(stream, comment);
+            }
+            else if (std::isspace(c))
+            {
+                stream.get();
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+}
+
+void TextureManager::init()
+{
+    compressionSupported = GLEW_EXT_texture_compression_s3tc != 0;
+
+    // 白色默认纹理，材质尚未上传任何mip时使用
+    const uint8_t white[4] = {255, 255, 255, 255};
+    glGenTextures(1, &whiteTexture);
+    glBindTexture(GL_TEXTURE_2D, whiteTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    MemoryTracker::getInstance().trackGpu(GpuResourceKind::Texture, whiteTexture, 4, "Textures");
+
+    glGenBuffers(ringSize, ringBuffers);
+    for (GLuint buffer : ringBuffers)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, ringSlotBytes, nullptr, GL_STREAM_DRAW);
+        MemoryTracker::getInstance().trackGpu(GpuResourceKind::Buffer, buffer, ringSlotBytes, "Textures");
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // 程序化图案之后追加textures目录中的PPM文件
+    for (int i = 0; i < proceduralPatternCount; ++i)
+    {
+        Material material;
+        material.pattern = i;
+        materials.push_back(std::move(material));
+    }
+    std::error_code error;
+    std::vector<std::string> files;
+    for (const auto &entry : std::filesystem::directory_iterator("textures", error))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".ppm")
+        {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (const std::string &file : files)
+    {
+        Material material;
+        material.path = file;
+        materials.push_back(std::move(material));
+    }
+
+    stopping = false;
+    for (int i = 0; i < decodeThreadCount; ++i)
+    {
+        workers.emplace_back(&TextureManager::workerMain, this);
+    }
+    reload();
+}
+
+void TextureManager::cleanup()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobReady.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    results.clear();
+
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    for (Material &material : materials)
+    {
+        if (material.texture != 0)
+        {
+            tracker.untrackGpu(GpuResourceKind::Texture, material.texture);
+            glDeleteTextures(1, &material.texture);
+        }
+    }
+    materials.clear();
+
+    for (int i = 0; i < ringSize; ++i)
+    {
+        if (ringFences[i] != nullptr)
+        {
+            glDeleteSync(ringFences[i]);
+            ringFences[i] = nullptr;
+        }
+        if (ringBuffers[i] != 0)
+        {
+            tracker.untrackGpu(GpuResourceKind::Buffer, ringBuffers[i]);
+        }
+    }
+    glDeleteBuffers(ringSize, ringBuffers);
+    std::fill(ringBuffers, ringBuffers + ringSize, 0);
+
+    if (whiteTexture != 0)
+    {
+        tracker.untrackGpu(GpuResourceKind::Texture, whiteTexture);
+        glDeleteTextures(1, &whiteTexture);
+        whiteTexture = 0;
+    }
+}
+
+void TextureManager::reload()
+{
+    ++generation;
+    builtCompressed = compress && compressionSupported;
+
+    MemoryTracker &tracker = MemoryTracker::getInstance();
+    std::lock_guard<std::mutex> lock(jobMutex);
+    // 尚未开始解码的旧代任务直接丢弃，避免连续切换时队列堆积
+    jobs.clear();
+    for (int i = 0; i < static_cast<int>(materials.size()); ++i)
+    {
+        Material &material = materials[i];
+        if (material.texture != 0)
+        {
+            tracker.untrackGpu(GpuResourceKind::Texture, material.texture);
+            glDeleteTextures(1, &material.texture);
+            material.texture = 0;
+        }
+        material.image = Image();
+        material.ready = false;
+        material.nextLevel = -1;
+        material.baseLevel = -1;
+        material.bytes = 0;
+        jobs.push_back({i, generation, material.path, material.pattern});
+    }
+    jobReady.notify_all();
+}
+
+void TextureManager::workerMain()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        Image image;
+        if (!decode(job, &image))
+        {
+            std::cerr << "Failed to decode texture: " << job.path << std::endl;
+            // 解码失败时退回程序化图案，材质仍然可用
+            Job fallback = job;
+            fallback.path.clear();
+            decode(fallback, &image);
+        }
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        results.push_back(std::move(image));
+    }
+}
+
+bool TextureManager::decode(const Job &job, Image *image)
+{
+    auto start = std::chrono::steady_clock::now();
+    image->material = job.material;
+    image->generation = job.generation;
+
+    std::vector<uint8_t> pixels;
+    int width = proceduralSize;
+    int height = proceduralSize;
+    if (!job.path.empty())
+    {
+        if (!loadPpm(job.path, &pixels, &width, &height))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        generatePattern(job.pattern, proceduralSize, &pixels);
+    }
+
+    // 超过解包缓冲区大小的级别无法一次上传，直接丢弃
+    while (static_cast<long long>(width) * height * 4 > ringSlotBytes)
+    {
+        std::vector<uint8_t> smaller;
+        downsample(pixels, width, height, &smaller, &width, &height);
+        pixels.swap(smaller);
+    }
+
+    image->levels.clear();
+    image->widths.clear();
+    image->heights.clear();
+    image->levels.push_back(std::move(pixels));
+    image->widths.push_back(width);
+    image->heights.push_back(height);
+    while (width > 1 || height > 1)
+    {
+        std::vector<uint8_t> next;
+        downsample(image->levels.back(), width, height, &next, &width, &height);
+        image->levels.push_back(std::move(next));
+        image->widths.push_back(width);
+        image->heights.push_back(height);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    image->decodeMs = elapsed.count();
+    return true;
+}
+
+bool TextureManager::loadPpm(const std::string &path, std::vector<uint8_t> *pixels, int *width, int *height)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string magic;
+    file >> magic;
+    if (!file || magic != "P6")
+    {
+        return false;
+    }
+
+    int maxValue = 0;
+    skipPpmSpace(file);
+    file >> *width;
+    skipPpmSpace(file);
+    file >> *height;
+    skipPpmSpace(file);
+    file >> maxValue;
+    file.get();
+    if (!file || *width <= 0 || *height <= 0 || maxValue != 255)
+    {
+        return false;
+    }
+
+    size_t count = static_cast<size_t>(*width) * *height;
+    std::vector<uint8_t> rgb(count * 3);
+    if (!file.read(reinterpret_cast<char *>(rgb.data()), static_cast<std::streamsize>(rgb.size())))
+    {
+        return false;
+    }
+
+    pixels->resize(count * 4);
+    for (size_t i = 0; i < count; ++i)
+    {
+        (*pixels)[i * 4 + 0] = rgb[i * 3 + 0];
+        (*pixels)[i * 4 + 1] = rgb[i * 3 + 1];
+        (*pixels)[i * 4 + 2] = rgb[i * 3 + 2];
+        (*pixels)[i * 4 + 3] = 255;
+    }
+    return true;
+}
+
+void TextureManager::generatePattern(int pattern, int size, std::vector<uint8_t> *pixels)
+{
+    pixels->resize(static_cast<size_t>(size) * size * 4);
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            float u = static_cast<float>(x) / size;
+            float v = static_cast<float>(y) / size;
+            float r = 1.0f, g = 1.0f, b = 1.0f;
+            switch (pattern % proceduralPatternCount)
+            {
+            case 0: // 棋盘格
+            {
+                bool odd = ((x / 64) + (y / 64)) % 2 != 0;
+                r = g = b = odd ? 0.25f : 0.9f;
+                break;
+            }
+            case 1: // 砖墙
+            {
+                int row = y / 32;
+                int shifted = x + (row % 2) * 32;
+                bool mortar = y % 32 < 3 || shifted % 64 < 3;
+                float noise = valueNoise(u * 32.0f, v * 32.0f, 1u) * 0.2f;
+                r = mortar ? 0.8f : 0.6f + noise;
+                g = mortar ? 0.8f : 0.25f + noise * 0.5f;
+                b = mortar ? 0.75f : 0.2f;
+                break;
+            }
+            case 2: // 斜条纹
+            {
+                bool stripe = ((x + y) / 32) % 2 != 0;
+                r = stripe ? 0.95f : 0.2f;
+                g = stripe ? 0.8f : 0.2f;
+                b = 0.1f;
+                break;
+            }
+            case 3: // 多倍频值噪声
+            {
+                float n = 0.5f * valueNoise(u * 8.0f, v * 8.0f, 3u) + 0.3f * valueNoise(u * 16.0f, v * 16.0f, 4u) +
+                          0.2f * valueNoise(u * 32.0f, v * 32.0f, 5u);
+                r = 0.3f + 0.4f * n;
+                g = 0.5f + 0.4f * n;
+                b = 0.2f + 0.2f * n;
+                break;
+            }
+            case 4: // 同心圆
+            {
+                float d = std::sqrt((u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f));
+                float ring = 0.5f + 0.5f * std::sin(d * 60.0f);
+                r = 0.3f + 0.6f * ring;
+                g = 0.2f;
+                b = 0.9f - 0.6f * ring;
+                break;
+            }
+            case 5: // 网格
+            {
+                bool line = x % 32 < 2 || y % 32 < 2;
+                r = line ? 0.1f : 0.85f;
+                g = line ? 0.6f : 0.9f;
+                b = line ? 0.9f : 0.95f;
+                break;
+            }
+            case 6: // 圆点
+            {
+                float cx = (x % 64) - 32.0f;
+                float cy = (y % 64) - 32.0f;
+                bool dot = cx * cx + cy * cy < 18.0f * 18.0f;
+                r = dot ? 0.95f : 0.15f;
+                g = dot ? 0.3f : 0.15f;
+                b = dot ? 0.4f : 0.2f;
+                break;
+            }
+            default: // 大理石
+            {
+                float n = valueNoise(u * 6.0f, v * 6.0f, 7u) + 0.5f * valueNoise(u * 12.0f, v * 12.0f, 8u);
+                float vein = 0.5f + 0.5f * std::sin((u + n * 0.5f) * 20.0f);
+                r = g = b = 0.6f + 0.35f * vein;
+                break;
+            }
+            }
+
+            uint8_t *pixel = pixels->data() + (static_cast<size_t>(y) * size + x) * 4;
+            pixel[0] = static_cast<uint8_t>(std::clamp(r, 0.0f, 1.0f) * 255.0f);
+            pixel[1] = static_cast<uint8_t>(std::clamp(g, 0.0f, 1.0f) * 255.0f);
+            pixel[2] = static_cast<uint8_t>(std::clamp(b, 0.0f, 1.0f) * 255.0f);
+            pixel[3] = 255;
+        }
+    }
+}
+
+void TextureManager::downsample(const std::vector<uint8_t> &source, int width, int height,
+                                std::vector<uint8_t> *target, int *targetWidth, int *targetHeight)
+{
+    int w = std::max(1, width / 2);
+    int h = std::max(1, height / 2);
+    target->resize(static_cast<size_t>(w) * h * 4);
+    for (int y = 0; y < h; ++y)
+    {
+        int y0 = std::min(y * 2, height - 1);
+        int y1 = std::min(y * 2 + 1, height - 1);
+        for (int x = 0; x < w; ++x)
+        {
+            int x0 = std::min(x * 2, width - 1);
+            int x1 = std::min(x * 2 + 1, width - 1);
+            for (int c = 0; c < 4; ++c)
+            {
+                int sum = source[(static_cast<size_t>(y0) * width + x0) * 4 + c] +
+                          source[(static_cast<size_t>(y0) * width + x1) * 4 + c] +
+                          source[(static_cast<size_t>(y1) * width + x0) * 4 + c] +
+                          source[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+                (*target)[(static_cast<size_t>(y) * w + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+    *targetWidth = w;
+    *targetHeight = h;
+}
+
+void TextureManager::allocateTexture(Material &material)
+{
+    const Image &image = material.image;
+    int levelCount = static_cast<int>(image.levels.size());
+    GLenum internalFormat = builtCompressed ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_RGBA8;
+
+    // 一次分配所有级别的存储，之后只用glTexSubImage2D填充；分配时不能绑定解包缓冲区
+    glGenTextures(1, &material.texture);
+    glBindTexture(GL_TEXTURE_2D, material.texture);
+    material.bytes = 0;
+    for (int level = 0; level < levelCount; ++level)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, image.widths[level], image.heights[level], 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+        if (builtCompressed)
+        {
+            GLint size = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+            material.bytes += size;
+        }
+        else
+        {
+            material.bytes += static_cast<long long>(image.widths[level]) * image.heights[level] * 4;
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levelCount - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    MemoryTracker::getInstance().trackGpu(GpuResourceKind::Texture, material.texture, material.bytes, "Textures");
+
+    material.nextLevel = levelCount - 1;
+    material.baseLevel = -1;
+}
+
+void TextureManager::update()
+{
+    if ((compress && compressionSupported) != builtCompressed)
+    {
+        reload();
+    }
+
+    // 收集解码结果，丢弃重新加载之前提交的任务
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        resultScratch.swap(results);
+    }
+    for (Image &image : resultScratch)
+    {
+        if (image.generation != generation)
+        {
+            continue;
+        }
+        Material &material = materials[image.material];
+        stats.decodeMs = image.decodeMs;
+        material.image = std::move(image);
+        material.ready = true;
+        allocateTexture(material);
+    }
+    resultScratch.clear();
+
+    long long uploaded = 0;
+    bool pending = std::any_of(materials.begin(), materials.end(), [](const Material &m) { return m.ready; });
+    int slot = ringIndex;
+    if (pending && ringFences[slot] != nullptr)
+    {
+        // 不等待：缓冲区仍被GPU读取时推迟到下一帧
+        GLenum status = glClientWaitSync(ringFences[slot], 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            ++stats.ringStalls;
+            pending = false;
+        }
+        else
+        {
+            glDeleteSync(ringFences[slot]);
+            ringFences[slot] = nullptr;
+        }
+    }
+
+    if (pending)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ringBuffers[slot]);
+        auto *mapped = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ringSlotBytes,
+                                                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        copies.clear();
+        long long budget = std::min(uploadBudgetBytes, ringSlotBytes);
+        bool full = mapped == nullptr;
+        for (int i = 0; i < static_cast<int>(materials.size()) && !full; ++i)
+        {
+            Material &material = materials[i];
+            // 从最小的mip开始，纹理很快就能以低分辨率显示
+            while (material.ready && material.nextLevel >= 0)
+            {
+                const std::vector<uint8_t> &level = material.image.levels[material.nextLevel];
+                long long size = static_cast<long long>(level.size());
+                if (!copies.empty() && uploaded + size > budget)
+                {
+                    full = true;
+                    break;
+                }
+                std::memcpy(mapped + uploaded, level.data(), level.size());
+                copies.push_back({i, material.nextLevel, static_cast<GLintptr>(uploaded)});
+                uploaded += size;
+                --material.nextLevel;
+            }
+        }
+        if (mapped != nullptr)
+        {
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        // 数据源为绑定的解包缓冲区，pixels参数是缓冲区内的偏移
+        for (const PendingCopy &copy : copies)
+        {
+            Material &material = materials[copy.material];
+            glBindTexture(GL_TEXTURE_2D, material.texture);
+            glTexSubImage2D(GL_TEXTURE_2D, copy.level, 0, 0, material.image.widths[copy.level],
+                            material.image.heights[copy.level], GL_RGBA, GL_UNSIGNED_BYTE,
+                            reinterpret_cast<const void *>(copy.offset));
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, copy.level);
+            material.baseLevel = copy.level;
+            if (copy.level == 0)
+            {
+                material.ready = false;
+                material.image = Image();
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        if (!copies.empty())
+        {
+            ringFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            ringIndex = (ringIndex + 1) % ringSize;
+        }
+    }
+
+    // 带宽按一秒窗口统计
+    double now = secondsNow();
+    if (windowStart < 0.0)
+    {
+        windowStart = now;
+    }
+    windowBytes += uploaded;
+    if (now - windowStart >= 1.0)
+    {
+        stats.uploadMBps = windowBytes / (1024.0 * 1024.0) / (now - windowStart);
+        windowBytes = 0;
+        windowStart = now;
+    }
+    stats.uploadedBytesLastFrame = uploaded;
+
+    stats.materialCount = static_cast<int>(materials.size());
+    stats.residentTextures = 0;
+    stats.pendingTextures = 0;
+    stats.residentBytes = 0;
+    for (const Material &material : materials)
+    {
+        stats.residentTextures += material.baseLevel == 0 ? 1 : 0;
+        stats.pendingTextures += material.baseLevel == 0 ? 0 : 1;
+        stats.residentBytes += material.bytes;
+    }
+    stats.compressed = builtCompressed;
+    stats.compressionSupported = compressionSupported;
+}
+
+void TextureManager::bind(int material) const
+{
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, getTexture(material));
+}
+
+GLuint TextureManager::getTexture(int material) const
+{
+    if (!materials.empty())
+    {
+        const Material &entry = materials[material % materials.size()];
+        if (entry.baseLevel >= 0)
+        {
+            return entry.texture;
+        }
+    }
+    return whiteTexture;
+}
+
+TextureStats TextureManager::getStats() const
+{
+    return stats;
+}
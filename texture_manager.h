@@ -0,0 +1,229 @@
+/**
+ * @file texture_manager.h
+ * @brief 纹理管理器头文件
+ * @details 定义了材质纹理的流式加载：工作线程解码图像并生成mip链，渲染侧通过像素解包缓冲区环
+ * 按每帧字节预算异步上传，先上传最小的mip，纹理在完整上传之前即可用低分辨率显示
+ */
+
+#pragma once
+#include <GL/glew.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct TextureStats
+ * @brief 纹理流式加载统计
+ */
+struct TextureStats
+{
+    int materialCount = 0;          // 材质数
+    int residentTextures = 0;       // 所有mip都已上传的纹理数
+    int pendingTextures = 0;        // 等待解码或上传的纹理数
+    long long residentBytes = 0;    // 纹理占用的显存（压缩格式按驱动报告的大小）
+    long long uploadedBytesLastFrame = 0; // 最近一帧上传的字节数
+    double uploadMBps = 0.0;        // 最近一秒的平均上传带宽
+    int ringStalls = 0;             // 因解包缓冲区仍被GPU读取而推迟上传的帧数
+    double decodeMs = 0.0;          // 最近一张纹理的解码和mip生成耗时
+    bool compressed = false;        // 当前纹理是否使用压缩格式
+    bool compressionSupported = false; // 设备是否支持S3TC压缩
+};
+
+/**
+ * @class TextureManager
+ * @brief 纹理管理器，使用单例模式实现
+ * @details 材质来自textures目录下的二进制PPM(P6)文件和若干程序化图案。解码线程只处理CPU数据，
+ * 结果交回渲染侧后逐级写入映射的像素解包缓冲区，再由glTexSubImage2D从缓冲区偏移读取，
+ * 复制在驱动中异步进行。环中每个缓冲区用栅栏同步，仍在使用时本帧跳过上传而不是等待
+ */
+class TextureManager
+{
+public:
+    static constexpr int ringSize = 3;                   // 像素解包缓冲区个数
+    static constexpr long long ringSlotBytes = 4LL << 20; // 每个解包缓冲区的大小，也是单个mip的上限
+    static constexpr int proceduralSize = 512;           // 程序化纹理的边长
+
+    /**
+     * @brief 获取TextureManager单例实例
+     * @return TextureManager& 单例实例的引用
+     */
+    static TextureManager &getInstance()
+    {
+        static TextureManager instance;
+        return instance;
+    }
+
+    /**
+     * @brief 创建解包缓冲区环和默认纹理，启动解码线程并提交所有材质
+     * @details 需要在GL上下文创建之后调用
+     */
+    void init();
+
+    /**
+     * @brief 停止解码线程并释放所有GL资源
+     */
+    void cleanup();
+
+    /**
+     * @brief 收集解码结果并在预算内上传
+     * @details 在渲染侧每帧调用一次，压缩设置变化时重新加载所有纹理
+     */
+    void update();
+
+    /**
+     * @brief 将材质纹理绑定到纹理单元0
+     * @param material 材质索引，尚未上传任何mip时绑定白色默认纹理
+     */
+    void bind(int material) const;
+
+    /**
+     * @brief 获取材质当前使用的纹理对象
+     * @param material 材质索引
+     * @return GLuint bind会绑定的纹理，可供命令列表录制时使用
+     */
+    GLuint getTexture(int material) const;
+
+    /**
+     * @brief 获取材质数
+     * @return int 材质数，至少为1
+     */
+    int getMaterialCount() const { return materials.empty() ? 1 : static_cast<int>(materials.size()); }
+
+    /**
+     * @brief 获取统计信息
+     * @return TextureStats 统计信息
+     */
+    TextureStats getStats() const;
+
+    bool compress = false;                   // 是否使用S3TC压缩格式（设备支持时）
+    long long uploadBudgetBytes = 1LL << 20; // 每帧最多上传的字节数（至少上传一个mip）
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    TextureManager() = default;
+    ~TextureManager() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    TextureManager(const TextureManager &) = delete;
+    TextureManager &operator=(const TextureManager &) = delete;
+
+    /**
+     * @struct Image
+     * @brief 解码后的RGBA8图像及其mip链
+     */
+    struct Image
+    {
+        int material = 0;                        // 材质索引
+        uint32_t generation = 0;                 // 提交解码时的加载代数
+        std::vector<std::vector<uint8_t>> levels; // 各级mip的像素，0为最大
+        std::vector<int> widths;                 // 各级宽度
+        std::vector<int> heights;                // 各级高度
+        double decodeMs = 0.0;                   // 解码和mip生成耗时
+    };
+
+    /**
+     * @struct Material
+     * @brief 材质纹理状态
+     */
+    struct Material
+    {
+        std::string path;     // PPM文件路径，为空时使用程序化图案
+        int pattern = 0;      // 程序化图案编号
+        GLuint texture = 0;   // 纹理对象
+        Image image;          // 等待上传的图像
+        bool ready = false;   // image是否有效
+        int nextLevel = -1;   // 下一个要上传的mip级别，-1表示已全部上传
+        int baseLevel = -1;   // 已上传的最大mip级别（作为GL_TEXTURE_BASE_LEVEL），-1表示尚未上传
+        long long bytes = 0;  // 纹理占用的显存
+    };
+
+    /**
+     * @struct Job
+     * @brief 解码任务
+     */
+    struct Job
+    {
+        int material;        // 材质索引
+        uint32_t generation; // 加载代数
+        std::string path;    // PPM文件路径
+        int pattern;         // 程序化图案编号
+    };
+
+    /**
+     * @struct PendingCopy
+     * @brief 本帧从解包缓冲区复制到纹理的一个mip
+     */
+    struct PendingCopy
+    {
+        int material;     // 材质索引
+        int level;        // mip级别
+        GLintptr offset;  // 在解包缓冲区中的偏移
+    };
+
+    /**
+     * @brief 解码线程主循环
+     */
+    void workerMain();
+
+    /**
+     * @brief 解码一个材质并生成mip链
+     * @param job 解码任务
+     * @param image 输出的图像
+     * @return bool 是否成功
+     */
+    static bool decode(const Job &job, Image *image);
+
+    /**
+     * @brief 读取二进制PPM(P6)文件为RGBA8
+     */
+    static bool loadPpm(const std::string &path, std::vector<uint8_t> *pixels, int *width, int *height);
+
+    /**
+     * @brief 生成程序化图案
+     */
+    static void generatePattern(int pattern, int size, std::vector<uint8_t> *pixels);
+
+    /**
+     * @brief 用2x2盒式滤波生成下一级mip
+     */
+    static void downsample(const std::vector<uint8_t> &source, int width, int height,
+                           std::vector<uint8_t> *target, int *targetWidth, int *targetHeight);
+
+    /**
+     * @brief 删除所有纹理并重新提交解码
+     */
+    void reload();
+
+    /**
+     * @brief 为材质创建纹理并分配所有mip的存储
+     */
+    void allocateTexture(Material &material);
+
+    std::vector<Material> materials;   // 所有材质
+    uint32_t generation = 0;           // 加载代数，重新加载后旧的解码结果被丢弃
+    bool builtCompressed = false;      // 当前纹理使用的格式
+    bool compressionSupported = false; // 设备是否支持S3TC
+    GLuint whiteTexture = 0;           // 尚未上传时使用的1x1白色纹理
+
+    GLuint ringBuffers[ringSize] = {};  // 像素解包缓冲区环
+    GLsync ringFences[ringSize] = {};   // 各缓冲区最近一次使用后的栅栏
+    int ringIndex = 0;                  // 下一个使用的缓冲区
+    std::vector<PendingCopy> copies;    // 本帧复制列表，容量在帧之间复用
+
+    std::vector<std::thread> workers;  // 解码线程
+    std::mutex jobMutex;               // 保护jobs和stopping
+    std::condition_variable jobReady;  // 有新任务或停止时唤醒解码线程
+    std::deque<Job> jobs;              // 待解码的任务
+    bool stopping = false;             // 解码线程是否应退出
+    std::mutex resultMutex;            // 保护results
+    std::vector<Image> results;        // 已解码但尚未交给渲染侧的图像
+    std::vector<Image> resultScratch;  // 取出结果时复用的容器
+
+    long long windowBytes = 0;         // 当前统计窗口内上传的字节数
+    double windowStart = -1.0;         // 当前统计窗口的开始时间（秒），负值表示尚未开始
+    TextureStats stats;                // 统计信息
+};
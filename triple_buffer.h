@@ -0,0 +1,70 @@
+/**
+ * @file triple_buffer.h
+ * @brief 无锁三缓冲头文件
+ * @details 定义了单生产者单消费者的三缓冲：写方总能立即写入空闲缓冲区并发布，
+ * 读方总能拿到最近一次发布的完整数据，双方都不会阻塞
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class TripleBuffer
+ * @brief 单生产者单消费者无锁三缓冲
+ * @tparam T 缓冲区元素类型，需可默认构造
+ * @details 三个缓冲区分别属于写方、读方和中间交换槽。发布时写方用原子交换把自己的缓冲区
+ * 放入交换槽并取回原来的交换槽；读取时读方只在交换槽带有新数据标记时才交换。
+ * 写方复用取回的缓冲区，元素中的容器容量在帧之间保留，稳定状态下不会再分配内存
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /**
+     * @brief 获取写方当前的缓冲区
+     * @return T& 可写入的缓冲区，内容是两次发布之前的旧数据
+     */
+    T &writeBuffer() { return buffers[writeIndex]; }
+
+    /**
+     * @brief 发布写方缓冲区
+     * @return bool 交换槽中上一次发布的数据是否尚未被读取（即被本次覆盖丢弃）
+     */
+    bool publish()
+    {
+        uint8_t previous = state.exchange(static_cast<uint8_t>(writeIndex | freshBit), std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+        return (previous & freshBit) != 0;
+    }
+
+    /**
+     * @brief 读取最近一次发布的数据
+     * @return bool 是否有新数据，没有新数据时读方缓冲区保持不变
+     */
+    bool fetch()
+    {
+        if ((state.load(std::memory_order_acquire) & freshBit) == 0)
+        {
+            return false;
+        }
+        uint8_t previous = state.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    /**
+     * @brief 获取读方当前的缓冲区
+     * @return const T& 最近一次fetch得到的数据
+     */
+    const T &readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr uint8_t indexMask = 0x3; // 交换槽中的缓冲区索引
+    static constexpr uint8_t freshBit = 0x4;  // 交换槽中的新数据标记
+
+    T buffers[3];                                 // 三个缓冲区
+    alignas(64) std::atomic<uint8_t> state{1};    // 交换槽：缓冲区索引和新数据标记
+    alignas(64) uint8_t writeIndex = 0;           // 写方缓冲区索引，仅写方访问
+    alignas(64) uint8_t readIndex = 2;            // 读方缓冲区索引，仅读方访问
+};
@@ -1,16 +1,54 @@
 #include "ui.h"
 #include "camera.h"
 #include "shader.h"
+#include "scene.h"
+#include "voxel_world.h"
+#include "geometry_arena.h"
+#include "memory_tracker.h"
+#include "input_recorder.h"
 #include "imgui.h"
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
 #include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace
+{
+    // 顶点着色器和片段着色器的显示名称，顺序与 Shader::useShaderProgram 的索引一致
+    const char *const vertexShaderNames[] = {"normal", "wave", "breathing"};
+    const char *const fragmentShaderNames[] = {"normal", "pulse", "rainbow", "textured"};
+
+    // 合成缓存面板使用的全屏三角形着色器
+    const char *compositeVertexSource = R"(
+#version 330 core
+out vec2 uv;
+void main()
+{
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    const char *compositeFragmentSource = R"(
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+uniform sampler2D panel;
+void main()
+{
+    // 纹理中保存的是预乘alpha颜色
+    FragColor = texture(panel, uv);
+}
+)";
+}
+
 float UI::normalizeAngle(float angle) const
 {
     // Convert to degrees
@@ -27,18 +65,121 @@ float UI::normalizeAngle(float angle) const
 
 void UI::init(GLFWwindow *window)
 {
+    this->window = window;
+
     // 初始化 ImGui
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
-    ImGuiIO &io = ImGui::GetIO();
     ImGui::StyleColorsDark();
 
     // 设置 ImGui 后端
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
+
+    // 字体图集纹理通常在第一次NewFrame时才创建，这里提前创建以便登记显存
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
+    ImGuiIO &io = ImGui::GetIO();
+    fontTexture = (GLuint)(intptr_t)io.Fonts->TexID;
+    MemoryTracker::getInstance().trackGpu(GpuResourceKind::Texture, fontTexture,
+                                          4LL * io.Fonts->TexWidth * io.Fonts->TexHeight, "ImGui");
+
+    // 创建合成缓存面板的程序和空VAO
+    compositeProgram = Shader::getInstance().createProgramFromSource(compositeVertexSource, compositeFragmentSource, "UI");
+    glGenVertexArrays(1, &compositeVAO);
+    if (compositeProgram == 0)
+    {
+        std::cerr << "Failed to create UI composite program, panel caching disabled" << std::endl;
+        cachePanel = false;
+    }
+
+    lastStatsTime = glfwGetTime();
+    markDirty();
+}
+
+bool UI::syncModel(int vertexShader, int fragmentShader, const RenderStats &stats)
+{
+    bool changed = false;
+
+    // 程序名称只在索引变化时刷新；名称由索引推出，不读取渲染侧的当前程序
+    if (model.vertexShader != vertexShader || model.fragmentShader != fragmentShader)
+    {
+        model.vertexShader = vertexShader;
+        model.fragmentShader = fragmentShader;
+        model.programName = Shader::getProgramName(vertexShader, fragmentShader);
+        changed = true;
+    }
+
+    const Camera &camera = Camera::getInstance();
+    if (model.rotationX != camera.getRotationX() ||
+        model.rotationY != camera.getRotationY() ||
+        model.cameraDistance != camera.getCameraDistance())
+    {
+        model.rotationX = camera.getRotationX();
+        model.rotationY = camera.getRotationY();
+        model.cameraDistance = camera.getCameraDistance();
+        changed = true;
+    }
+
+    // 统计信息按固定间隔刷新，避免每帧都使缓存失效
+    double now = glfwGetTime();
+    if (now - lastStatsTime >= statsRefreshSeconds)
+    {
+        long long totalFrames = redrawnFrames + cachedFrames;
+        model.statsCpuTimeMs = getLastCpuTimeMs();
+        model.statsDrawCalls = stats.uiDrawCalls;
+        model.statsCachedRatio = totalFrames > 0 ? static_cast<double>(cachedFrames) / totalFrames : 0.0;
+        model.statsRenderScale = stats.renderScale;
+        model.statsSceneGpuMs = stats.sceneGpuMs;
+        model.statsGraph = stats.graph;
+        model.statsSceneDrawCalls = stats.sceneDrawCalls;
+        model.statsSortMs = stats.sortMs;
+        model.statsShadedPerPixel = stats.shadedPerPixel;
+        model.statsOcclusionGroups = stats.occlusionGroups;
+        model.statsOccludedFraction = stats.occludedFraction;
+        model.statsStateChanges = stats.stateChanges;
+        MemoryTracker::getInstance().getStats(&model.statsMemory);
+        model.statsArenaBytes = stats.arenaBytes;
+        model.statsArenaCapacity = stats.arenaCapacity;
+        model.statsRenderThread = stats.renderThread;
+        model.statsLatencyMs = stats.latencyMs;
+        model.statsLatencyMaxMs = stats.latencyMaxMs;
+        model.statsDroppedFrames = stats.droppedFrames;
+        model.statsVoxel = stats.voxel;
+        model.statsParticles = stats.particles;
+        model.statsTextures = stats.textures;
+        model.statsGeometry = stats.geometry;
+        model.statsPick = InstancePicker::getInstance().getStats();
+        model.statsGlCalls = stats.glCalls;
+        lastStatsTime = now;
+        changed = true;
+    }
+
+    return changed;
+}
+
+bool UI::pollInputChanged()
+{
+    double cursorX = 0.0;
+    double cursorY = 0.0;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+
+    int buttons = 0;
+    for (int button = GLFW_MOUSE_BUTTON_LEFT; button <= GLFW_MOUSE_BUTTON_MIDDLE; ++button)
+    {
+        if (glfwGetMouseButton(window, button) == GLFW_PRESS)
+        {
+            buttons |= 1 << button;
+        }
+    }
+
+    bool changed = cursorX != lastCursorX || cursorY != lastCursorY || buttons != lastMouseButtons;
+    lastCursorX = cursorX;
+    lastCursorY = cursorY;
+    lastMouseButtons = buttons;
+    return changed;
 }
 
-void UI::render(int *currentVertexShaderPtr, int *currentFragmentShaderPtr)
+void UI::buildPanel(int *currentVertexShaderPtr, int *currentFragmentShaderPtr, RenderSettings *settings)
 {
     // 开始 ImGui 帧
     ImGui_ImplOpenGL3_NewFrame();
@@ -48,31 +189,18 @@ void UI::render(int *currentVertexShaderPtr, int *currentFragmentShaderPtr)
     // 创建控制面板
     ImGui::Begin("Shader Control");
 
-    // 获取当前 shader 程序名称
-    std::string currentShaderName = "normal_normal"; // 默认值
-    for (const auto &program : Shader::getInstance().getShaderPrograms())
-    {
-        if (program.second == Shader::getInstance().getCurrentProgram())
-        {
-            currentShaderName = program.first;
-            break;
-        }
-    }
-
     // 显示当前 shader 程序
-    ImGui::Text("Current Shader: %s", currentShaderName.c_str());
+    ImGui::Text("Current Shader: %s", model.programName.c_str());
 
     // 添加分隔线
     ImGui::Separator();
 
     // 显示旋转角度
-    float xAngle = Camera::getInstance().getRotationX();
-    float yAngle = Camera::getInstance().getRotationY();
-    ImGui::Text("Rotation X: %.1f°", normalizeAngle(xAngle));
-    ImGui::Text("Rotation Y: %.1f°", normalizeAngle(yAngle));
+    ImGui::Text("Rotation X: %.1f°", normalizeAngle(model.rotationX));
+    ImGui::Text("Rotation Y: %.1f°", normalizeAngle(model.rotationY));
 
     // 显示相机距离
-    ImGui::Text("Camera Distance: %.1f", Camera::getInstance().getCameraDistance());
+    ImGui::Text("Camera Distance: %.1f", model.cameraDistance);
 
     // 添加分隔线
     ImGui::Separator();
@@ -82,46 +210,450 @@ void UI::render(int *currentVertexShaderPtr, int *currentFragmentShaderPtr)
     {
         // 重置相机状态
         Camera::getInstance().init();
+        InputRecorder::getInstance().recordCameraReset();
 
         // 重置着色器选择
         *currentVertexShaderPtr = 0;   // normal
         *currentFragmentShaderPtr = 0; // normal
-        Shader::getInstance().setCurrentProgram("normal_normal");
     }
 
     // 添加分隔线
     ImGui::Separator();
 
-    // 添加 shader 选择下拉菜单
-    const char *vertexShaders[] = {"normal", "wave", "breathing"};
-    const char *fragmentShaders[] = {"normal", "pulse", "rainbow"};
+    // 着色器选择只修改索引，程序在下一帧由 Shader::useShaderProgram 切换
+    ImGui::Combo("Vertex Shader", currentVertexShaderPtr, vertexShaderNames, IM_ARRAYSIZE(vertexShaderNames));
+    ImGui::Combo("Fragment Shader", currentFragmentShaderPtr, fragmentShaderNames, IM_ARRAYSIZE(fragmentShaderNames));
 
-    // 使用传入的指针更新当前选择的着色器
-    if (ImGui::Combo("Vertex Shader", currentVertexShaderPtr, vertexShaders, IM_ARRAYSIZE(vertexShaders)))
+    // 场景与绘制顺序设置
+    ImGui::Separator();
+    Scene &scene = Scene::getInstance();
+    int instanceCount = scene.getInstanceCount();
+    if (ImGui::SliderInt("Cube Count", &instanceCount, 1, 8000))
+    {
+        scene.setInstanceCount(instanceCount);
+    }
+    ImGui::Checkbox("Front-to-Back Sort", &settings->sortFrontToBack);
+    ImGui::Checkbox("Depth Prepass", &settings->depthPrepass);
+    ImGui::Checkbox("Overdraw Heatmap", &settings->showOverdraw);
+    const char *occlusionNames[] = {"Off", "Conditional Render", "Previous Frame"};
+    int occlusionIndex = static_cast<int>(settings->occlusionMode);
+    if (ImGui::Combo("Occlusion Culling", &occlusionIndex, occlusionNames, IM_ARRAYSIZE(occlusionNames)))
+    {
+        settings->occlusionMode = static_cast<Scene::OcclusionMode>(occlusionIndex);
+    }
+    ImGui::Text("Scene Draw Calls: %d", model.statsSceneDrawCalls);
+    ImGui::Text("Sort: %.3f ms", model.statsSortMs);
+    ImGui::Text("Shaded Fragments/Pixel: %.2f", model.statsShadedPerPixel);
+    if (model.statsOcclusionGroups > 0)
+    {
+        ImGui::Text("Occluded Groups: %.1f%% of %d", model.statsOccludedFraction * 100.0, model.statsOcclusionGroups);
+    }
+
+    // 拾取：高亮索引即时显示，延迟和BVH规模随统计刷新
+    const PickStats &pick = model.statsPick;
+    ImGui::Text("Left-click a cube to pick it");
+    if (settings->highlightInstance >= 0)
+    {
+        ImGui::Text("Picked Instance: %d", settings->highlightInstance);
+    }
+    else
+    {
+        ImGui::Text("Picked Instance: none");
+    }
+    if (pick.picks > 0)
+    {
+        ImGui::Text("Pick: %.3f ms (mean %.3f, max %.3f), %d nodes, %d cube tests", pick.lastMs, pick.meanMs,
+                    pick.maxMs, pick.lastNodes, pick.lastCubeTests);
+        ImGui::Text("BVH: %d nodes, depth %d over %d instances, build %.1f ms", pick.nodes, pick.depth,
+                    pick.instances, pick.buildMs);
+    }
+
+    // 渲染队列：混合程序时对比直接提交和排序提交的状态切换次数
+    ImGui::Checkbox("Mixed Programs", &settings->mixedPrograms);
+    ImGui::Checkbox("Sorted Render Queue", &settings->renderQueue);
+    if (settings->renderQueue)
+    {
+        // 0表示在GL线程上边遍历边提交，大于0时并行录制命令列表再回放
+        ImGui::SliderInt("Command Threads", &settings->commandThreads, 0, CommandRecorder::getHardwareThreads());
+    }
+    const RenderQueueStats &changes = model.statsStateChanges;
+    ImGui::Text("Program Binds: %d, VAO Binds: %d, Texture Binds: %d", changes.programBinds, changes.vaoBinds,
+                changes.textureBinds);
+    ImGui::Text("glUniform: %d, Buffer Ranges: %d", changes.uniformCalls, changes.bufferRangeBinds);
+    if (changes.queued)
+    {
+        ImGui::Text("Queue Build: %.3f ms, Uniform Upload: %.1f KB", changes.buildMs, changes.uniformBytes / 1024.0);
+    }
+    if (changes.queued && changes.recordThreads > 0)
+    {
+        ImGui::Text("Record: %.3f ms on %d threads, Replay: %.3f ms", changes.recordMs, changes.recordThreads,
+                    changes.replayMs);
+        ImGui::Text("Command Lists: %d, Commands: %lld (%.1f KB)", changes.commandLists, changes.commands,
+                    changes.commandBytes / 1024.0);
+    }
+
+    // 体素世界：编辑请求由渲染侧在下一帧应用
+    ImGui::Separator();
+    ImGui::Checkbox("Voxel World", &settings->voxelWorld);
+    if (settings->voxelWorld)
+    {
+        const char *mesherNames[] = {"Per-Cube", "Hidden Faces Culled", "Greedy"};
+        int mesherIndex = static_cast<int>(settings->voxelMeshMode);
+        if (ImGui::Combo("Mesher", &mesherIndex, mesherNames, IM_ARRAYSIZE(mesherNames)))
+        {
+            settings->voxelMeshMode = static_cast<VoxelMeshMode>(mesherIndex);
+        }
+        if (ImGui::Button("Carve Sphere"))
+        {
+            VoxelWorld::getInstance().requestCarve();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Regenerate"))
+        {
+            VoxelWorld::getInstance().requestRegenerate(++voxelSeed);
+        }
+
+        const VoxelStats &voxel = model.statsVoxel;
+        ImGui::Text("Chunks: %d/%d meshed, %d workers", voxel.meshedChunks, voxel.chunkCount, voxel.workerCount);
+        ImGui::Text("Triangles: %lld (per-cube %lld, culled %lld)", voxel.meshTriangles, voxel.naiveTriangles,
+                    voxel.culledTriangles);
+        ImGui::Text("Reduction vs Per-Cube: %.1fx",
+                    voxel.meshTriangles > 0 ? static_cast<double>(voxel.naiveTriangles) / voxel.meshTriangles : 0.0);
+        ImGui::Text("Meshing: %.0f chunks/s (%.3f ms/chunk)", voxel.chunksPerSecond, voxel.msPerChunk);
+        ImGui::Text("Voxel GPU: %.2f MB, Upload: %.1f KB", voxel.gpuBytes / (1024.0 * 1024.0),
+                    voxel.uploadBytesLastFrame / 1024.0);
+    }
+
+    // GPU粒子：切换CPU更新可对比同样粒子数下的模拟耗时
+    ImGui::Separator();
+    ImGui::Checkbox("Particles", &settings->particles);
+    if (settings->particles)
+    {
+        ImGui::SliderInt("Particle Count", &settings->particleCount, 1000, 1000000);
+        ImGui::Checkbox("CPU Update", &settings->particleCpuUpdate);
+        const ParticleStats &particles = model.statsParticles;
+        ImGui::Text("Particles: %d (%s update)", particles.particleCount, particles.cpuUpdate ? "CPU" : "GPU");
+        ImGui::Text("Simulation: GPU %.3f ms, CPU %.3f ms", particles.gpuSimMs, particles.cpuSimMs);
+    }
+
+    // 纹理流式加载：选择textured片段着色器时使用
+    ImGui::Separator();
+    const TextureStats &textures = model.statsTextures;
+    if (textures.compressionSupported)
     {
-        // 当顶点 shader 改变时，更新 shader 程序
-        std::string newShaderName = std::string(vertexShaders[*currentVertexShaderPtr]) + "_" +
-                                    std::string(fragmentShaders[*currentFragmentShaderPtr]);
-        Shader::getInstance().setCurrentProgram(newShaderName);
+        ImGui::Checkbox("Compressed Textures (S3TC)", &settings->textureCompression);
     }
+    ImGui::SliderInt("Texture Upload Budget (KB)", &settings->textureBudgetKB, 64, 4096);
+    ImGui::Text("Textures: %d/%d resident, %d pending", textures.residentTextures, textures.materialCount,
+                textures.pendingTextures);
+    ImGui::Text("Texture Memory: %.2f MB%s", textures.residentBytes / (1024.0 * 1024.0),
+                textures.compressed ? " (compressed)" : "");
+    ImGui::Text("Upload: %.2f MB/s, Ring Stalls: %d", textures.uploadMBps, textures.ringStalls);
+    ImGui::Text("Decode + Mips: %.2f ms", textures.decodeMs);
 
-    if (ImGui::Combo("Fragment Shader", currentFragmentShaderPtr, fragmentShaders, IM_ARRAYSIZE(fragmentShaders)))
+    // 共享几何缓冲区：体素分块反复重建后碎片增多，整理在渲染侧下一帧执行
+    ImGui::Separator();
+    const GeometryArenaStats &geometry = model.statsGeometry;
+    ImGui::Text("Geometry Meshes: %d", geometry.meshes);
+    ImGui::Text("Vertex Arena: %.2f/%.2f MB (%.1f%%), %d free blocks, %.1f%% fragmented",
+                geometry.vertexUsedBytes / (1024.0 * 1024.0), geometry.vertexCapacityBytes / (1024.0 * 1024.0),
+                geometry.vertexCapacityBytes > 0 ? 100.0 * geometry.vertexUsedBytes / geometry.vertexCapacityBytes : 0.0,
+                geometry.vertexFreeBlocks, geometry.vertexFragmentation * 100.0);
+    ImGui::Text("Index Arena: %.2f/%.2f MB (%.1f%%), %d free blocks, %.1f%% fragmented",
+                geometry.indexUsedBytes / (1024.0 * 1024.0), geometry.indexCapacityBytes / (1024.0 * 1024.0),
+                geometry.indexCapacityBytes > 0 ? 100.0 * geometry.indexUsedBytes / geometry.indexCapacityBytes : 0.0,
+                geometry.indexFreeBlocks, geometry.indexFragmentation * 100.0);
+    ImGui::Text("Defragmentations: %d (last %.3f ms), Growths: %d", geometry.defragmentations,
+                geometry.lastDefragmentMs, geometry.growths);
+    if (ImGui::Button("Defragment Geometry"))
     {
-        // 当片段 shader 改变时，更新 shader 程序
-        std::string newShaderName = std::string(vertexShaders[*currentVertexShaderPtr]) + "_" +
-                                    std::string(fragmentShaders[*currentFragmentShaderPtr]);
-        Shader::getInstance().setCurrentProgram(newShaderName);
+        GeometryArena::getInstance().requestDefragment();
+    }
+
+    // 显示UI自身的开销
+    ImGui::Separator();
+    ImGui::Checkbox("Cache UI Panel", &cachePanel);
+    ImGui::Text("UI CPU: %.3f ms", model.statsCpuTimeMs);
+    ImGui::Text("UI Draw Calls: %d", model.statsDrawCalls);
+    ImGui::Text("Cached Frames: %.1f%%", model.statsCachedRatio * 100.0);
+
+    // GL调用统计：只在以GL_TRACE构建时可用
+    const GlCallStats &glCalls = model.statsGlCalls;
+    if (glCalls.enabled)
+    {
+        ImGui::Separator();
+        ImGui::Text("GL Calls/Frame: %lld (%lld redundant)", glCalls.totalCalls, glCalls.redundantCalls);
+        ImGui::Text("Identical Uniform Uploads: %lld", glCalls.identicalUniforms);
+        if (ImGui::TreeNode("GL Call Details"))
+        {
+            for (int entry = 0; entry < static_cast<int>(GlEntry::Count); ++entry)
+            {
+                if (glCalls.calls[entry] > 0)
+                {
+                    ImGui::Text("%s: %lld (%lld redundant)", GlTrace::getEntryName(static_cast<GlEntry>(entry)),
+                                glCalls.calls[entry], glCalls.redundant[entry]);
+                }
+            }
+            ImGui::TreePop();
+        }
+    }
+
+    // 渲染线程统计
+    if (model.statsRenderThread)
+    {
+        ImGui::Separator();
+        ImGui::Text("Render Thread Latency: %.2f ms (max %.2f ms)", model.statsLatencyMs, model.statsLatencyMaxMs);
+        ImGui::Text("Dropped Frames: %lld", model.statsDroppedFrames);
+    }
+
+    // 动态分辨率设置
+    ImGui::Separator();
+    ImGui::Checkbox("Dynamic Resolution", &settings->dynamicResolution);
+    ImGui::SliderFloat("GPU Budget (ms)", &settings->budgetMs, 1.0f, 33.0f, "%.1f");
+    ImGui::SliderFloat("Min Scale", &settings->minScale, 0.25f, 1.0f, "%.2f");
+    if (!settings->dynamicResolution)
+    {
+        ImGui::SliderFloat("Fixed Scale", &settings->fixedScale, settings->minScale, settings->maxScale, "%.2f");
+    }
+    const char *msaaNames[] = {"Off", "2x", "4x", "8x"};
+    const int msaaSamples[] = {0, 2, 4, 8};
+    int msaaIndex = 0;
+    for (int i = 0; i < IM_ARRAYSIZE(msaaSamples); ++i)
+    {
+        if (msaaSamples[i] == settings->msaaSamples)
+            msaaIndex = i;
+    }
+    if (ImGui::Combo("MSAA", &msaaIndex, msaaNames, IM_ARRAYSIZE(msaaNames)))
+    {
+        settings->msaaSamples = msaaSamples[msaaIndex];
+    }
+    ImGui::Text("Render Scale: %.0f%%", model.statsRenderScale * 100.0f);
+    ImGui::Text("Scene GPU: %.3f ms", model.statsSceneGpuMs);
+
+    // 渲染图统计
+    ImGui::Separator();
+    const RGStats &graphStats = model.statsGraph;
+    ImGui::Checkbox("Alias Transient Resources", &settings->aliasTransients);
+    ImGui::Checkbox("Bloom", &settings->bloom);
+    ImGui::Text("Passes: %d (culled %d)", graphStats.passCount, graphStats.culledPassCount);
+    ImGui::Text("Transient: %d -> %d physical", graphStats.resourceCount, graphStats.physicalCount);
+    ImGui::Text("Peak GPU Memory: %.2f MB (unaliased %.2f MB)",
+                graphStats.peakBytes / (1024.0 * 1024.0), graphStats.unaliasedBytes / (1024.0 * 1024.0));
+
+    // 内存统计
+    ImGui::Separator();
+    const MemoryStats &memory = model.statsMemory;
+    const double mb = 1024.0 * 1024.0;
+    ImGui::Text("CPU Heap: %.2f MB (peak %.2f MB)", memory.cpuBytes / mb, memory.cpuPeakBytes / mb);
+    ImGui::Text("Allocations/Frame: %lld (peak %lld)", memory.frameAllocations, memory.peakFrameAllocations);
+    ImGui::Text("Live Allocations: %lld", memory.cpuLiveAllocations);
+    ImGui::Text("Frame Arena: %.1f KB of %.1f KB", model.statsArenaBytes / 1024.0, model.statsArenaCapacity / 1024.0);
+    if (memory.steadyStateCheck)
+    {
+        ImGui::Text("Steady-State Alloc Frames: %lld", memory.steadyStateViolations);
+    }
+    ImGui::Text("GPU: %.2f MB (peak %.2f MB)", memory.gpuBytes / mb, memory.gpuPeakBytes / mb);
+    if (ImGui::TreeNode("GPU Memory Details"))
+    {
+        for (int kind = 0; kind < static_cast<int>(GpuResourceKind::Count); ++kind)
+        {
+            ImGui::Text("%s: %d (%.2f MB)", MemoryTracker::getKindName(static_cast<GpuResourceKind>(kind)),
+                        memory.gpuKindCount[kind], memory.gpuKindBytes[kind] / mb);
+        }
+        for (const auto &owner : memory.gpuOwners)
+        {
+            ImGui::BulletText("%s: %.2f MB", owner.first, owner.second / mb);
+        }
+        ImGui::TreePop();
     }
 
     ImGui::End();
 
-    // 渲染 ImGui
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+}
+
+bool UI::ensureCacheTarget(int width, int height)
+{
+    if (cacheFBO != 0 && width == cacheWidth && height == cacheHeight)
+    {
+        return false;
+    }
+
+    releaseCacheTarget();
+
+    glGenTextures(1, &cacheTexture);
+    glBindTexture(GL_TEXTURE_2D, cacheTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    MemoryTracker::getInstance().trackGpu(GpuResourceKind::Texture, cacheTexture, 4LL * width * height, "UI");
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &cacheFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cacheTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "UI cache framebuffer is incomplete, panel caching disabled" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        releaseCacheTarget();
+        cacheFailed.store(true, std::memory_order_release);
+        return true;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    cacheWidth = width;
+    cacheHeight = height;
+    return true;
+}
+
+void UI::compositeCache()
+{
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(compositeProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, cacheTexture);
+    glUniform1i(glGetUniformLocation(compositeProgram, "panel"), 0);
+    glBindVertexArray(compositeVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+    if (!blend)
+        glDisable(GL_BLEND);
+}
+
+void UI::releaseCacheTarget()
+{
+    if (cacheFBO != 0)
+    {
+        glDeleteFramebuffers(1, &cacheFBO);
+        cacheFBO = 0;
+    }
+    if (cacheTexture != 0)
+    {
+        MemoryTracker::getInstance().untrackGpu(GpuResourceKind::Texture, cacheTexture);
+        glDeleteTextures(1, &cacheTexture);
+        cacheTexture = 0;
+    }
+    cacheWidth = 0;
+    cacheHeight = 0;
+}
+
+void UI::buildFrame(int *currentVertexShaderPtr, int *currentFragmentShaderPtr, RenderSettings *settings,
+                    const RenderStats &stats, int width, int height, UIDrawSnapshot *snapshot)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    if (cachePanel && cacheFailed.load(std::memory_order_acquire))
+    {
+        cachePanel = false;
+    }
+
+    // 输入或内容变化时重绘面板，否则复用缓存纹理
+    bool inputChanged = pollInputChanged();
+    bool modelChanged = syncModel(*currentVertexShaderPtr, *currentFragmentShaderPtr, stats);
+    bool sizeChanged = width != builtWidth || height != builtHeight;
+    bool cacheLost = cacheInvalid.exchange(false, std::memory_order_acq_rel);
+    builtWidth = width;
+    builtHeight = height;
+    if (inputChanged || modelChanged || sizeChanged || cacheLost)
+    {
+        markDirty();
+    }
+
+    snapshot->redraw = !cachePanel || dirtyFrames > 0;
+    snapshot->cachePanel = cachePanel;
+    if (snapshot->redraw)
+    {
+        buildPanel(currentVertexShaderPtr, currentFragmentShaderPtr, settings);
+        snapshot->assign(ImGui::GetDrawData());
+
+        if (dirtyFrames > 0)
+        {
+            --dirtyFrames;
+        }
+        ++redrawnFrames;
+    }
+    else
+    {
+        ++cachedFrames;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    lastBuildTimeMs = elapsed.count();
+}
+
+void UI::drawFrame(const UIDrawSnapshot &snapshot, int width, int height)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    bool useCache = snapshot.cachePanel && compositeProgram != 0 && width > 0 && height > 0 &&
+                    !cacheFailed.load(std::memory_order_acquire);
+    bool targetChanged = useCache && ensureCacheTarget(width, height);
+    useCache = useCache && cacheFBO != 0;
+
+    if (snapshot.redraw)
+    {
+        int drawCalls = snapshot.getCommandCount();
+        if (useCache)
+        {
+            // 将面板渲染到缓存纹理，再合成到默认帧缓冲区
+            glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            snapshot.render();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, width, height);
+            compositeCache();
+            drawCalls += 1;
+        }
+        else
+        {
+            snapshot.render();
+        }
+        lastDrawCalls = drawCalls;
+    }
+    else if (useCache && !targetChanged)
+    {
+        compositeCache();
+        lastDrawCalls = 1;
+    }
+    else
+    {
+        // 缓存纹理刚被重新创建，内容为空，通知主线程下一帧重绘面板
+        cacheInvalid.store(true, std::memory_order_release);
+        lastDrawCalls = 0;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    lastDrawTimeMs.store(elapsed.count(), std::memory_order_relaxed);
 }
 
 void UI::cleanup()
 {
+    releaseCacheTarget();
+    if (compositeVAO != 0)
+    {
+        glDeleteVertexArrays(1, &compositeVAO);
+        compositeVAO = 0;
+    }
+    Shader::getInstance().deleteShaderProgram(compositeProgram);
+    compositeProgram = 0;
+
+    MemoryTracker::getInstance().untrackGpu(GpuResourceKind::Texture, fontTexture);
+    fontTexture = 0;
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -131,4 +663,4 @@ void UI::handleInput(GLFWwindow *window)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, 1);
-}
\ No newline at end of file
+}
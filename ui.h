@@ -7,12 +7,18 @@
 #pragma once
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <atomic>
 #include <string>
+#include "frame_snapshot.h"
+#include "render_graph.h"
+#include "memory_tracker.h"
+#include "instance_picker.h"
 
 /**
  * @class UI
  * @brief 用户界面管理类，使用单例模式实现
- * @details 负责创建和管理ImGui界面，处理用户交互和着色器参数调节
+ * @details 负责创建和管理ImGui界面，处理用户交互和着色器参数调节。
+ * 面板构建（buildFrame）和GL提交（drawFrame）分离，启用渲染线程时分别在主线程和渲染线程上执行
  */
 class UI
 {
@@ -35,12 +41,28 @@ public:
     void init(GLFWwindow *window);
 
     /**
-     * @brief 渲染UI界面
+     * @brief 构建UI面板并拷贝绘制数据
      * @param currentVertexShader 当前顶点着色器索引指针
      * @param currentFragmentShader 当前片段着色器索引指针
-     * @details 渲染ImGui界面并处理着色器选择
+     * @param settings 由面板修改的渲染设置
+     * @param stats 最近一次收到的渲染统计
+     * @param width 窗口帧缓冲区宽度
+     * @param height 窗口帧缓冲区高度
+     * @param snapshot 输出的UI绘制数据
+     * @details 在主线程上调用，只访问ImGui上下文和主线程拥有的状态，不发出GL调用。
+     * 输入或内容没有变化时不构建面板，绘制时直接合成缓存纹理
      */
-    void render(int *currentVertexShader, int *currentFragmentShader);
+    void buildFrame(int *currentVertexShader, int *currentFragmentShader, RenderSettings *settings,
+                    const RenderStats &stats, int width, int height, UIDrawSnapshot *snapshot);
+
+    /**
+     * @brief 绘制UI到默认帧缓冲区
+     * @param snapshot buildFrame输出的绘制数据
+     * @param width 窗口帧缓冲区宽度
+     * @param height 窗口帧缓冲区高度
+     * @details 在拥有GL上下文的线程上调用，重绘时渲染到缓存纹理再合成，否则只合成缓存纹理
+     */
+    void drawFrame(const UIDrawSnapshot &snapshot, int width, int height);
 
     /**
      * @brief 清理UI资源
@@ -55,6 +77,24 @@ public:
      */
     void handleInput(GLFWwindow *window);
 
+    /**
+     * @brief 标记UI面板需要重绘
+     * @details 滚轮、键盘、文字输入、窗口尺寸变化等不经过轮询的事件发生时调用，使缓存纹理失效
+     */
+    void markDirty() { dirtyFrames = settleFrames; }
+
+    /**
+     * @brief 获取最近一帧UI的CPU耗时
+     * @return double UI构建与提交耗时之和（毫秒）
+     */
+    double getLastCpuTimeMs() const { return lastBuildTimeMs + lastDrawTimeMs.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 获取最近一帧UI的绘制调用数
+     * @return int 重绘时为ImGui绘制命令数，使用缓存时为1（合成）
+     */
+    int getLastDrawCalls() const { return lastDrawCalls; }
+
 private:
     // 私有构造函数和析构函数，确保单例模式
     UI() : currentVertexShader(0), currentFragmentShader(0) {}
@@ -71,6 +111,121 @@ private:
      */
     float normalizeAngle(float angle) const;
 
+    /**
+     * @brief 同步缓存的UI模型
+     * @param vertexShader 当前顶点着色器索引
+     * @param fragmentShader 当前片段着色器索引
+     * @param stats 最近一次收到的渲染统计
+     * @return bool 面板显示内容是否发生变化
+     * @details 仅在程序索引变化时刷新缓存的程序名称，避免逐帧查找和字符串拷贝
+     */
+    bool syncModel(int vertexShader, int fragmentShader, const RenderStats &stats);
+
+    /**
+     * @brief 检测是否有影响UI的输入
+     * @return bool 鼠标位置或按键状态相对上一帧是否变化
+     */
+    bool pollInputChanged();
+
+    /**
+     * @brief 构建ImGui面板
+     * @param currentVertexShaderPtr 当前顶点着色器索引指针
+     * @param currentFragmentShaderPtr 当前片段着色器索引指针
+     * @param settings 由面板修改的渲染设置
+     */
+    void buildPanel(int *currentVertexShaderPtr, int *currentFragmentShaderPtr, RenderSettings *settings);
+
+    /**
+     * @brief 确保缓存纹理与帧缓冲区尺寸一致
+     * @param width 帧缓冲区宽度
+     * @param height 帧缓冲区高度
+     * @return bool 缓存纹理是否被重新创建
+     */
+    bool ensureCacheTarget(int width, int height);
+
+    /**
+     * @brief 将缓存纹理合成到当前帧缓冲区
+     */
+    void compositeCache();
+
+    /**
+     * @brief 释放缓存纹理相关的GL资源
+     */
+    void releaseCacheTarget();
+
+    /**
+     * @struct Model
+     * @brief 面板显示内容的缓存
+     * @details 面板只读取此结构，内容不变且无输入时直接合成上一次的面板纹理
+     */
+    struct Model
+    {
+        int vertexShader = -1;         // 顶点着色器索引
+        int fragmentShader = -1;       // 片段着色器索引
+        std::string programName;       // 与索引对应的程序名称
+        float rotationX = 0.0f;        // 显示的X轴旋转角度
+        float rotationY = 0.0f;        // 显示的Y轴旋转角度
+        float cameraDistance = 0.0f;   // 显示的相机距离
+        double statsCpuTimeMs = 0.0;   // 显示的UI CPU耗时
+        int statsDrawCalls = 0;        // 显示的绘制调用数
+        double statsCachedRatio = 0.0; // 显示的缓存命中率
+        float statsRenderScale = 1.0f; // 显示的场景渲染比例
+        double statsSceneGpuMs = 0.0;  // 显示的场景GPU耗时
+        RGStats statsGraph;            // 显示的渲染图统计
+        int statsSceneDrawCalls = 0;      // 显示的场景绘制调用数
+        double statsSortMs = 0.0;         // 显示的场景排序耗时
+        double statsShadedPerPixel = 0.0; // 显示的每像素着色片段数
+        int statsOcclusionGroups = 0;     // 显示的遮挡剔除组数
+        double statsOccludedFraction = 0.0; // 显示的被遮挡组比例
+        RenderQueueStats statsStateChanges; // 显示的场景状态切换统计
+        MemoryStats statsMemory;          // 显示的内存统计
+        size_t statsArenaBytes = 0;       // 显示的渲染线程上一帧帧分配器用量
+        size_t statsArenaCapacity = 0;    // 显示的帧分配器主块容量
+        bool statsRenderThread = false;   // 是否由渲染线程提交
+        double statsLatencyMs = 0.0;      // 显示的输入到呈现延迟
+        double statsLatencyMaxMs = 0.0;   // 显示的最大延迟
+        long long statsDroppedFrames = 0; // 显示的丢弃帧数
+        VoxelStats statsVoxel;            // 显示的体素世界统计
+        ParticleStats statsParticles;     // 显示的粒子系统统计
+        TextureStats statsTextures;       // 显示的纹理流式加载统计
+        GeometryArenaStats statsGeometry; // 显示的共享几何缓冲区统计
+        PickStats statsPick;              // 显示的实例拾取统计
+        GlCallStats statsGlCalls;         // 显示的GL调用统计
+    };
+
+    static constexpr int settleFrames = 3;            // 输入后继续重绘的帧数，等待悬停等状态稳定
+    static constexpr double statsRefreshSeconds = 0.5; // 统计信息刷新间隔
+
     int currentVertexShader;   // 当前顶点着色器索引
     int currentFragmentShader; // 当前片段着色器索引
+
+    Model model;                    // 缓存的UI模型
+    GLFWwindow *window = nullptr;   // UI所在窗口
+    bool cachePanel = true;         // 是否启用面板纹理缓存
+    int dirtyFrames = settleFrames; // 剩余需要重绘的帧数
+    int builtWidth = 0;             // 上次构建时的帧缓冲区宽度
+    int builtHeight = 0;            // 上次构建时的帧缓冲区高度
+    uint32_t voxelSeed = 1;         // 体素地形的当前种子
+
+    std::atomic<bool> cacheFailed{false};  // 绘制侧创建缓存纹理失败，主线程据此关闭缓存
+    std::atomic<bool> cacheInvalid{false}; // 绘制侧缓存纹理内容无效，需要重绘面板
+
+    double lastCursorX = 0.0; // 上一帧鼠标X坐标
+    double lastCursorY = 0.0; // 上一帧鼠标Y坐标
+    int lastMouseButtons = 0; // 上一帧鼠标按键位掩码
+
+    GLuint cacheFBO = 0;         // 面板缓存帧缓冲区
+    GLuint cacheTexture = 0;     // 面板缓存纹理
+    GLuint compositeProgram = 0; // 合成着色器程序
+    GLuint compositeVAO = 0;     // 全屏三角形使用的空VAO
+    GLuint fontTexture = 0;      // ImGui字体图集纹理（由后端创建，仅用于内存统计）
+    int cacheWidth = 0;          // 缓存纹理宽度
+    int cacheHeight = 0;         // 缓存纹理高度
+
+    double lastBuildTimeMs = 0.0;              // 最近一帧构建面板的CPU耗时
+    std::atomic<double> lastDrawTimeMs{0.0};    // 最近一帧提交绘制的CPU耗时
+    int lastDrawCalls = 0;       // 最近一帧UI绘制调用数
+    long long redrawnFrames = 0; // 重绘帧计数
+    long long cachedFrames = 0;  // 合成缓存帧计数
+    double lastStatsTime = 0.0;  // 上次刷新统计显示的时间
 };
\ No newline at end of file
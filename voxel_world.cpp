@@ -0,0 +1,691 @@
+#include "voxel_world.h"
+#include "frame_arena.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+static_assert(sizeof(VoxelVertex) == GeometryArena::getVertexStride(VertexFormat::VoxelPositionColor) &&
+                  offsetof(VoxelVertex, x) == 0 && offsetof(VoxelVertex, r) == 8,
+              "voxel vertex layout must match the arena format");
+
+namespace
+{
+    constexpr int paddedSize = VoxelWorld::chunkSize + 2;
+
+    // 与立方体各面颜色一致，按轴和朝向索引：[轴][0为负方向，1为正方向]
+    const uint8_t faceColors[3][2][3] = {
+        {{0, 0, 255}, {255, 255, 0}}, // -X蓝，+X黄
+        {{0, 255, 255}, {255, 0, 255}}, // -Y青，+Y品红
+        {{255, 0, 0}, {0, 255, 0}}, // -Z红，+Z绿
+    };
+
+    inline int paddedIndex(int x, int y, int z)
+    {
+        return (x + 1) + (y + 1) * paddedSize + (z + 1) * paddedSize * paddedSize;
+    }
+
+    /**
+     * @brief 输出一个四边形
+     * @param axis 法线所在的轴
+     * @param positive 法线是否朝向正方向
+     * @param base 四边形起点（体素坐标）
+     * @param width 沿axis+1轴的长度
+     * @param height 沿axis+2轴的长度
+     * @details 两条边的叉积方向为+axis，负方向的面反转顶点顺序，保证从外侧看为逆时针
+     */
+    void emitQuad(std::pmr::vector<VoxelVertex> *vertices, int axis, bool positive, const glm::ivec3 &base,
+                  int width, int height)
+    {
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+        glm::ivec3 du(0, 0, 0);
+        glm::ivec3 dv(0, 0, 0);
+        du[u] = width;
+        dv[v] = height;
+
+        glm::ivec3 corners[4] = {
+            base,
+            glm::ivec3(base.x + du.x, base.y + du.y, base.z + du.z),
+            glm::ivec3(base.x + du.x + dv.x, base.y + du.y + dv.y, base.z + du.z + dv.z),
+            glm::ivec3(base.x + dv.x, base.y + dv.y, base.z + dv.z),
+        };
+        if (!positive)
+        {
+            std::swap(corners[1], corners[3]);
+        }
+
+        const uint8_t *color = faceColors[axis][positive ? 1 : 0];
+        for (const glm::ivec3 &corner : corners)
+        {
+            VoxelVertex vertex;
+            vertex.x = static_cast<int16_t>(corner.x);
+            vertex.y = static_cast<int16_t>(corner.y);
+            vertex.z = static_cast<int16_t>(corner.z);
+            vertex.pad = 0;
+            vertex.r = color[0];
+            vertex.g = color[1];
+            vertex.b = color[2];
+            vertex.a = 255;
+            vertices->push_back(vertex);
+        }
+    }
+}
+
+void VoxelWorld::init()
+{
+    stopping = false;
+    stats.workerCount = 0;
+}
+
+void VoxelWorld::startWorkers()
+{
+    int workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    for (int i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(&VoxelWorld::workerMain, this);
+    }
+    stats.workerCount = workerCount;
+}
+
+void VoxelWorld::cleanup()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobReady.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    stats.workerCount = 0;
+
+    for (Chunk &chunk : chunks)
+    {
+        releaseChunk(chunk);
+    }
+    chunks.clear();
+    results.clear();
+    uploadQueue.clear();
+    generated = false;
+    inFlight = 0;
+
+    GeometryArena::getInstance().destroyMesh(quadIndexMesh);
+    quadIndexMesh = GeometryArena::invalidMesh;
+    quadIndexCapacity = 0;
+}
+
+void VoxelWorld::requestRegenerate(uint32_t seed)
+{
+    std::lock_guard<std::mutex> lock(editMutex);
+    edits.push_back({true, seed});
+}
+
+void VoxelWorld::requestCarve()
+{
+    std::lock_guard<std::mutex> lock(editMutex);
+    edits.push_back({false, 0});
+}
+
+void VoxelWorld::workerMain()
+{
+    // 每个工作线程有自己的帧分配器，一个任务相当于一帧，任务结束时整体重置
+    FrameArena &arena = FrameArena::forThread();
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        int cx = job.chunk % chunksX;
+        int cy = (job.chunk / chunksX) % chunksY;
+        int cz = job.chunk / (chunksX * chunksY);
+        glm::ivec3 origin(cx * chunkSize, cy * chunkSize, cz * chunkSize);
+
+        auto start = std::chrono::steady_clock::now();
+        Result result;
+        result.chunk = job.chunk;
+        result.version = job.version;
+        {
+            std::pmr::vector<VoxelVertex> vertices(&arena);
+            meshChunk(job.padded.data(), origin, job.mode, &vertices, &result.visibleFaces);
+            // 结果按实际大小拷贝到堆上交给主线程，临时数组随分配器重置一起释放
+            result.vertices.assign(vertices.begin(), vertices.end());
+        }
+        arena.reset();
+        result.finished = std::chrono::steady_clock::now();
+        result.meshMs = std::chrono::duration<double, std::milli>(result.finished - start).count();
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        results.push_back(std::move(result));
+    }
+}
+
+void VoxelWorld::meshChunk(const uint8_t *padded, const glm::ivec3 &origin, VoxelMeshMode mode,
+                           std::pmr::vector<VoxelVertex> *vertices, int *visibleFaces)
+{
+    *visibleFaces = 0;
+    const int offsets[3] = {1, paddedSize, paddedSize * paddedSize};
+
+    if (mode != VoxelMeshMode::Greedy)
+    {
+        for (int z = 0; z < chunkSize; ++z)
+        {
+            for (int y = 0; y < chunkSize; ++y)
+            {
+                for (int x = 0; x < chunkSize; ++x)
+                {
+                    int index = paddedIndex(x, y, z);
+                    if (padded[index] == 0)
+                    {
+                        continue;
+                    }
+
+                    glm::ivec3 position(origin.x + x, origin.y + y, origin.z + z);
+                    for (int axis = 0; axis < 3; ++axis)
+                    {
+                        for (int side = 0; side < 2; ++side)
+                        {
+                            bool hidden = padded[side ? index + offsets[axis] : index - offsets[axis]] != 0;
+                            *visibleFaces += hidden ? 0 : 1;
+                            if (hidden && mode == VoxelMeshMode::Culled)
+                            {
+                                continue;
+                            }
+
+                            glm::ivec3 base = position;
+                            base[axis] += side;
+                            emitQuad(vertices, axis, side != 0, base, 1, 1);
+                        }
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // 贪心合并：逐轴、逐朝向、逐层构建可见面掩码，每次取最长的行再向下扩展成矩形
+    bool mask[chunkSize * chunkSize];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+        for (int side = 0; side < 2; ++side)
+        {
+            int neighbor = side ? offsets[axis] : -offsets[axis];
+            for (int layer = 0; layer < chunkSize; ++layer)
+            {
+                glm::ivec3 cell(0, 0, 0);
+                cell[axis] = layer;
+                bool any = false;
+                for (int j = 0; j < chunkSize; ++j)
+                {
+                    cell[v] = j;
+                    for (int i = 0; i < chunkSize; ++i)
+                    {
+                        cell[u] = i;
+                        int index = paddedIndex(cell.x, cell.y, cell.z);
+                        bool visible = padded[index] != 0 && padded[index + neighbor] == 0;
+                        mask[i + j * chunkSize] = visible;
+                        any = any || visible;
+                    }
+                }
+                if (!any)
+                {
+                    continue;
+                }
+
+                for (int j = 0; j < chunkSize; ++j)
+                {
+                    for (int i = 0; i < chunkSize;)
+                    {
+                        if (!mask[i + j * chunkSize])
+                        {
+                            ++i;
+                            continue;
+                        }
+
+                        int width = 1;
+                        while (i + width < chunkSize && mask[i + width + j * chunkSize])
+                        {
+                            ++width;
+                        }
+
+                        int height = 1;
+                        for (; j + height < chunkSize; ++height)
+                        {
+                            const bool *row = mask + i + (j + height) * chunkSize;
+                            if (!std::all_of(row, row + width, [](bool value) { return value; }))
+                            {
+                                break;
+                            }
+                        }
+
+                        for (int h = 0; h < height; ++h)
+                        {
+                            std::fill_n(mask + i + (j + h) * chunkSize, width, false);
+                        }
+                        *visibleFaces += width * height;
+
+                        glm::ivec3 base = origin;
+                        base[axis] += layer + side;
+                        base[u] += i;
+                        base[v] += j;
+                        emitQuad(vertices, axis, side != 0, base, width, height);
+                        i += width;
+                    }
+                }
+            }
+        }
+    }
+}
+
+uint8_t VoxelWorld::voxelAt(int x, int y, int z) const
+{
+    if (x < 0 || y < 0 || z < 0 || x >= chunksX * chunkSize || y >= chunksY * chunkSize || z >= chunksZ * chunkSize)
+    {
+        return 0;
+    }
+
+    int chunk = x / chunkSize + (y / chunkSize) * chunksX + (z / chunkSize) * chunksX * chunksY;
+    int local = x % chunkSize + (y % chunkSize) * chunkSize + (z % chunkSize) * chunkSize * chunkSize;
+    return chunks[chunk].voxels[local];
+}
+
+void VoxelWorld::copyPadded(int chunk, std::vector<uint8_t> *padded) const
+{
+    padded->resize(paddedSize * paddedSize * paddedSize);
+    int ox = (chunk % chunksX) * chunkSize;
+    int oy = ((chunk / chunksX) % chunksY) * chunkSize;
+    int oz = (chunk / (chunksX * chunksY)) * chunkSize;
+    const std::vector<uint8_t> &voxels = chunks[chunk].voxels;
+
+    for (int z = -1; z <= chunkSize; ++z)
+    {
+        for (int y = -1; y <= chunkSize; ++y)
+        {
+            bool interior = z >= 0 && z < chunkSize && y >= 0 && y < chunkSize;
+            uint8_t *row = padded->data() + paddedIndex(-1, y, z);
+            if (interior)
+            {
+                // 内部整行直接拷贝，只有两端需要读取相邻分块
+                row[0] = voxelAt(ox - 1, oy + y, oz + z);
+                std::memcpy(row + 1, voxels.data() + (y + z * chunkSize) * chunkSize, chunkSize);
+                row[chunkSize + 1] = voxelAt(ox + chunkSize, oy + y, oz + z);
+                continue;
+            }
+
+            for (int x = -1; x <= chunkSize; ++x)
+            {
+                row[x + 1] = voxelAt(ox + x, oy + y, oz + z);
+            }
+        }
+    }
+}
+
+void VoxelWorld::generate(uint32_t seed)
+{
+    chunks.resize(chunksX * chunksY * chunksZ);
+    for (Chunk &chunk : chunks)
+    {
+        chunk.voxels.assign(chunkSize * chunkSize * chunkSize, 0);
+        chunk.solidVoxels = 0;
+    }
+
+    // 由种子确定的几组正弦波叠加成高度场，再量化成台阶，保留大片共面区域
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> phase(0.0f, 6.2831853f);
+    float p0 = phase(rng), p1 = phase(rng), p2 = phase(rng), p3 = phase(rng);
+    int worldHeight = chunksY * chunkSize;
+
+    for (int z = 0; z < chunksZ * chunkSize; ++z)
+    {
+        for (int x = 0; x < chunksX * chunkSize; ++x)
+        {
+            float wave = 0.5f * std::sin(x * 0.07f + p0) * std::cos(z * 0.06f + p1) +
+                         0.3f * std::sin((x + z) * 0.035f + p2) + 0.2f * std::cos((x - z) * 0.11f + p3);
+            int height = static_cast<int>(worldHeight * (0.45f + 0.4f * wave));
+            height = std::clamp(height / 2 * 2, 1, worldHeight);
+
+            for (int y = 0; y < height; ++y)
+            {
+                int chunk = x / chunkSize + (y / chunkSize) * chunksX + (z / chunkSize) * chunksX * chunksY;
+                int local = x % chunkSize + (y % chunkSize) * chunkSize + (z % chunkSize) * chunkSize * chunkSize;
+                chunks[chunk].voxels[local] = 1;
+                ++chunks[chunk].solidVoxels;
+            }
+        }
+    }
+
+    for (Chunk &chunk : chunks)
+    {
+        ++chunk.version;
+    }
+    generated = true;
+}
+
+void VoxelWorld::carve()
+{
+    int sizeX = chunksX * chunkSize;
+    int sizeY = chunksY * chunkSize;
+    int sizeZ = chunksZ * chunkSize;
+    std::uniform_int_distribution<int> pickX(0, sizeX - 1);
+    std::uniform_int_distribution<int> pickZ(0, sizeZ - 1);
+    std::uniform_int_distribution<int> pickRadius(4, 10);
+
+    // 球心放在随机列的地表处
+    int cx = pickX(random);
+    int cz = pickZ(random);
+    int cy = sizeY - 1;
+    while (cy > 0 && voxelAt(cx, cy, cz) == 0)
+    {
+        --cy;
+    }
+    int radius = pickRadius(random);
+
+    glm::ivec3 minVoxel(std::max(cx - radius, 0), std::max(cy - radius, 0), std::max(cz - radius, 0));
+    glm::ivec3 maxVoxel(std::min(cx + radius, sizeX - 1), std::min(cy + radius, sizeY - 1), std::min(cz + radius, sizeZ - 1));
+    for (int z = minVoxel.z; z <= maxVoxel.z; ++z)
+    {
+        for (int y = minVoxel.y; y <= maxVoxel.y; ++y)
+        {
+            for (int x = minVoxel.x; x <= maxVoxel.x; ++x)
+            {
+                int dx = x - cx, dy = y - cy, dz = z - cz;
+                if (dx * dx + dy * dy + dz * dz > radius * radius)
+                {
+                    continue;
+                }
+
+                int chunk = x / chunkSize + (y / chunkSize) * chunksX + (z / chunkSize) * chunksX * chunksY;
+                int local = x % chunkSize + (y % chunkSize) * chunkSize + (z % chunkSize) * chunkSize * chunkSize;
+                uint8_t &voxel = chunks[chunk].voxels[local];
+                chunks[chunk].solidVoxels -= voxel != 0 ? 1 : 0;
+                voxel = 0;
+            }
+        }
+    }
+
+    markDirty(minVoxel, maxVoxel);
+}
+
+void VoxelWorld::markDirty(const glm::ivec3 &minVoxel, const glm::ivec3 &maxVoxel)
+{
+    // 边界体素变化会影响相邻分块的带边框拷贝，因此范围向外扩展一格
+    int x0 = std::max(minVoxel.x - 1, 0) / chunkSize;
+    int y0 = std::max(minVoxel.y - 1, 0) / chunkSize;
+    int z0 = std::max(minVoxel.z - 1, 0) / chunkSize;
+    int x1 = std::min((maxVoxel.x + 1) / chunkSize, chunksX - 1);
+    int y1 = std::min((maxVoxel.y + 1) / chunkSize, chunksY - 1);
+    int z1 = std::min((maxVoxel.z + 1) / chunkSize, chunksZ - 1);
+
+    for (int z = z0; z <= z1; ++z)
+    {
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                ++chunks[x + y * chunksX + z * chunksX * chunksY].version;
+            }
+        }
+    }
+}
+
+void VoxelWorld::update()
+{
+    std::vector<Edit> pending;
+    {
+        std::lock_guard<std::mutex> lock(editMutex);
+        pending.swap(edits);
+    }
+
+    // 从未启用过体素世界时不占用线程
+    if (workers.empty())
+    {
+        startWorkers();
+    }
+    if (!generated)
+    {
+        generate(1);
+    }
+    for (const Edit &edit : pending)
+    {
+        if (edit.regenerate)
+        {
+            generate(edit.seed);
+        }
+        else
+        {
+            carve();
+        }
+    }
+    if (builtMode != meshMode)
+    {
+        builtMode = meshMode;
+        for (Chunk &chunk : chunks)
+        {
+            ++chunk.version;
+        }
+    }
+
+    // 派发版本已变化且没有进行中任务的分块；进行中的任务完成后若版本已过期会再次派发
+    auto now = std::chrono::steady_clock::now();
+    int dispatched = 0;
+    for (int i = 0; i < static_cast<int>(chunks.size()); ++i)
+    {
+        Chunk &chunk = chunks[i];
+        if (chunk.queued || chunk.meshedVersion == chunk.version)
+        {
+            continue;
+        }
+
+        if (inFlight == 0 && dispatched == 0)
+        {
+            batchStart = now;
+            batchFinished = now;
+            batchChunks = 0;
+            batchMeshMs = 0.0;
+        }
+
+        Job job;
+        job.chunk = i;
+        job.version = chunk.version;
+        job.mode = builtMode;
+        copyPadded(i, &job.padded);
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobs.push_back(std::move(job));
+        }
+        chunk.queued = true;
+        ++inFlight;
+        ++batchChunks;
+        ++dispatched;
+    }
+    if (dispatched > 0)
+    {
+        jobReady.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        completedScratch.swap(results);
+    }
+    for (Result &result : completedScratch)
+    {
+        chunks[result.chunk].queued = false;
+        --inFlight;
+        batchMeshMs += result.meshMs;
+        batchFinished = std::max(batchFinished, result.finished);
+        if (result.version == chunks[result.chunk].version)
+        {
+            uploadQueue.push_back(std::move(result));
+        }
+    }
+    completedScratch.clear();
+
+    if (inFlight == 0 && batchChunks > 0)
+    {
+        double seconds = std::chrono::duration<double>(batchFinished - batchStart).count();
+        stats.chunksPerSecond = seconds > 0.0 ? batchChunks / seconds : 0.0;
+        stats.msPerChunk = batchMeshMs / batchChunks;
+        batchChunks = 0;
+    }
+
+    // 按字节预算上传，一帧至少上传一个分块；过期的结果直接丢弃
+    long long uploaded = 0;
+    int uploads = 0;
+    size_t consumed = 0;
+    for (; consumed < uploadQueue.size(); ++consumed)
+    {
+        const Result &result = uploadQueue[consumed];
+        if (result.version != chunks[result.chunk].version)
+        {
+            continue;
+        }
+        if (uploads > 0 && uploaded + static_cast<long long>(result.vertices.size() * sizeof(VoxelVertex)) > uploadBudgetBytes)
+        {
+            break;
+        }
+        uploaded += upload(result);
+        ++uploads;
+    }
+    uploadQueue.erase(uploadQueue.begin(), uploadQueue.begin() + consumed);
+    stats.uploadsLastFrame = uploads;
+    stats.uploadBytesLastFrame = uploaded;
+
+    stats.chunkCount = static_cast<int>(chunks.size());
+    stats.meshedChunks = 0;
+    stats.solidVoxels = 0;
+    stats.culledTriangles = 0;
+    stats.meshTriangles = 0;
+    stats.gpuBytes = static_cast<long long>(quadIndexCapacity) * 6 * sizeof(GLuint);
+    for (const Chunk &chunk : chunks)
+    {
+        stats.meshedChunks += chunk.meshedVersion == chunk.version ? 1 : 0;
+        stats.solidVoxels += chunk.solidVoxels;
+        stats.culledTriangles += chunk.visibleFaces * 2LL;
+        stats.meshTriangles += chunk.quadCount * 2LL;
+        stats.gpuBytes += chunk.bytes;
+    }
+    stats.naiveTriangles = stats.solidVoxels * 12;
+    stats.drawCalls = 0;
+    stats.pendingChunks = stats.chunkCount - stats.meshedChunks;
+}
+
+long long VoxelWorld::upload(const Result &result)
+{
+    Chunk &chunk = chunks[result.chunk];
+    int quadCount = static_cast<int>(result.vertices.size() / 4);
+    long long bytes = static_cast<long long>(result.vertices.size() * sizeof(VoxelVertex));
+    ensureQuadIndices(quadCount);
+
+    // 新网格不大于原区间且没有缩小一半以上时原地更新，否则在几何缓冲区中重新分配
+    GeometryArena &arena = GeometryArena::getInstance();
+    if (chunk.mesh == GeometryArena::invalidMesh)
+    {
+        chunk.mesh = arena.createMesh(VertexFormat::VoxelPositionColor, nullptr, 0, nullptr, 0);
+    }
+    arena.updateVertices(chunk.mesh, result.vertices.data(), static_cast<uint32_t>(result.vertices.size()));
+    chunk.bytes = arena.getMesh(chunk.mesh).vertexBytes;
+
+    chunk.quadCount = quadCount;
+    chunk.visibleFaces = result.visibleFaces;
+    chunk.meshedVersion = result.version;
+    return bytes;
+}
+
+void VoxelWorld::ensureQuadIndices(int quadCount)
+{
+    if (quadCount <= quadIndexCapacity)
+    {
+        return;
+    }
+
+    int capacity = std::max(quadIndexCapacity, 1024);
+    while (capacity < quadCount)
+    {
+        capacity *= 2;
+    }
+
+    std::vector<GLuint> indices(capacity * 6);
+    for (int quad = 0; quad < capacity; ++quad)
+    {
+        GLuint first = static_cast<GLuint>(quad * 4);
+        GLuint *index = indices.data() + quad * 6;
+        index[0] = first;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first + 2;
+        index[4] = first + 3;
+        index[5] = first;
+    }
+
+    // 只有索引的网格，各分块绘制时用自己的基顶点
+    GeometryArena &arena = GeometryArena::getInstance();
+    arena.destroyMesh(quadIndexMesh);
+    quadIndexMesh = arena.createMesh(VertexFormat::VoxelPositionColor, nullptr, 0, indices.data(),
+                                     static_cast<uint32_t>(indices.size()));
+    quadIndexCapacity = capacity;
+}
+
+void VoxelWorld::releaseChunk(Chunk &chunk)
+{
+    GeometryArena::getInstance().destroyMesh(chunk.mesh);
+    chunk.mesh = GeometryArena::invalidMesh;
+    chunk.bytes = 0;
+    chunk.quadCount = 0;
+}
+
+void VoxelWorld::render(const SceneView &view, const glm::mat4 &rotation, GLuint program, float time)
+{
+    glUseProgram(program);
+
+    int timeLocation = glGetUniformLocation(program, "time");
+    if (timeLocation != -1)
+    {
+        glUniform1f(timeLocation, time);
+    }
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view.view));
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(view.projection));
+
+    // 世界缩放到与立方体网格相近的范围并以中心为原点
+    glm::vec3 size(static_cast<float>(chunksX * chunkSize), static_cast<float>(chunksY * chunkSize),
+                   static_cast<float>(chunksZ * chunkSize));
+    float scale = 2.4f / std::max(size.x, std::max(size.y, size.z));
+    glm::mat4 model = glm::scale(rotation, glm::vec3(scale));
+    model = glm::translate(model, size * -0.5f);
+    glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(model));
+
+    // 所有分块共用一个VAO，每个分块只是一段基顶点不同的绘制
+    GeometryArena &arena = GeometryArena::getInstance();
+    arena.bind(VertexFormat::VoxelPositionColor);
+    const GLuint firstIndex = quadIndexMesh != GeometryArena::invalidMesh ? arena.getMesh(quadIndexMesh).firstIndex : 0;
+    for (const Chunk &chunk : chunks)
+    {
+        if (chunk.quadCount == 0)
+        {
+            continue;
+        }
+        GeometryArena::drawRange(chunk.quadCount * 6, firstIndex, arena.getMesh(chunk.mesh).baseVertex);
+        ++stats.drawCalls;
+    }
+    glBindVertexArray(0);
+}
+
+VoxelStats VoxelWorld::getStats() const
+{
+    return stats;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file voxel_world.h
+ * @brief 体素世界头文件
+ * @details 定义了按32³分块存储的体素地形、在工作线程上执行的网格生成（逐立方体、剔除隐藏面、贪心合并）
+ * 以及按预算逐帧上传的分块网格
+ */
+
+#pragma once
+#include "geometry_arena.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "scene.h"
+
+/**
+ * @enum VoxelMeshMode
+ * @brief 体素网格生成方式
+ */
+enum class VoxelMeshMode
+{
+    Naive,  // 每个实心体素输出完整立方体的6个面，与逐立方体绘制等价
+    Culled, // 只输出与空体素相邻的面
+    Greedy  // 在剔除隐藏面的基础上把共面同色的相邻面合并为矩形
+};
+
+/**
+ * @struct VoxelVertex
+ * @brief 体素网格顶点
+ * @details 位置用整数体素坐标，颜色用归一化字节，作为浮点属性送入与立方体相同的顶点着色器
+ */
+struct VoxelVertex
+{
+    int16_t x, y, z, pad; // 体素坐标
+    uint8_t r, g, b, a;   // 面颜色
+};
+
+/**
+ * @struct VoxelStats
+ * @brief 体素世界统计
+ */
+struct VoxelStats
+{
+    int chunkCount = 0;              // 分块总数
+    int meshedChunks = 0;            // 已上传网格的分块数
+    int pendingChunks = 0;           // 等待生成或上传的分块数
+    int workerCount = 0;             // 网格生成工作线程数，首次启用前为0
+    long long solidVoxels = 0;       // 实心体素数
+    long long naiveTriangles = 0;    // 逐立方体输出时的三角形数
+    long long culledTriangles = 0;   // 剔除隐藏面后的三角形数
+    long long meshTriangles = 0;     // 当前网格的三角形数
+    double chunksPerSecond = 0.0;    // 最近一批网格生成的吞吐量（所有工作线程合计）
+    double msPerChunk = 0.0;         // 最近一批中单个分块的平均生成耗时
+    int uploadsLastFrame = 0;        // 最近一帧上传的分块数
+    long long uploadBytesLastFrame = 0; // 最近一帧上传的字节数
+    long long gpuBytes = 0;          // 分块顶点区间与共享四边形索引在几何缓冲区中的字节数
+    int drawCalls = 0;               // 最近一帧的绘制调用数
+};
+
+/**
+ * @class VoxelWorld
+ * @brief 分块体素世界，使用单例模式实现
+ * @details 体素数据只在渲染侧（拥有GL上下文的线程）修改。分块数据变化时把该块及其一圈邻居体素
+ * 拷贝为34³的带边框数组交给工作线程生成网格，工作线程不访问共享数据；生成结果回到渲染侧后
+ * 按每帧字节预算上传。编辑请求可以从任意线程提交，在下一次update时应用
+ */
+class VoxelWorld
+{
+public:
+    static constexpr int chunkSize = 32; // 分块边长（体素）
+
+    /**
+     * @brief 获取VoxelWorld单例实例
+     * @return VoxelWorld& 单例实例的引用
+     */
+    static VoxelWorld &getInstance()
+    {
+        static VoxelWorld instance;
+        return instance;
+    }
+
+    /**
+     * @brief 初始化体素世界
+     * @details 工作线程和地形都在第一次启用时才创建
+     */
+    void init();
+
+    /**
+     * @brief 停止工作线程并释放所有GL资源
+     */
+    void cleanup();
+
+    /**
+     * @brief 请求以新的种子重新生成地形
+     * @param seed 地形种子
+     * @details 可在任意线程调用
+     */
+    void requestRegenerate(uint32_t seed);
+
+    /**
+     * @brief 请求在地表附近随机挖去一个球形区域
+     * @details 可在任意线程调用，只有被修改的分块及其相邻分块重新生成网格
+     */
+    void requestCarve();
+
+    /**
+     * @brief 应用编辑、派发网格生成任务并上传已完成的网格
+     * @details 在渲染侧每帧调用一次
+     */
+    void update();
+
+    /**
+     * @brief 绘制所有已上传的分块
+     * @param view 相机矩阵
+     * @param rotation 场景整体的旋转矩阵
+     * @param program 着色器程序，使用与立方体相同的uniform
+     * @param time 动画时间
+     * @details 世界缩放并居中到与立方体场景相同的范围
+     */
+    void render(const SceneView &view, const glm::mat4 &rotation, GLuint program, float time);
+
+    /**
+     * @brief 获取统计信息
+     * @return VoxelStats 统计信息
+     */
+    VoxelStats getStats() const;
+
+    /**
+     * @brief 为一个分块生成网格
+     * @param padded 带一圈邻居体素的34³数组，索引为(x+1)+(y+1)*34+(z+1)*34*34
+     * @param origin 分块原点的体素坐标
+     * @param mode 生成方式
+     * @param vertices 输出的顶点，每4个顶点组成一个四边形；工作线程传入分配自线程帧分配器的临时数组
+     * @param visibleFaces 输出的可见面数（与空体素相邻的面）
+     */
+    static void meshChunk(const uint8_t *padded, const glm::ivec3 &origin, VoxelMeshMode mode,
+                          std::pmr::vector<VoxelVertex> *vertices, int *visibleFaces);
+
+    bool enabled = false;                          // 是否用体素世界替代立方体场景
+    VoxelMeshMode meshMode = VoxelMeshMode::Greedy; // 网格生成方式，变化时重新生成所有分块
+    int chunksX = 4;                               // X方向分块数
+    int chunksY = 1;                               // Y方向分块数
+    int chunksZ = 4;                               // Z方向分块数
+    long long uploadBudgetBytes = 4LL << 20;       // 每帧最多上传的顶点字节数（至少上传一个分块）
+
+private:
+    // 私有构造函数和析构函数，确保单例模式
+    VoxelWorld() = default;
+    ~VoxelWorld() = default;
+
+    // 删除拷贝构造函数和赋值运算符
+    VoxelWorld(const VoxelWorld &) = delete;
+    VoxelWorld &operator=(const VoxelWorld &) = delete;
+
+    /**
+     * @struct Chunk
+     * @brief 分块数据与GPU网格
+     */
+    struct Chunk
+    {
+        std::vector<uint8_t> voxels;  // chunkSize³个体素，0为空
+        uint32_t version = 0;         // 数据或生成方式变化时递增
+        bool queued = false;          // 是否有进行中的生成任务
+        uint32_t mesh = GeometryArena::invalidMesh; // 共享几何缓冲区中的顶点区间
+        int quadCount = 0;            // 已上传的四边形数
+        long long bytes = 0;          // 顶点区间的字节数
+        uint32_t meshedVersion = 0;   // 已上传网格对应的版本
+        int visibleFaces = 0;         // 可见面数
+        int solidVoxels = 0;          // 实心体素数
+    };
+
+    /**
+     * @struct Job
+     * @brief 网格生成任务
+     */
+    struct Job
+    {
+        int chunk;                   // 分块索引
+        uint32_t version;            // 派发时的分块版本
+        VoxelMeshMode mode;          // 生成方式
+        std::vector<uint8_t> padded; // 带边框的体素拷贝
+    };
+
+    /**
+     * @struct Result
+     * @brief 网格生成结果
+     */
+    struct Result
+    {
+        int chunk;                                       // 分块索引
+        uint32_t version;                                // 对应的分块版本
+        std::vector<VoxelVertex> vertices;               // 顶点
+        int visibleFaces;                                // 可见面数
+        double meshMs;                                   // 生成耗时
+        std::chrono::steady_clock::time_point finished;  // 完成时间
+    };
+
+    /**
+     * @struct Edit
+     * @brief 待应用的编辑请求
+     */
+    struct Edit
+    {
+        bool regenerate; // true为重新生成地形，false为挖球
+        uint32_t seed;   // 地形种子
+    };
+
+    /**
+     * @brief 启动网格生成工作线程
+     */
+    void startWorkers();
+
+    /**
+     * @brief 工作线程主循环
+     */
+    void workerMain();
+
+    /**
+     * @brief 按种子生成高度场地形
+     */
+    void generate(uint32_t seed);
+
+    /**
+     * @brief 在地表附近挖去一个随机球形区域
+     */
+    void carve();
+
+    /**
+     * @brief 标记包含指定体素范围（含一圈邻居）的分块需要重新生成
+     */
+    void markDirty(const glm::ivec3 &minVoxel, const glm::ivec3 &maxVoxel);
+
+    /**
+     * @brief 读取世界坐标处的体素，世界之外为空
+     */
+    uint8_t voxelAt(int x, int y, int z) const;
+
+    /**
+     * @brief 把分块及其邻居体素拷贝为带边框数组
+     */
+    void copyPadded(int chunk, std::vector<uint8_t> *padded) const;
+
+    /**
+     * @brief 上传一个生成结果
+     * @return long long 上传的字节数
+     */
+    long long upload(const Result &result);
+
+    /**
+     * @brief 确保共享四边形索引缓冲区至少能容纳指定数量的四边形
+     */
+    void ensureQuadIndices(int quadCount);
+
+    /**
+     * @brief 释放分块的GL资源
+     */
+    void releaseChunk(Chunk &chunk);
+
+    std::vector<Chunk> chunks;       // 所有分块，X最快变化
+    bool generated = false;          // 是否已生成地形
+    VoxelMeshMode builtMode = VoxelMeshMode::Greedy; // 当前分块版本对应的生成方式
+    std::mt19937 random{12345u};     // 挖球位置的随机数
+
+    uint32_t quadIndexMesh = GeometryArena::invalidMesh; // 所有分块共用的四边形索引（0,1,2,2,3,0模式）
+    int quadIndexCapacity = 0;       // 四边形索引容纳的四边形数
+
+    std::vector<std::thread> workers;           // 工作线程
+    std::mutex jobMutex;                        // 保护jobs和stopping
+    std::condition_variable jobReady;           // 有新任务或停止时唤醒工作线程
+    std::deque<Job> jobs;                       // 待执行的任务
+    bool stopping = false;                      // 工作线程是否应退出
+    std::mutex resultMutex;                     // 保护results
+    std::vector<Result> results;                // 已完成但尚未上传的结果
+    std::mutex editMutex;                       // 保护edits
+    std::vector<Edit> edits;                    // 待应用的编辑请求
+    std::vector<Result> uploadQueue;            // 渲染侧等待上传的结果
+    std::vector<Result> completedScratch;       // 从results取出结果时复用的容器
+
+    int inFlight = 0;                                         // 已派发但尚未取回的任务数
+    int batchChunks = 0;                                      // 当前批次的任务数
+    double batchMeshMs = 0.0;                                 // 当前批次的生成耗时之和
+    std::chrono::steady_clock::time_point batchStart;         // 当前批次开始派发的时间
+    std::chrono::steady_clock::time_point batchFinished;      // 当前批次最后完成的时间
+
+    VoxelStats stats; // 统计信息
+};